@@ -0,0 +1,96 @@
+#include "AllocationTracker.h"
+
+#ifdef HMUI_TRACK_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+static thread_local size_t allocationCount = 0;
+static thread_local size_t allocationBytes = 0;
+
+size_t AllocationTracker::getCount() {
+    return allocationCount;
+}
+
+size_t AllocationTracker::getBytes() {
+    return allocationBytes;
+}
+
+static void* trackedAlloc(size_t size, size_t alignment) {
+    allocationCount++;
+    allocationBytes += size;
+
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = std::malloc(size);
+    } else {
+#ifdef _WIN32
+        p = _aligned_malloc(size, alignment);
+#else
+        size = (size + alignment - 1) & ~(alignment - 1);
+        p = std::aligned_alloc(alignment, size);
+#endif
+    }
+    return p;
+}
+
+static void trackedFree(void* p, size_t alignment) {
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#endif
+    (void) alignment;
+    std::free(p);
+}
+
+void* operator new(size_t size) {
+    if (void* p = trackedAlloc(size, alignof(std::max_align_t))) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = trackedAlloc(size, alignof(std::max_align_t))) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = trackedAlloc(size, (size_t) alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* p = trackedAlloc(size, (size_t) alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size, alignof(std::max_align_t));
+}
+
+void operator delete(void* p) noexcept { trackedFree(p, alignof(std::max_align_t)); }
+void operator delete[](void* p) noexcept { trackedFree(p, alignof(std::max_align_t)); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p, alignof(std::max_align_t)); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { trackedFree(p, (size_t) alignment); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { trackedFree(p, (size_t) alignment); }
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept { trackedFree(p, (size_t) alignment); }
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept { trackedFree(p, (size_t) alignment); }
+
+#else
+
+size_t AllocationTracker::getCount() {
+    return 0;
+}
+
+size_t AllocationTracker::getBytes() {
+    return 0;
+}
+
+#endif
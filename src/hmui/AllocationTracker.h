@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts heap allocations made by the calling thread, to check that steady-state frames do
+// not allocate. Only active in builds configured with HMUI_TRACK_ALLOCATIONS, which replace
+// the global operator new; otherwise every counter stays at zero.
+class AllocationTracker {
+public:
+    static constexpr bool enabled() {
+#ifdef HMUI_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Allocations and bytes requested on this thread since it started
+    static size_t getCount();
+    static size_t getBytes();
+};
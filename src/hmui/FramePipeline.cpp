@@ -0,0 +1,100 @@
+#include "FramePipeline.h"
+
+#include <stdexcept>
+#include "util/RenderThread.h"
+
+FramePipeline::FramePipeline(HMUI& hmui, std::shared_ptr<SnapshotOSContext> input)
+    : hmui(hmui), input(std::move(input)) {
+    if (!this->input) {
+        throw std::invalid_argument("FramePipeline needs the SnapshotOSContext HMUI was initialized with");
+    }
+
+    RenderThread::bind();
+    hmui.setPipelined(true);
+    thread = std::thread([this]() { run(); });
+}
+
+FramePipeline::~FramePipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    // The UI thread may be waiting on a GPU call to finish its last frame
+    RenderThread::serviceUntil([this]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !pending;
+    });
+    thread.join();
+
+    hmui.setPipelined(false);
+    RenderThread::unbind();
+}
+
+void FramePipeline::beginFrame(float frameDelta, int width, int height) {
+    // The UI thread is idle here, endFrame() waited for it
+    input->capture();
+    input->publish();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        building = 1 - building;
+        frames[building].width = width;
+        frames[building].height = height;
+        delta = frameDelta;
+        pending = true;
+    }
+    wake.notify_all();
+}
+
+void FramePipeline::submit(GfxList* out) {
+    const Frame& frame = frames[1 - building];
+    hmui.submit(out, frame.recorder.getList(), frame.width, frame.height);
+}
+
+void FramePipeline::endFrame() {
+    RenderThread::serviceUntil([this]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !pending;
+    });
+
+    // Calls the UI thread posted at the end of its frame (cursor changes, retired textures)
+    RenderThread::service();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error) {
+        std::exception_ptr rethrow = std::move(error);
+        error = nullptr;
+        std::rethrow_exception(rethrow);
+    }
+}
+
+void FramePipeline::run() {
+    while (true) {
+        Frame* frame;
+        float frameDelta;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return pending || stopping; });
+            if (!pending) return;
+
+            frame = &frames[building];
+            frameDelta = delta;
+        }
+
+        try {
+            hmui.update(frameDelta);
+            hmui.record(frame->recorder, frame->width, frame->height);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = false;
+        }
+        RenderThread::notify();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "HMUI.h"
+#include "graphics/RecordingGraphicsContext.h"
+#include "os/SnapshotOSContext.h"
+
+// Runs HMUI on two threads: a UI thread runs update(), layout and paint recording for frame
+// N+1 while the render thread (the one that created the pipeline, owner of the window)
+// submits frame N's display list. Frame time drops from update + layout + paint + submit to
+// the larger of the two halves.
+//
+// Render thread, every frame:
+//   pipeline.beginFrame(delta, width, height); // Hands this frame's input to the UI thread
+//   hmui.prepareFrame();                       // Backend housekeeping, outside any ImGui frame
+//   ... begin backend frame ...
+//   pipeline.submit(&gfx);                     // Replays the frame the UI thread finished last
+//   ... end backend frame (present, poll events) ...
+//   pipeline.endFrame();                       // Waits for the UI thread, serving its GPU calls
+//
+// Latency: input captured in beginFrame() is seen by the frame being built, which is shown
+// by the next submit(). Compared to running serially, input reaches the screen exactly one
+// frame later, never more. The very first submit() draws nothing.
+//
+// Input is double-buffered in the SnapshotOSContext that HMUI must have been initialized
+// with; display lists are double-buffered here. Texture uploads and other graphics calls made
+// from the UI thread are run on the render thread through RenderThread, while it waits in
+// endFrame(). Textures and handles the UI thread releases while the previous frame is being
+// submitted are retired there too, and freed in endFrame() after that frame was drawn.
+class FramePipeline {
+public:
+    FramePipeline(HMUI& hmui, std::shared_ptr<SnapshotOSContext> input);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    void beginFrame(float delta, int width, int height);
+    void submit(GfxList* out);
+    void endFrame();
+
+private:
+    struct Frame {
+        RecordingGraphicsContext recorder;
+        int width = 0;
+        int height = 0;
+    };
+
+    void run();
+
+    HMUI& hmui;
+    std::shared_ptr<SnapshotOSContext> input;
+    Frame frames[2];
+    int building = 0;           // Frame the UI thread writes, the other one is submitted
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    float delta = 0.0f;
+    bool pending = false;       // A frame was handed over and is not finished yet
+    bool stopping = false;
+    std::exception_ptr error;   // Thrown by the UI thread, rethrown by endFrame()
+
+    std::thread thread;
+};
@@ -1,21 +1,23 @@
 #include "HMUI.h"
 
+#include <iterator>
 #include <utility>
 #include <stdexcept>
 
+#include "AllocationTracker.h"
 #include "widgets/InternalDrawable.h"
+#include "widgets/FrameArena.h"
 #include "graphics/GraphicsContext.h"
+#include "graphics/RecordingGraphicsContext.h"
 #include "input/FocusManager.h"
+#include "layout/FlatLayout.h"
 #include "Navigator.h"
 
-HMUI* HMUI::Instance = nullptr;
-
-void HMUI::initialize(std::shared_ptr<GraphicsContext> ctx, std::shared_ptr<OSContext> osCtx) {
-    if (Instance != nullptr) {
-        throw std::runtime_error("HMUI instance already initialized");
-    }
-    Instance = this;
+void HMUI::initialize(std::shared_ptr<GraphicsContext> ctx, std::shared_ptr<OSContext> osCtx,
+                      std::shared_ptr<const FontMetrics> metrics) {
     this->context = std::move(ctx);
+    this->fontMetrics = metrics ? std::move(metrics) : this->context->defaultFontMetrics();
+    this->context->setFontMetrics(this->fontMetrics);
     this->context->init();
     this->osContext = std::move(osCtx);
     this->osContext->init();
@@ -29,6 +31,7 @@ void HMUI::setRouter(const std::shared_ptr<InternalDrawable>& _drawable) {
         throw std::invalid_argument("Router/root view cannot be null");
     }
 
+    Scope scope(this, true);
     this->drawable = _drawable;
     this->drawable->init(); // Init resources (textures, etc.)
 }
@@ -38,13 +41,45 @@ void HMUI::draw(GfxList* out, int width, int height) {
         return;
     }
 
+    Scope scope(this, true);
     this->context->build(out);
+    this->context->setViewport(Rect(0, 0, (float)width, (float)height));
+    layoutAndPaint(this->context.get(), width, height);
+}
+
+void HMUI::record(RecordingGraphicsContext& recorder, int width, int height) {
+    recorder.begin(Rect(0, 0, (float)width, (float)height), this->fontMetrics);
+    if(!this->active || (nullptr == this->drawable)) {
+        return;
+    }
+
+    Scope scope(this, true);
+    layoutAndPaint(&recorder, width, height);
+}
+
+void HMUI::submit(GfxList* out, const DisplayList& list, int width, int height) {
+    this->context->build(out);
+    this->context->setViewport(Rect(0, 0, (float)width, (float)height));
+    list.replay(this->context.get());
+}
+
+void HMUI::prepareFrame() {
+    this->context->prepareFrame();
+}
+
+void HMUI::layoutAndPaint(GraphicsContext* target, int width, int height) {
+    // Layout temporaries of this thread's previous frame are dead by now
+    FrameArena::reset();
 
     // --- 1. Layout Phase ---
     // The root of the tree gets "Tight" constraints, forcing it to fill the window.
     // This triggers the cascade of layout() calls down the widget tree.
     BoxConstraints rootConstraints = BoxConstraints::tight((float)width, (float)height);
-    this->drawable->layout(rootConstraints);
+    if (this->flatLayout) {
+        this->flatLayout->layout(this->drawable.get(), rootConstraints);
+    } else {
+        this->drawable->layout(rootConstraints);
+    }
 
     // --- 2. Positioning Phase ---
     // As the root parent, we dictate that the root widget sits at (0,0).
@@ -54,14 +89,29 @@ void HMUI::draw(GfxList* out, int width, int height) {
 
     // --- 3. Paint Phase ---
     // Render the tree at the determined position.
-    this->drawable->onDraw(context.get(), 0, 0);
+    // With ParallelPaint on, large subtrees are recorded on the pool and replayed here in order.
+    this->drawable->onDraw(target, 0, 0);
+
+    frameAllocations = AllocationTracker::getCount() - frameStartAllocations;
 }
 
 void HMUI::update(float delta) {
+    Scope scope(this, true);
+    frameStartAllocations = AllocationTracker::getCount();
+
+    // Also while hidden or without a tree, so producers never back up. Coroutines parked
+    // for this frame first, then tasks from other threads, under one budget.
+    auto deadline = std::chrono::steady_clock::now() + this->taskBudget;
+    frameTasks = resumeParked(deadline);
+    frameTasks += this->tasks->drain(deadline - std::chrono::steady_clock::now());
+
     if(!this->active || (nullptr == this->drawable)) {
         return;
     }
 
+    if (!this->pipelined) {
+        prepareFrame();
+    }
     this->drawable->onUpdate(delta);
 
     // --- Controller Input Handling ---
@@ -73,7 +123,6 @@ void HMUI::update(float delta) {
         FocusManager::get()->blur();
     }
 
-    static float inputTimer = 0.0f;
     inputTimer -= delta;
 
     if (inputTimer <= 0.0f && os->isGamepadAvailable(0)) {
@@ -125,15 +174,56 @@ void HMUI::update(float delta) {
     }
 }
 
+void HMUI::park(AsyncResume resume, std::shared_ptr<ImageProvider> image) {
+    this->parked.push_back(ParkedAsync{std::move(resume), std::move(image)});
+}
+
+size_t HMUI::resumeParked(std::chrono::steady_clock::time_point deadline) {
+    // Whatever parks while these run waits for the next frame
+    std::swap(this->parked, this->due);
+
+    size_t ran = 0;
+    size_t i = 0;
+    for (; i < this->due.size(); ++i) {
+        if (ran > 0 && std::chrono::steady_clock::now() >= deadline) break;
+
+        ParkedAsync& entry = this->due[i];
+        if (entry.image && !entry.resume.isCancelled() && !entry.image->isReady()) {
+            this->parked.push_back(std::move(entry));
+            continue;
+        }
+
+        entry.resume();
+        ran++;
+    }
+
+    // Cut off by the budget: first in line next frame
+    this->parked.insert(this->parked.begin(), std::make_move_iterator(this->due.begin() + i),
+                        std::make_move_iterator(this->due.end()));
+    this->due.clear();
+    return ran;
+}
+
+void HMUI::setFlatLayout(bool enabled) {
+    if (enabled && !this->flatLayout) {
+        this->flatLayout = std::make_unique<FlatLayout>();
+    } else if (!enabled) {
+        this->flatLayout = nullptr;
+    }
+}
+
 void HMUI::close(){
     if(this->drawable == nullptr) {
         return;
     }
 
+    Scope scope(this, true);
     this->drawable->dispose();
     this->drawable = nullptr;
 }
 
+HMUI::HMUI() : focusManager(std::make_unique<FocusManager>()) {}
+
 HMUI::~HMUI() {
     this->close();
     if(this->context) {
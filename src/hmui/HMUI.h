@@ -1,18 +1,68 @@
 #pragma once
 
+#include <chrono>
+#include <utility>
 #include <vector>
 #include <memory>
 #include "graphics/GraphicsContext.h"
+#include "graphics/text/FontMetrics.h"
 #include "os/OSContext.h"
+#include "util/Async.h"
+#include "util/TaskQueue.h"
 
 class InternalDrawable;
+class FlatLayout;
+class FocusManager;
+class D_AppContext;
+class DisplayList;
+class RecordingGraphicsContext;
 
+// Any number of instances can live in one process, each driven from one thread at a time
+// (different instances may run on different threads at once). Widgets find the instance
+// that is building, updating or drawing them through current().
 class HMUI : public std::enable_shared_from_this<HMUI> {
 public:
-    static HMUI* Instance;
+    // The instance whose tree is being worked on by this thread. Set by HMUI's entry points
+    // (setRouter, update, draw, record, close) and carried into parallel layout/paint tasks.
+    static HMUI* current() {
+        return currentInstance;
+    }
+
+    // Makes an instance current on this thread until the end of the scope. The entry points
+    // also mark the thread as driving the instance, see isDrivingThread().
+    class Scope {
+    public:
+        explicit Scope(HMUI* hmui, bool driving = false)
+            : previous(currentInstance), previousDriven(drivenInstance) {
+            currentInstance = hmui;
+            if (driving) drivenInstance = hmui;
+        }
+
+        ~Scope() {
+            currentInstance = previous;
+            drivenInstance = previousDriven;
+        }
 
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        HMUI* previous;
+        HMUI* previousDriven;
+    };
+
+    // True inside one of this instance's entry points on this thread (the UI thread), as
+    // opposed to a layout worker or a coroutine resumed in the background, which only
+    // have it current
+    bool isDrivingThread() const {
+        return drivenInstance == this;
+    }
+
+    HMUI();
     virtual ~HMUI();
-    void initialize(std::shared_ptr<GraphicsContext> ctx, std::shared_ptr<OSContext> osCtx);
+    // metrics defaults to the graphics context's own font (GraphicsContext::defaultFontMetrics)
+    void initialize(std::shared_ptr<GraphicsContext> ctx, std::shared_ptr<OSContext> osCtx,
+                    std::shared_ptr<const FontMetrics> metrics = nullptr);
     void setRouter(const std::shared_ptr<InternalDrawable>& drawable);
     void close();
 
@@ -21,9 +71,68 @@ public:
         return active;
     }
 
+    // Lays the tree out with FlatLayout instead of the recursive layout() calls
+    void setFlatLayout(bool enabled);
+    [[nodiscard]] bool isFlatLayout() const {
+        return flatLayout != nullptr;
+    }
+
     void draw(GfxList* out, int width, int height);
     void update(float delta);
 
+    // Runs task on the thread that updates this instance, at the start of a coming update()
+    // and before any widget sees that frame. This is how other threads (game systems,
+    // loaders) change widgets; touching a widget's properties from them races with layout
+    // and paint. Callable from any thread, lock-free, and closures of up to
+    // InlineTask::INLINE_SIZE bytes are queued without allocating.
+    template<typename F>
+    void post(F&& task) {
+        this->tasks->post(InlineTask(std::forward<F>(task)));
+    }
+
+    // For Async coroutines. Resumes on the UI thread: at the next update() when awaited on
+    // it, or as soon as the next update() gets to it when awaited from another thread.
+    AsyncNextFrame nextFrame() {
+        return AsyncNextFrame{*this};
+    }
+
+    // Resumes on Async::backgroundPool(); nothing there may touch widgets
+    AsyncBackground backgroundThread() {
+        return AsyncBackground{};
+    }
+
+    // Decodes in the background (ImageProvider::prefetch) and resumes on the UI thread once
+    // load() will not block, with its result
+    AsyncImage loadImage(std::shared_ptr<ImageProvider> provider) {
+        return AsyncImage{*this, std::move(provider)};
+    }
+
+    // Time update() may spend running posted tasks and resuming coroutines, the rest wait
+    // for the next frame so a burst cannot stall one. At least one runs per frame.
+    // Defaults to 2 ms.
+    void setTaskBudget(float seconds) {
+        this->taskBudget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float>(seconds));
+    }
+
+    // Posted tasks and coroutine resumptions run by the last update()
+    [[nodiscard]] size_t getFrameTasks() const {
+        return frameTasks;
+    }
+
+    // Pipelined frames (FramePipeline): update() and record() run on a UI thread while the
+    // render thread calls prepareFrame() and submit(). update() then leaves the backend alone.
+    void setPipelined(bool enabled) {
+        pipelined = enabled;
+    }
+
+    // Lays out and paints into a recorder instead of the backend; the UI side of draw()
+    void record(RecordingGraphicsContext& recorder, int width, int height);
+    // Replays a recorded frame into the backend; the render side of draw()
+    void submit(GfxList* out, const DisplayList& list, int width, int height);
+    // Lets the backend rebuild resources between frames, done by update() unless pipelined
+    void prepareFrame();
+
     std::shared_ptr<GraphicsContext> getGraphicsContext() {
         return this->context;
     }
@@ -31,12 +140,70 @@ public:
     std::shared_ptr<OSContext> getOSContext() {
         return this->osContext;
     }
+
+    // Heap allocations made by the last update() + draw(), see AllocationTracker
+    [[nodiscard]] size_t getFrameAllocations() const {
+        return frameAllocations;
+    }
+
+    // Immutable and thread-safe, layout may measure text from any thread
+    const std::shared_ptr<const FontMetrics>& getFontMetrics() const {
+        return this->fontMetrics;
+    }
+
+    // Focus and the app context belong to one instance; widgets reach them through
+    // FocusManager::get() and D_AppContext::get()
+    FocusManager* getFocusManager() const {
+        return this->focusManager.get();
+    }
+
+    std::shared_ptr<D_AppContext> getAppContext() const {
+        return this->appContext.lock();
+    }
+
+    void setAppContext(const std::shared_ptr<D_AppContext>& context) {
+        this->appContext = context;
+    }
 private:
+    friend struct Async::promise_type;
+    friend struct AsyncNextFrame;
+    friend struct AsyncImage;
+
+    // A coroutine waiting for a frame, or for an image to be decoded
+    struct ParkedAsync {
+        AsyncResume resume;
+        std::shared_ptr<ImageProvider> image;
+    };
+
+    // UI thread only
+    void park(AsyncResume resume, std::shared_ptr<ImageProvider> image);
+    size_t resumeParked(std::chrono::steady_clock::time_point deadline);
+
+    static inline thread_local HMUI* currentInstance = nullptr;
+    static inline thread_local HMUI* drivenInstance = nullptr;
+
     std::shared_ptr<InternalDrawable> drawable;
     std::shared_ptr<GraphicsContext> context;
     std::shared_ptr<OSContext> osContext;
+    std::shared_ptr<const FontMetrics> fontMetrics;
     bool active;
+    bool pipelined = false;
+    std::unique_ptr<FlatLayout> flatLayout;
+    std::unique_ptr<FocusManager> focusManager;
+    std::weak_ptr<D_AppContext> appContext;
+    float inputTimer = 0.0f;
+
+    std::shared_ptr<TaskQueue> tasks = std::make_shared<TaskQueue>(); // Coroutines hold it weakly
+    std::vector<ParkedAsync> parked;
+    std::vector<ParkedAsync> due;
+    std::chrono::steady_clock::duration taskBudget = std::chrono::milliseconds(2);
+    size_t frameTasks = 0;
+
+    size_t frameStartAllocations = 0;
+    size_t frameAllocations = 0;
 
     // Implement this later to avoid hitting multiple widgets when using GestureDetector
     std::vector<std::shared_ptr<InternalDrawable>> searchTree;
+
+    void layoutAndPaint(GraphicsContext* target, int width, int height);
 };
@@ -7,13 +7,11 @@ void Navigator::pushReplacement(const std::string& route) {
         throw std::runtime_error("AppContext missing, did you forget to wrap your app with AppContext?");
     }
 
-    auto routeBuilderOpt = appContext->getRouteBuilder(route);
-    if (!routeBuilderOpt.has_value()) {
+    if (!appContext->isParked(route) && !appContext->getRouteBuilder(route).has_value()) {
         throw std::runtime_error("Route not found: " + route);
     }
 
-    auto view = routeBuilderOpt.value()();
-    appContext->replace(view);
+    appContext->replaceNamed(route);
 }
 
 void Navigator::pushReplacement(const std::shared_ptr<InternalDrawable>& view) {
@@ -31,13 +29,12 @@ void Navigator::push(const std::string& route) {
         throw std::runtime_error("AppContext missing, did you forget to wrap your app with AppContext?");
     }
 
-    auto routeBuilderOpt = appContext->getRouteBuilder(route);
-    if (!routeBuilderOpt.has_value()) {
+    if (!appContext->isParked(route) && !appContext->getRouteBuilder(route).has_value()) {
         throw std::runtime_error("Route not found: " + route);
     }
 
-    auto view = routeBuilderOpt.value()();
-    appContext->push(view);
+    // Goes through the route name so keep-alive routes can be restored
+    appContext->pushNamed(route);
 }
 
 void Navigator::push(const std::shared_ptr<InternalDrawable>& view) {
@@ -56,4 +53,17 @@ void Navigator::pop() {
     }
 
     appContext->pop();
-}
\ No newline at end of file
+}
+
+void Navigator::prewarm(const std::string& route) {
+    auto appContext = D_AppContext::get();
+    if (!appContext) {
+        throw std::runtime_error("AppContext missing, did you forget to wrap your app with AppContext?");
+    }
+
+    if (!appContext->getRouteBuilder(route).has_value()) {
+        throw std::runtime_error("Route not found: " + route);
+    }
+
+    appContext->prewarm(route);
+}
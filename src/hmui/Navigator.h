@@ -13,4 +13,7 @@ public:
     static void push(const std::string& route);
     static void push(const std::shared_ptr<InternalDrawable>& view);
     static void pop();
+
+    // Prepares a route so that a later push of it only swaps the tree in
+    static void prewarm(const std::string& route);
 };
\ No newline at end of file
@@ -31,7 +31,7 @@ std::shared_ptr<D_Container> nestedTest(std::vector<Color2D> entries, size_t ind
             },
             .onHover = [](std::shared_ptr<InternalDrawable> child, float x, float y) {
                  std::shared_ptr<D_Container> c = std::dynamic_pointer_cast<D_Container>(child);
-                 if(c) c->properties.color = Color2D(1, 0, 1, 1); 
+                 if(c) c->setColor(Color2D(1, 0, 1, 1));
             },
             .child = nestedTest(entries, index + 1)
         )
@@ -182,10 +182,11 @@ public:
     std::shared_ptr<InternalDrawable> build() override {
         return AppContext(
             .routes = {
-                { "/", []() { return std::make_shared<TestView>(); }},
-                { "/alternate", []() { return std::make_shared<AlternateTestView>(); }}
+                { "/", []() { return WidgetArena::make<TestView>(); }},
+                { "/alternate", []() { return WidgetArena::make<AlternateTestView>(); }}
             },
-            .initialRoute = "/"
+            .initialRoute = "/",
+            .keepAlive = { "/alternate" }
         );
     }
 
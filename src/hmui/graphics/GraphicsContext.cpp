@@ -0,0 +1,13 @@
+#include "GraphicsContext.h"
+#include "text/FontMetrics.h"
+
+std::shared_ptr<const FontMetrics> GraphicsContext::defaultFontMetrics() {
+    return FontMetrics::defaultFont();
+}
+
+Rect GraphicsContext::calculateTextBounds(std::string_view text) {
+    if (!fontMetrics) return Rect{0, 0, 0, 0};
+
+    Rect size = fontMetrics->measure(text);
+    return Rect{size.width, size.height, size.width, size.height};
+}
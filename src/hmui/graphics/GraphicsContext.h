@@ -1,7 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #ifdef HMUI_N64
 #include <Fast3D/lus_gbi.h>
@@ -16,6 +21,22 @@ struct ImageHandle {
     int width;
     int height;
     void* handle;
+    bool premultiplied = false; // Color already multiplied by alpha (prebaked pack textures)
+};
+
+// What an image header says, available without decoding any pixels.
+struct ImageInfo {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+// How an image will be displayed, so a provider can shrink it at load time instead of
+// keeping full resolution around and letting the GPU minify it every frame.
+struct ImageLoadHints {
+    int maxWidth = 0;       // The image is never drawn larger than this (0 = unknown)
+    int maxHeight = 0;
+    bool mipmaps = false;   // Build a mip chain for images drawn at several sizes
 };
 
 struct Color2D {
@@ -41,29 +62,141 @@ struct Rect {
     bool contains(float px, float py) const {
         return (px >= x && px <= x + width && py >= y && py <= y + height);
     }
+
+    bool intersects(const Rect& other) const {
+        return x < other.x + other.width && other.x < x + width &&
+               y < other.y + other.height && other.y < y + height;
+    }
+
+    Rect intersect(const Rect& other) const {
+        float left = std::max(x, other.x);
+        float top = std::max(y, other.y);
+        float right = std::min(x + width, other.x + other.width);
+        float bottom = std::min(y + height, other.y + other.height);
+        return Rect(left, top, std::max(0.0f, right - left), std::max(0.0f, bottom - top));
+    }
 };
 
 class ImageProvider {
 public:
+    virtual ~ImageProvider() = default;
     virtual ImageHandle* load() = 0;
     virtual void dispose() = 0;
+
+    // Reads dimensions from the image header only, so layout can size the widget before
+    // the pixels are decoded. Returns false if the format or source is not probeable.
+    virtual bool probe(ImageInfo& out) { return false; }
+
+    // Applies to the next load(); a texture that is already resident keeps its size.
+    virtual void setLoadHints(const ImageLoadHints& hints) {}
+
+    // Starts decoding in the background so a later load() only has to upload.
+    virtual void prefetch() {}
+
+    // True when load() will not block on decoding (always, for providers without prefetch).
+    virtual bool isReady() { return true; }
+};
+
+// An image a prewarm decodes ahead of time. Once it is uploaded, adopt() hands the texture to
+// the widget, which then owns that reference and releases it like one it loaded itself.
+struct PrefetchedImage {
+    std::shared_ptr<ImageProvider> provider;
+    std::function<void(ImageHandle*)> adopt;
 };
 
+// While one is alive on a thread, images initialized on that thread hand their provider to
+// it and start decoding right away. Used to prewarm routes before they are pushed.
+class ImagePrefetchScope {
+public:
+    ImagePrefetchScope() : previous(current) { current = this; }
+    ~ImagePrefetchScope() { current = previous; }
+
+    ImagePrefetchScope(const ImagePrefetchScope&) = delete;
+    ImagePrefetchScope& operator=(const ImagePrefetchScope&) = delete;
+
+    static ImagePrefetchScope* get() { return current; }
+
+    void add(std::shared_ptr<ImageProvider> provider, std::function<void(ImageHandle*)> adopt) {
+        provider->prefetch();
+        images.push_back({std::move(provider), std::move(adopt)});
+    }
+
+    std::vector<PrefetchedImage> images;
+
+private:
+    ImagePrefetchScope* previous;
+    static inline thread_local ImagePrefetchScope* current = nullptr;
+};
+
+class FontMetrics;
+
 class GraphicsContext {
 public:
+    virtual ~GraphicsContext() = default;
+
     virtual void init() = 0;
     virtual void dispose() = 0;
+
+    // Called between frames, before any drawing. Backends can rebuild resources here
+    // that must not change while a frame is being recorded.
+    virtual void prepareFrame() {}
+
     virtual void drawLine(float x1, float y1, float x2, float y2, const Color2D& color) = 0;
     virtual void drawRect(const Rect& rect, const Color2D& color, float thickness = 1.0f) = 0;
     virtual void fillRect(const Rect& rect, const Color2D& color) = 0;
     virtual void drawText(float x, float y, const char* text, float scale, const Color2D& color) = 0;
     virtual void drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale = 1.0f) = 0;
+    // srcRect is in texture pixels
     virtual void drawImageEx(const Rect& rect, const Rect& srcRect, ImageHandle* texture, const Color2D& color) = 0;
     virtual void setScissor(const Rect& rect) = 0;
     virtual void clearScissor() = 0;
 
     virtual void build(GfxList* out) = 0;
 
+    // Text metrics are shared with layout (and every other backend) through HMUI
+    void setFontMetrics(std::shared_ptr<const FontMetrics> metrics) {
+        fontMetrics = std::move(metrics);
+    }
+
+    const std::shared_ptr<const FontMetrics>& getFontMetrics() const {
+        return fontMetrics;
+    }
+
+    // Metrics of the font this backend draws when none is configured, used by HMUI in that
+    // case so text is measured with the glyphs that end up on screen
+    virtual std::shared_ptr<const FontMetrics> defaultFontMetrics();
+
     // Util
-    virtual Rect calculateTextBounds(std::string text) = 0;
+    virtual Rect calculateTextBounds(std::string_view text);
+
+    // The window area being painted, set by HMUI before every frame
+    void setViewport(const Rect& rect) {
+        viewport = rect;
+        clipStack.clear();
+    }
+
+    // Visible area in absolute coordinates: the viewport intersected with every active scissor.
+    // Widgets use it to skip painting what cannot be seen.
+    Rect getClipRect() const {
+        return clipStack.empty() ? viewport : clipStack.back();
+    }
+
+protected:
+    // Backends call these from setScissor()/clearScissor() so nested scissors intersect
+    Rect pushClip(const Rect& rect) {
+        clipStack.push_back(getClipRect().intersect(rect));
+        return clipStack.back();
+    }
+
+    void popClip() {
+        if (!clipStack.empty()) clipStack.pop_back();
+    }
+
+    bool hasClip() const {
+        return !clipStack.empty();
+    }
+
+    std::shared_ptr<const FontMetrics> fontMetrics;
+    Rect viewport;
+    std::vector<Rect> clipStack;
 };
\ No newline at end of file
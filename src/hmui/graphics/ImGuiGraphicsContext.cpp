@@ -1,5 +1,7 @@
 #include "ImGuiGraphicsContext.h"
+#include "text/FontMetrics.h"
 #include <algorithm> // For std::max
+#include <cmath>
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include <imgui.h>
@@ -7,7 +9,57 @@
 static ImDrawList* draw_list = nullptr;
 
 void ImGuiGraphicsContext::init() {}
-void ImGuiGraphicsContext::dispose() {}
+
+void ImGuiGraphicsContext::dispose() {
+    // The fonts belong to the ImGui atlas, which outlives us
+    fonts.clear();
+    pendingSizes.clear();
+}
+
+void ImGuiGraphicsContext::prepareFrame() {
+    // The atlas is locked between NewFrame() and EndFrame(), sizes are baked in between frames
+    if (pendingSizes.empty() || !fontMetrics || ImGui::GetCurrentContext() == nullptr) return;
+
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    if (atlas->Locked) return;
+
+    const std::string& path = fontMetrics->getSourcePath();
+    for (int size : pendingSizes) {
+        ImFontConfig config;
+        config.SizePixels = (float) size;
+
+        ImFont* font = path.empty()
+            ? atlas->AddFontDefault(&config)
+            : atlas->AddFontFromFileTTF(path.c_str(), (float) size, &config);
+        if (font) fonts[size] = font;
+    }
+    pendingSizes.clear();
+
+    atlas->Build();
+    if (reloadFontTexture) reloadFontTexture();
+}
+
+ImFont* ImGuiGraphicsContext::findFont(int pixelSize) {
+    // ImGui's own default font is already baked at its native size
+    if (fonts.empty() && fontMetrics->getSourcePath().empty()) {
+        ImFont* builtin = ImGui::GetFont();
+        fonts[std::max(1, (int) std::lround(builtin->FontSize))] = builtin;
+    }
+
+    auto exact = fonts.find(pixelSize);
+    if (exact != fonts.end()) return exact->second;
+
+    // Bake it before the next frame, meanwhile scale the closest size we already have
+    pendingSizes.insert(pixelSize);
+    if (fonts.empty()) return ImGui::GetFont();
+
+    auto above = fonts.lower_bound(pixelSize);
+    if (above == fonts.end()) return std::prev(above)->second;
+    if (above == fonts.begin()) return above->second;
+
+    auto below = std::prev(above);
+    return (pixelSize - below->first <= above->first - pixelSize) ? below->second : above->second;
+}
 
 ImVec2 normalize(const Rect& in) {
     ImVec2 pos = ImGui::GetCursorScreenPos();
@@ -39,31 +91,60 @@ void ImGuiGraphicsContext::fillRect(const Rect& rect, const Color2D& color) {
 
 void ImGuiGraphicsContext::drawText(float x, float y, const char* text, float scale, const Color2D& color) {
     ImVec2 pos = normalize(x, y);
-    ImGui::SetWindowFontScale(scale);
-    draw_list->AddText(pos, ImColor((int)(color.r * 255), (int)(color.g * 255), (int)(color.b * 255), (int)(color.a * 255)), text);
-    ImGui::SetWindowFontScale(1.0f);
+    if (!fontMetrics) return;
+
+    float pixelHeight = fontMetrics->getPixelHeight() * scale;
+    ImFont* font = findFont(std::max(1, (int) std::lround(pixelHeight)));
+
+    // Passing font + size directly avoids touching window font state per string
+    draw_list->AddText(font, pixelHeight, pos,
+        ImColor((int)(color.r * 255), (int)(color.g * 255), (int)(color.b * 255), (int)(color.a * 255)), text);
+}
+
+void ImGuiGraphicsContext::addImage(ImageHandle* texture, const Rect& dest, float u0, float v0, float u1, float v1,
+                                    const Color2D& color) {
+    ImVec2 pos = normalize(dest);
+
+    // Premultiplied textures need the matching blend mode and a premultiplied tint. The mode
+    // is switched around just this image while the draw list is rendered.
+    bool premultiplied = texture->premultiplied && setPremultipliedBlend;
+    float m = premultiplied ? color.a : 1.0f;
+
+    if (premultiplied) {
+        draw_list->AddCallback([](const ImDrawList*, const ImDrawCmd* cmd) {
+            static_cast<ImGuiGraphicsContext*>(cmd->UserCallbackData)->setPremultipliedBlend(true);
+        }, this);
+    }
+
+    draw_list->AddImage(texture->handle, pos, ImVec2{pos.x + dest.width, pos.y + dest.height},
+        ImVec2{u0, v0}, ImVec2{u1, v1},
+        ImColor((int)(color.r * m * 255), (int)(color.g * m * 255), (int)(color.b * m * 255), (int)(color.a * 255)));
+
+    if (premultiplied) {
+        draw_list->AddCallback([](const ImDrawList*, const ImDrawCmd* cmd) {
+            static_cast<ImGuiGraphicsContext*>(cmd->UserCallbackData)->setPremultipliedBlend(false);
+        }, this);
+    }
 }
 
 void ImGuiGraphicsContext::drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale) {
     if (!texture) return;
-    ImVec2 pos = normalize(rect);
-    ImVec2 size = ImVec2{ rect.width * scale, rect.height * scale };
-
-    draw_list->AddImage(texture->handle, pos, ImVec2{pos.x + size.x, pos.y + size.y}, 
-        ImVec2{0, 0}, ImVec2{1, 1}, 
-        ImColor((int)(color.r * 255), (int)(color.g * 255), (int)(color.b * 255), (int)(color.a * 255)));
+    addImage(texture, Rect(rect.x, rect.y, rect.width * scale, rect.height * scale), 0, 0, 1, 1, color);
 }
 
 void ImGuiGraphicsContext::drawImageEx(const Rect& rect, const Rect& srcRect, ImageHandle* texture, const Color2D& color) {
-    if (!texture) return;
-    ImVec2 pos = normalize(rect);
+    if (!texture || texture->width <= 0 || texture->height <= 0) return;
 
-    draw_list->AddImage(texture->handle, pos, ImVec2{pos.x + rect.width, pos.y + rect.height}, 
-        ImVec2{srcRect.x, srcRect.y}, ImVec2{srcRect.x + srcRect.width, srcRect.y + srcRect.height}, 
-        ImColor((int)(color.r * 255), (int)(color.g * 255), (int)(color.b * 255), (int)(color.a * 255)));
+    // ImGui wants UVs
+    float u = 1.0f / (float) texture->width;
+    float v = 1.0f / (float) texture->height;
+
+    addImage(texture, rect, srcRect.x * u, srcRect.y * v,
+             (srcRect.x + srcRect.width) * u, (srcRect.y + srcRect.height) * v, color);
 }
 
 void ImGuiGraphicsContext::setScissor(const Rect& rect) {
+    pushClip(rect);
     ImVec2 pos = normalize(rect);
 
     float w = std::max(0.0f, rect.width);
@@ -75,14 +156,10 @@ void ImGuiGraphicsContext::setScissor(const Rect& rect) {
 }
 
 void ImGuiGraphicsContext::clearScissor() {
+    popClip();
     draw_list->PopClipRect();
 }
 
-Rect ImGuiGraphicsContext::calculateTextBounds(std::string text) {
-    ImVec2 size = ImGui::CalcTextSize(text.c_str());
-    return Rect{size.x, size.y, size.x, size.y};
-}
-
 void ImGuiGraphicsContext::build(GfxList* gen) {
     draw_list = (ImDrawList*) gen->head;
 }
\ No newline at end of file
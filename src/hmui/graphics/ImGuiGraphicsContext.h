@@ -1,11 +1,27 @@
 #pragma once
 
 #include "GraphicsContext.h"
+#include <functional>
+#include <map>
+#include <set>
+
+struct ImFont;
 
 class ImGuiGraphicsContext : public GraphicsContext {
 public:
+    // reloadFontTexture re-uploads the ImGui font atlas after new sizes were baked
+    // (rlImGuiReloadFonts for rlImGui). Without it only the CPU atlas is rebuilt.
+    // setPremultipliedBlend switches the renderer's blend mode for premultiplied textures
+    // (prebaked packs), called from ImDrawList callbacks while ImGui renders. Without it those
+    // are drawn with straight alpha, which darkens their edges.
+    explicit ImGuiGraphicsContext(std::function<void()> reloadFontTexture = nullptr,
+                                  std::function<void(bool premultiplied)> setPremultipliedBlend = nullptr)
+        : reloadFontTexture(std::move(reloadFontTexture)),
+          setPremultipliedBlend(std::move(setPremultipliedBlend)) {}
+
     void init() override;
     void dispose() override;
+    void prepareFrame() override;
     void drawLine(float x1, float y1, float x2, float y2, const Color2D& color) override;
     void drawRect(const Rect& rect, const Color2D& color, float thickness) override;
     void fillRect(const Rect& rect, const Color2D& color) override;
@@ -15,8 +31,16 @@ public:
     void setScissor(const Rect& rect) override;
     void clearScissor() override;
 
-    Rect calculateTextBounds(std::string text) override;
-
     void build(GfxList* out) override;
     ~ImGuiGraphicsContext() = default;
-};
\ No newline at end of file
+
+private:
+    ImFont* findFont(int pixelSize);
+    void addImage(ImageHandle* texture, const Rect& dest, float u0, float v0, float u1, float v1,
+                  const Color2D& color);
+
+    std::function<void()> reloadFontTexture;
+    std::function<void(bool)> setPremultipliedBlend;
+    std::map<int, ImFont*> fonts;   // Baked pixel size -> font
+    std::set<int> pendingSizes;     // Sizes seen by drawText that are not baked yet
+};
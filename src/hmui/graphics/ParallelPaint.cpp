@@ -0,0 +1,37 @@
+#include "ParallelPaint.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+    std::atomic<bool> enabled{false};
+
+    std::mutex recorderMutex;
+    std::vector<std::unique_ptr<RecordingGraphicsContext>> freeRecorders;
+}
+
+void ParallelPaint::setEnabled(bool state) {
+    enabled.store(state, std::memory_order_relaxed);
+}
+
+bool ParallelPaint::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::unique_ptr<RecordingGraphicsContext> ParallelPaint::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(recorderMutex);
+        if (!freeRecorders.empty()) {
+            std::unique_ptr<RecordingGraphicsContext> recorder = std::move(freeRecorders.back());
+            freeRecorders.pop_back();
+            return recorder;
+        }
+    }
+    return std::make_unique<RecordingGraphicsContext>();
+}
+
+void ParallelPaint::release(std::unique_ptr<RecordingGraphicsContext> recorder) {
+    std::lock_guard<std::mutex> lock(recorderMutex);
+    freeRecorders.push_back(std::move(recorder));
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/layout/ParallelLayout.h"
+#include "hmui/widgets/FrameArena.h"
+
+// Parallel painting of disjoint subtrees, on the ParallelLayout pool (enable that first).
+// Stack and Wrap record every child whose subtree has at least ParallelLayout::getThreshold()
+// nodes into a pooled RecordingGraphicsContext concurrently, then paint the small children
+// directly and replay the recordings in child order on the calling thread. The target context
+// receives exactly the calls a serial paint would make, and backends are only ever called
+// from the render thread.
+class ParallelPaint {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Calls paintChild(i, context) for each i in [0, count), in order as far as ctx can tell.
+    // weightOf(i) is the subtree size of child i.
+    template<typename Weight, typename Fn>
+    static void forEach(GraphicsContext* ctx, size_t count, Weight&& weightOf, Fn&& paintChild) {
+        ThreadPool* pool = isEnabled() ? ParallelLayout::getPool() : nullptr;
+        size_t threshold = ParallelLayout::getThreshold();
+
+        size_t large = 0;
+        if (pool) {
+            for (size_t i = 0; i < count; ++i) {
+                if (weightOf(i) >= threshold) large++;
+            }
+        }
+
+        // A single recording would only add a replay to the serial cost
+        if (large < 2) {
+            for (size_t i = 0; i < count; ++i) paintChild(i, ctx);
+            return;
+        }
+
+        HMUI* owner = HMUI::current();
+        ScratchVector<std::unique_ptr<RecordingGraphicsContext>> recordings(count, FrameArena::get());
+        auto record = [ctx, owner, &recordings, &paintChild](size_t i) {
+            ParallelLayout::TaskScope scope(owner);
+            std::unique_ptr<RecordingGraphicsContext> recorder = acquire();
+            recorder->begin(*ctx);
+            paintChild(i, static_cast<GraphicsContext*>(recorder.get()));
+            recordings[i] = std::move(recorder);
+        };
+
+        {
+            ThreadPool::TaskGroup group(*pool);
+            for (size_t i = 0; i < count; ++i) {
+                if (weightOf(i) < threshold) continue;
+                auto* function = &record;
+                group.run([function, i]() { (*function)(i); });
+            }
+            group.wait();
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (recordings[i]) {
+                recordings[i]->getList().replay(ctx);
+                release(std::move(recordings[i]));
+            } else {
+                paintChild(i, ctx);
+            }
+        }
+    }
+
+private:
+    // Recorders are shared by all threads and HMUI instances and keep their capacity, so
+    // steady-state frames do not allocate
+    static std::unique_ptr<RecordingGraphicsContext> acquire();
+    static void release(std::unique_ptr<RecordingGraphicsContext> recorder);
+};
@@ -1,14 +1,127 @@
 #include "RayGraphicsContext.h"
 #include <unordered_map>
 #include <string>
+#include <cmath>
+#include <algorithm>
 #include "raylib.h"
+#include "text/FontMetrics.h"
+
+namespace {
+
+// Rasterizes glyphs from the metrics' font file through raylib's stb_truetype path, or
+// upscales raylib's built-in 10px bitmap font when the metrics are built-in.
+class RayGlyphRasterizer : public GlyphRasterizer {
+public:
+    explicit RayGlyphRasterizer(const std::string& path) {
+        if (!path.empty() && FileExists(path.c_str())) {
+            fontData = LoadFileData(path.c_str(), &fontDataSize);
+        }
+    }
+
+    ~RayGlyphRasterizer() override {
+        if (fontData) UnloadFileData(fontData);
+    }
+
+    bool rasterize(uint32_t codepoint, int pixelSize, GlyphBitmap& out) override {
+        if (fontData) {
+            return rasterizeTrueType(codepoint, pixelSize, out);
+        }
+        return rasterizeDefault(codepoint, pixelSize, out);
+    }
+
+private:
+    bool rasterizeTrueType(uint32_t codepoint, int pixelSize, GlyphBitmap& out) {
+        int cp = (int) codepoint;
+        GlyphInfo* info = LoadFontData(fontData, fontDataSize, pixelSize, &cp, 1, FONT_DEFAULT);
+        if (!info) return false;
+
+        out.offsetX = (float) info->offsetX;
+        out.offsetY = (float) info->offsetY;
+        copyAlpha(info->image, 1, out);
+
+        UnloadFontData(info, 1);
+        return true;
+    }
+
+    bool rasterizeDefault(uint32_t codepoint, int pixelSize, GlyphBitmap& out) {
+        Font font = GetFontDefault();
+
+        int index = -1;
+        for (int i = 0; i < font.glyphCount; ++i) {
+            if (font.glyphs[i].value == (int) codepoint) {
+                index = i;
+                break;
+            }
+        }
+        if (index < 0) return false;
+
+        // The built-in font is pixel art, scale it by whole pixels only
+        int factor = std::max(1, (int) std::lround((float) pixelSize / (float) font.baseSize));
+        const GlyphInfo& glyph = font.glyphs[index];
+
+        out.offsetX = (float) (glyph.offsetX * factor);
+        out.offsetY = (float) (glyph.offsetY * factor);
+        copyAlpha(glyph.image, factor, out);
+        return true;
+    }
+
+    static void copyAlpha(const Image& source, int factor, GlyphBitmap& out) {
+        if (source.data == nullptr || source.width <= 0 || source.height <= 0) return;
+
+        Image gray = ImageCopy(source);
+        ImageFormat(&gray, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+        const auto* pixels = (const uint8_t*) gray.data;
+
+        out.width = gray.width * factor;
+        out.height = gray.height * factor;
+        out.alpha.resize((size_t) out.width * out.height);
+
+        for (int y = 0; y < out.height; ++y) {
+            for (int x = 0; x < out.width; ++x) {
+                out.alpha[y * out.width + x] = pixels[(y / factor) * gray.width + (x / factor)];
+            }
+        }
+
+        UnloadImage(gray);
+    }
+
+    unsigned char* fontData = nullptr;
+    int fontDataSize = 0;
+};
+
+}
 
 void RayGraphicsContext::init() {
+    std::string fontPath = fontMetrics ? fontMetrics->getSourcePath() : "";
+    atlas = std::make_unique<GlyphAtlas>(std::make_unique<RayGlyphRasterizer>(fontPath));
+}
+
+std::shared_ptr<const FontMetrics> RayGraphicsContext::defaultFontMetrics() {
+    Font font = GetFontDefault();
+    if (font.glyphCount <= 0 || font.baseSize <= 0) return GraphicsContext::defaultFontMetrics();
+
+    // Same advance as DrawText at the base size: the glyph's own (or its width) plus a pixel of
+    // spacing. The pixel height is the base size so glyphs are rasterized 1:1 at scale 1.
+    const float spacing = 1.0f;
+    std::vector<std::pair<uint32_t, float>> advances;
+    advances.reserve(font.glyphCount);
+    for (int i = 0; i < font.glyphCount; ++i) {
+        const GlyphInfo& glyph = font.glyphs[i];
+        float advance = glyph.advanceX > 0 ? (float) glyph.advanceX : font.recs[i].width;
+        advances.emplace_back((uint32_t) glyph.value, advance + spacing);
+    }
 
+    // Codepoints the font lacks are skipped when drawing, leave a gap the width of a narrow glyph
+    float size = (float) font.baseSize;
+    return FontMetrics::fromAdvances(advances, size / 2.0f + spacing, size, size, size);
 }
 
 void RayGraphicsContext::dispose() {
-
+    for (auto& page : glyphPages) {
+        UnloadTexture(page);
+    }
+    glyphPages.clear();
+    atlas = nullptr;
 }
 
 void RayGraphicsContext::drawLine(float x1, float y1, float x2, float y2, const Color2D& color) {
@@ -38,44 +151,96 @@ void RayGraphicsContext::fillRect(const Rect& rect, const Color2D& color) {
     });
 }
 
-void RayGraphicsContext::drawText(float x, float y, const char* text, float scale, const Color2D& color) {
-    // TODO: Implement text system later
+void RayGraphicsContext::uploadGlyphPages() {
+    atlas->flush([this](int index, const GlyphAtlas::Page& page) {
+        // Atlas pages are coverage only, expand to white + alpha so tinting works
+        uploadBuffer.resize(page.alpha.size() * 2);
+        for (size_t i = 0; i < page.alpha.size(); ++i) {
+            uploadBuffer[i * 2] = 255;
+            uploadBuffer[i * 2 + 1] = page.alpha[i];
+        }
+
+        if (index >= (int) glyphPages.size()) {
+            Image image = {
+                uploadBuffer.data(),
+                GlyphAtlas::PAGE_SIZE,
+                GlyphAtlas::PAGE_SIZE,
+                1,
+                PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA
+            };
+            glyphPages.push_back(LoadTextureFromImage(image));
+        } else {
+            UpdateTexture(glyphPages[index], uploadBuffer.data());
+        }
+    });
 }
 
-void RayGraphicsContext::drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale) {
-    Texture2D tex = *((Texture2D*) texture->handle);
-    Rectangle destRect = { rect.x, rect.y, rect.width * scale, rect.height * scale };
-    DrawTexturePro(tex, Rectangle{0, 0, (float)tex.width, (float)tex.height}, destRect, Vector2{0, 0}, 0.0f, Color {
+void RayGraphicsContext::drawText(float x, float y, const char* text, float scale, const Color2D& color) {
+    if (!atlas || !fontMetrics || text == nullptr) return;
+
+    glyphQuads.clear();
+    atlas->layout(text, x, y, *fontMetrics, scale, glyphQuads);
+    uploadGlyphPages();
+
+    Color tint = {
         (uint8_t)(color.r * 255),
         (uint8_t)(color.g * 255),
         (uint8_t)(color.b * 255),
         (uint8_t)(color.a * 255)
-    });
+    };
+
+    // Consecutive quads share a page texture, so raylib's batcher merges them into one draw call
+    for (const auto& quad : glyphQuads) {
+        DrawTexturePro(glyphPages[quad.page],
+            Rectangle{quad.src.x, quad.src.y, quad.src.width, quad.src.height},
+            Rectangle{quad.dst.x, quad.dst.y, quad.dst.width, quad.dst.height},
+            Vector2{0, 0}, 0.0f, tint);
+    }
+}
+
+// Premultiplied textures need the matching blend mode and a premultiplied tint
+static Color imageTint(const ImageHandle* texture, const Color2D& color) {
+    float m = texture->premultiplied ? color.a : 1.0f;
+    return Color {
+        (uint8_t)(color.r * m * 255),
+        (uint8_t)(color.g * m * 255),
+        (uint8_t)(color.b * m * 255),
+        (uint8_t)(color.a * 255)
+    };
+}
+
+void RayGraphicsContext::drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale) {
+    Texture2D tex = *((Texture2D*) texture->handle);
+    Rectangle destRect = { rect.x, rect.y, rect.width * scale, rect.height * scale };
+    if (texture->premultiplied) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTexturePro(tex, Rectangle{0, 0, (float)tex.width, (float)tex.height}, destRect, Vector2{0, 0}, 0.0f,
+                   imageTint(texture, color));
+    if (texture->premultiplied) EndBlendMode();
 }
 
 void RayGraphicsContext::drawImageEx(const Rect& rect, const Rect& srcRect, ImageHandle* texture, const Color2D& color) {
     Texture2D tex = *((Texture2D*) texture->handle);
     Rectangle destRect = { rect.x, rect.y, rect.width, rect.height };
     Rectangle sourceRect = { srcRect.x, srcRect.y, srcRect.width, srcRect.height };
-    DrawTexturePro(tex, sourceRect, destRect, Vector2{0, 0}, 0.0f, Color {
-        (uint8_t)(color.r * 255),
-        (uint8_t)(color.g * 255),
-        (uint8_t)(color.b * 255),
-        (uint8_t)(color.a * 255)
-    });
+    if (texture->premultiplied) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTexturePro(tex, sourceRect, destRect, Vector2{0, 0}, 0.0f, imageTint(texture, color));
+    if (texture->premultiplied) EndBlendMode();
 }
 
 void RayGraphicsContext::setScissor(const Rect& rect) {
-    BeginScissorMode((int) rect.x, (int) rect.y, (int) rect.width, (int) rect.height);
+    // raylib has a single scissor, nest by intersecting with the enclosing one
+    Rect clip = pushClip(rect);
+    BeginScissorMode((int) clip.x, (int) clip.y, (int) clip.width, (int) clip.height);
 }
 
 void RayGraphicsContext::clearScissor() {
-    EndScissorMode();
-}
-
-Rect RayGraphicsContext::calculateTextBounds(std::string text) {
-    // TODO: Implement text bounds calculation using Raylib's text measurement functions
-    return Rect{0, 0, 0, 0};
+    popClip();
+    if (hasClip()) {
+        Rect clip = getClipRect();
+        BeginScissorMode((int) clip.x, (int) clip.y, (int) clip.width, (int) clip.height);
+    } else {
+        EndScissorMode();
+    }
 }
 
 void RayGraphicsContext::build(GfxList* gen) {
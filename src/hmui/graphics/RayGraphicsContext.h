@@ -2,7 +2,10 @@
 #define RAYLIB_IMPLEMENTATION
 
 #include "GraphicsContext.h"
+#include "text/GlyphAtlas.h"
 #include <raylib.h>
+#include <memory>
+#include <vector>
 
 namespace RGGuiGC {
 Texture2D loadTexture(const char* texturePath);
@@ -12,6 +15,9 @@ class RayGraphicsContext : public GraphicsContext {
 public:
     void init() override;
     void dispose() override;
+    // raylib's built-in bitmap font, which init() rasterizes when the metrics have no font file.
+    // Needs the window, and with it the font, to exist already.
+    std::shared_ptr<const FontMetrics> defaultFontMetrics() override;
     void drawLine(float x1, float y1, float x2, float y2, const Color2D& color) override;
     void drawRect(const Rect& rect, const Color2D& color, float thickness) override;
     void fillRect(const Rect& rect, const Color2D& color) override;
@@ -21,8 +27,14 @@ public:
     void setScissor(const Rect& rect) override;
     void clearScissor() override;
 
-    Rect calculateTextBounds(std::string text) override;
-
     void build(GfxList* out) override;
     ~RayGraphicsContext() = default;
-};
\ No newline at end of file
+
+private:
+    void uploadGlyphPages();
+
+    std::unique_ptr<GlyphAtlas> atlas;
+    std::vector<Texture2D> glyphPages;
+    std::vector<GlyphQuad> glyphQuads;     // Reused between drawText calls
+    std::vector<uint8_t> uploadBuffer;     // Gray+alpha staging for page uploads
+};
@@ -0,0 +1,105 @@
+#include "RecordingGraphicsContext.h"
+
+#include <cstring>
+
+static bool sameRect(const Rect& a, const Rect& b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static bool sameColor(const Color2D& a, const Color2D& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+bool DisplayList::Command::operator==(const Command& other) const {
+    return op == other.op && sameRect(rect, other.rect) && sameRect(src, other.src) &&
+           sameColor(color, other.color) && value == other.value && image == other.image &&
+           text == other.text;
+}
+
+bool DisplayList::operator==(const DisplayList& other) const {
+    return commands == other.commands && text == other.text;
+}
+
+uint32_t DisplayList::addText(const char* string) {
+    auto offset = static_cast<uint32_t>(text.size());
+    text.insert(text.end(), string, string + std::strlen(string) + 1);
+    return offset;
+}
+
+void DisplayList::replay(GraphicsContext* target) const {
+    for (const Command& command : commands) {
+        const Rect& r = command.rect;
+
+        switch (command.op) {
+            case Op::Line:
+                target->drawLine(r.x, r.y, r.width, r.height, command.color);
+                break;
+            case Op::DrawRect:
+                target->drawRect(r, command.color, command.value);
+                break;
+            case Op::FillRect:
+                target->fillRect(r, command.color);
+                break;
+            case Op::Text:
+                target->drawText(r.x, r.y, text.data() + command.text, command.value, command.color);
+                break;
+            case Op::Image:
+                target->drawImage(r, command.image, command.color, command.value);
+                break;
+            case Op::ImageEx:
+                target->drawImageEx(r, command.src, command.image, command.color);
+                break;
+            case Op::Scissor:
+                target->setScissor(r);
+                break;
+            case Op::ClearScissor:
+                target->clearScissor();
+                break;
+        }
+    }
+}
+
+void RecordingGraphicsContext::begin(const GraphicsContext& target) {
+    begin(target.getClipRect(), target.getFontMetrics());
+}
+
+void RecordingGraphicsContext::begin(const Rect& viewport, std::shared_ptr<const FontMetrics> metrics) {
+    list.clear();
+    setFontMetrics(std::move(metrics));
+    setViewport(viewport);
+}
+
+void RecordingGraphicsContext::drawLine(float x1, float y1, float x2, float y2, const Color2D& color) {
+    list.add({DisplayList::Op::Line, Rect(x1, y1, x2, y2), Rect(), color});
+}
+
+void RecordingGraphicsContext::drawRect(const Rect& rect, const Color2D& color, float thickness) {
+    list.add({DisplayList::Op::DrawRect, rect, Rect(), color, thickness});
+}
+
+void RecordingGraphicsContext::fillRect(const Rect& rect, const Color2D& color) {
+    list.add({DisplayList::Op::FillRect, rect, Rect(), color});
+}
+
+void RecordingGraphicsContext::drawText(float x, float y, const char* text, float scale, const Color2D& color) {
+    list.add({DisplayList::Op::Text, Rect(x, y, 0, 0), Rect(), color, scale, nullptr, list.addText(text)});
+}
+
+void RecordingGraphicsContext::drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale) {
+    list.add({DisplayList::Op::Image, rect, Rect(), color, scale, texture});
+}
+
+void RecordingGraphicsContext::drawImageEx(const Rect& rect, const Rect& srcRect, ImageHandle* texture,
+                                           const Color2D& color) {
+    list.add({DisplayList::Op::ImageEx, rect, srcRect, color, 0.0f, texture});
+}
+
+void RecordingGraphicsContext::setScissor(const Rect& rect) {
+    pushClip(rect);
+    list.add({DisplayList::Op::Scissor, rect, Rect(), Color2D()});
+}
+
+void RecordingGraphicsContext::clearScissor() {
+    popClip();
+    list.add({DisplayList::Op::ClearScissor, Rect(), Rect(), Color2D()});
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "GraphicsContext.h"
+
+// Draw calls captured in order, to be issued later on another GraphicsContext.
+// Clearing keeps the capacity, so a list reused every frame stops allocating.
+class DisplayList {
+public:
+    enum class Op : uint8_t {
+        Line,
+        DrawRect,
+        FillRect,
+        Text,
+        Image,
+        ImageEx,
+        Scissor,
+        ClearScissor
+    };
+
+    struct Command {
+        Op op;
+        Rect rect;               // Line: (x1, y1, x2, y2), Text: (x, y, 0, 0)
+        Rect src;                // ImageEx source rect
+        Color2D color;
+        float value = 0.0f;      // Thickness or scale
+        ImageHandle* image = nullptr;
+        uint32_t text = 0;       // Offset of a null-terminated string in the text buffer
+
+        bool operator==(const Command& other) const;
+    };
+
+    void clear() {
+        commands.clear();
+        text.clear();
+    }
+
+    bool empty() const { return commands.empty(); }
+    size_t size() const { return commands.size(); }
+
+    void add(const Command& command) { commands.push_back(command); }
+    uint32_t addText(const char* string);
+
+    // Must run on the thread that owns target (the render thread for backends)
+    void replay(GraphicsContext* target) const;
+
+    bool operator==(const DisplayList& other) const;
+    bool operator!=(const DisplayList& other) const { return !(*this == other); }
+
+private:
+    std::vector<Command> commands;
+    std::vector<char> text;
+};
+
+// A GraphicsContext that records into a DisplayList instead of drawing, so a subtree can be
+// painted on any thread. Clipping behaves as it would on the target: begin() takes over the
+// target's current clip rect and font metrics, scissors recorded here intersect with it.
+class RecordingGraphicsContext : public GraphicsContext {
+public:
+    void begin(const GraphicsContext& target);
+    // For a whole frame: nothing to inherit from, starts at the viewport
+    void begin(const Rect& viewport, std::shared_ptr<const FontMetrics> metrics);
+
+    const DisplayList& getList() const { return list; }
+
+    void init() override {}
+    void dispose() override {}
+
+    void drawLine(float x1, float y1, float x2, float y2, const Color2D& color) override;
+    void drawRect(const Rect& rect, const Color2D& color, float thickness = 1.0f) override;
+    void fillRect(const Rect& rect, const Color2D& color) override;
+    void drawText(float x, float y, const char* text, float scale, const Color2D& color) override;
+    void drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale = 1.0f) override;
+    void drawImageEx(const Rect& rect, const Rect& srcRect, ImageHandle* texture, const Color2D& color) override;
+    void setScissor(const Rect& rect) override;
+    void clearScissor() override;
+
+    // Nothing to submit, the list is replayed by whoever asked for the recording
+    void build(GfxList* out) override {}
+
+private:
+    DisplayList list;
+};
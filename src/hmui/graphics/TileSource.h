@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+
+#include "GraphicsContext.h"
+
+// An image split into fixed-size tiles over a pyramid of zoom levels, for images too
+// large to be a single texture. Level 0 is full resolution, every next level halves it.
+// Tiles are square (tileSize) except along the right and bottom edges.
+class TileSource {
+public:
+    virtual ~TileSource() = default;
+
+    // Full-resolution size in pixels
+    virtual int getWidth() = 0;
+    virtual int getHeight() = 0;
+
+    virtual int getTileSize() = 0;
+    virtual int getLevelCount() = 0;
+
+    // A provider for one tile; the caller loads and disposes it. nullptr if it does not exist.
+    virtual std::shared_ptr<ImageProvider> getTile(int level, int column, int row) = 0;
+
+    int getColumns(int level) {
+        int span = getTileSize() << level;
+        return (getWidth() + span - 1) / span;
+    }
+
+    int getRows(int level) {
+        int span = getTileSize() << level;
+        return (getHeight() + span - 1) / span;
+    }
+};
@@ -0,0 +1,200 @@
+#include "AssetPack.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+std::shared_ptr<AssetPack> AssetPack::open(const std::string& path) {
+    auto pack = std::shared_ptr<AssetPack>(new AssetPack());
+    pack->path = path;
+    pack->file = MappedFile::open(path);
+    if (!pack->file) return nullptr;
+
+    pack->bytes = pack->file->data();
+    pack->byteCount = pack->file->size();
+    return pack->validate() ? pack : nullptr;
+}
+
+std::shared_ptr<AssetPack> AssetPack::fromMemory(const uint8_t* data, size_t size) {
+    auto pack = std::shared_ptr<AssetPack>(new AssetPack());
+    pack->bytes = data;
+    pack->byteCount = size;
+    return pack->validate() ? pack : nullptr;
+}
+
+AssetPack::~AssetPack() = default;
+
+// Bytes an entry's mip chain takes in its format, false for formats this version does not
+// know or sizes no GPU takes. Compressed formats store whole 4x4 blocks of 16 bytes, so a
+// level smaller than a block still takes one.
+static bool payloadSize(const AssetPackEntry& e, uint64_t& out) {
+    static constexpr uint32_t MAX_DIMENSION = 1 << 16;
+    if (e.width == 0 || e.height == 0 || e.width > MAX_DIMENSION || e.height > MAX_DIMENSION) return false;
+
+    uint32_t levels = std::max<uint32_t>(1, e.mipmaps);
+    if (levels > 32 || (std::max(e.width, e.height) >> (levels - 1)) == 0) return false;
+
+    out = 0;
+    for (uint32_t level = 0; level < levels; ++level) {
+        uint64_t w = std::max<uint32_t>(1, e.width >> level);
+        uint64_t h = std::max<uint32_t>(1, e.height >> level);
+
+        switch ((AssetPackFormat) e.format) {
+            case AssetPackFormat::RGBA8:
+                out += w * h * 4;
+                break;
+            case AssetPackFormat::ETC2_RGBA:
+            case AssetPackFormat::ASTC_4x4_RGBA:
+            case AssetPackFormat::DXT5_RGBA:
+                out += ((w + 3) / 4) * ((h + 3) / 4) * 16;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// Everything is bounds-checked once here, lookups can then trust the index, and the
+// uploader can trust that every mip level is there to read
+bool AssetPack::validate() {
+    if (byteCount < sizeof(AssetPackHeader)) return false;
+
+    AssetPackHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, 4) != 0 || header.version != VERSION) return false;
+
+    size_t tableEnd = sizeof(AssetPackHeader) + (size_t) header.entryCount * sizeof(AssetPackEntry);
+    if (tableEnd > byteCount) return false;
+
+    entries = reinterpret_cast<const AssetPackEntry*>(bytes + sizeof(AssetPackHeader));
+    entryCount = header.entryCount;
+
+    for (size_t i = 0; i < entryCount; ++i) {
+        const AssetPackEntry& e = entries[i];
+        if ((uint64_t) e.nameOffset + e.nameLength > byteCount) return false;
+        if (e.dataOffset > byteCount || e.dataSize > byteCount - e.dataOffset) return false;
+
+        uint64_t expected = 0;
+        if (!payloadSize(e, expected) || e.dataSize < expected) return false;
+        if (i > 0 && entries[i - 1].nameHash > e.nameHash) return false;
+    }
+
+    return true;
+}
+
+uint64_t AssetPack::hashName(std::string_view name) {
+    // FNV-1a, stable across platforms and builds since it is stored in the file
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= (uint8_t) c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetPackTexture AssetPack::at(size_t index) const {
+    const AssetPackEntry& e = entries[index];
+
+    AssetPackTexture out;
+    out.name = std::string_view((const char*) bytes + e.nameOffset, e.nameLength);
+    out.width = (int) e.width;
+    out.height = (int) e.height;
+    out.mipmaps = std::max(1, (int) e.mipmaps);
+    out.format = (AssetPackFormat) e.format;
+    out.premultiplied = (e.flags & ASSET_PACK_PREMULTIPLIED) != 0;
+    out.data = bytes + e.dataOffset;
+    out.size = (size_t) e.dataSize;
+    return out;
+}
+
+bool AssetPack::find(std::string_view name, AssetPackTexture& out) const {
+    uint64_t hash = hashName(name);
+
+    const AssetPackEntry* end = entries + entryCount;
+    const AssetPackEntry* it = std::lower_bound(entries, end, hash, [](const AssetPackEntry& e, uint64_t h) {
+        return e.nameHash < h;
+    });
+
+    // Walk hash collisions, the name decides
+    for (; it != end && it->nameHash == hash; ++it) {
+        if (std::string_view((const char*) bytes + it->nameOffset, it->nameLength) == name) {
+            out = at((size_t) (it - entries));
+            return true;
+        }
+    }
+    return false;
+}
+
+void AssetPackWriter::add(std::string name, int width, int height, AssetPackFormat format, int mipmaps,
+                          uint32_t flags, std::vector<uint8_t> data) {
+    Pending item;
+    item.entry = AssetPackEntry{};
+    item.entry.nameHash = AssetPack::hashName(name);
+    item.entry.width = (uint32_t) width;
+    item.entry.height = (uint32_t) height;
+    item.entry.format = (uint32_t) format;
+    item.entry.mipmaps = (uint32_t) std::max(1, mipmaps);
+    item.entry.flags = flags;
+    item.name = std::move(name);
+    item.data = std::move(data);
+    pending.push_back(std::move(item));
+}
+
+std::vector<uint8_t> AssetPackWriter::build() const {
+    std::vector<const Pending*> sorted;
+    for (const auto& item : pending) sorted.push_back(&item);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Pending* a, const Pending* b) {
+        return a->entry.nameHash < b->entry.nameHash;
+    });
+
+    size_t namesStart = sizeof(AssetPackHeader) + sorted.size() * sizeof(AssetPackEntry);
+    size_t offset = namesStart;
+    for (const Pending* item : sorted) offset += item->name.size();
+
+    std::vector<AssetPackEntry> table;
+    size_t nameOffset = namesStart;
+    for (const Pending* item : sorted) {
+        AssetPackEntry entry = item->entry;
+        entry.nameOffset = (uint32_t) nameOffset;
+        entry.nameLength = (uint32_t) item->name.size();
+        nameOffset += item->name.size();
+
+        offset = (offset + AssetPack::PAYLOAD_ALIGNMENT - 1) & ~(AssetPack::PAYLOAD_ALIGNMENT - 1);
+        entry.dataOffset = offset;
+        entry.dataSize = item->data.size();
+        offset += item->data.size();
+        table.push_back(entry);
+    }
+
+    std::vector<uint8_t> out(offset, 0);
+
+    AssetPackHeader header{};
+    std::memcpy(header.magic, AssetPack::MAGIC, 4);
+    header.version = AssetPack::VERSION;
+    header.entryCount = (uint32_t) table.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!table.empty()) {
+        std::memcpy(out.data() + sizeof(header), table.data(), table.size() * sizeof(AssetPackEntry));
+    }
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const Pending& item = *sorted[i];
+        std::memcpy(out.data() + table[i].nameOffset, item.name.data(), item.name.size());
+        if (!item.data.empty()) {
+            std::memcpy(out.data() + table[i].dataOffset, item.data.data(), item.data.size());
+        }
+    }
+
+    return out;
+}
+
+bool AssetPackWriter::write(const std::string& path) const {
+    std::vector<uint8_t> bytes = build();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write((const char*) bytes.data(), (std::streamsize) bytes.size());
+    return (bool) file;
+}
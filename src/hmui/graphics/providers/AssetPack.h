@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A single file holding pre-decoded textures, built offline by tools/hmpack.
+//
+// Layout (little endian):
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   sorted by nameHash, binary searched at runtime
+//   name bytes                   not terminated, entries point into them
+//   payloads                     each aligned to PAYLOAD_ALIGNMENT
+//
+// Payloads are ready to upload: no decode, no format conversion, no premultiply pass.
+
+enum class AssetPackFormat : uint32_t {
+    RGBA8 = 1,
+    // GPU-compressed payloads, uploaded as-is by backends that support them
+    ETC2_RGBA = 2,
+    ASTC_4x4_RGBA = 3,
+    DXT5_RGBA = 4,
+};
+
+enum AssetPackFlags : uint32_t {
+    ASSET_PACK_PREMULTIPLIED = 1 << 0,
+};
+
+struct AssetPackHeader {
+    char magic[4];          // "HMPK"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct AssetPackEntry {
+    uint64_t nameHash;
+    uint64_t dataOffset;    // From the start of the file
+    uint64_t dataSize;      // All mip levels, stored back to back
+    uint32_t nameOffset;    // From the start of the file
+    uint32_t nameLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // AssetPackFormat
+    uint32_t mipmaps;
+    uint32_t flags;         // AssetPackFlags
+    uint32_t reserved;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader is part of the file format");
+static_assert(sizeof(AssetPackEntry) == 56, "AssetPackEntry is part of the file format");
+
+class MappedFile;
+
+// A texture inside a mapped pack. Pointers stay valid as long as the pack is alive.
+struct AssetPackTexture {
+    std::string_view name;
+    int width = 0;
+    int height = 0;
+    int mipmaps = 1;
+    AssetPackFormat format = AssetPackFormat::RGBA8;
+    bool premultiplied = false;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Read side. The file is memory-mapped where the platform allows it (read into memory
+// once otherwise, e.g. from romfs), and lookups return views into it without copying.
+class AssetPack {
+public:
+    static constexpr char MAGIC[4] = {'H', 'M', 'P', 'K'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t PAYLOAD_ALIGNMENT = 16;
+
+    // Returns nullptr if the file is missing or not a valid pack.
+    static std::shared_ptr<AssetPack> open(const std::string& path);
+
+    // Same, over bytes the caller keeps alive for the pack's lifetime.
+    static std::shared_ptr<AssetPack> fromMemory(const uint8_t* data, size_t size);
+
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool find(std::string_view name, AssetPackTexture& out) const;
+
+    size_t size() const { return entryCount; }
+    AssetPackTexture at(size_t index) const;
+
+    const std::string& getPath() const { return path; }
+
+    static uint64_t hashName(std::string_view name);
+
+private:
+    AssetPack() = default;
+    bool validate();
+
+    std::string path;
+    const uint8_t* bytes = nullptr;
+    size_t byteCount = 0;
+    const AssetPackEntry* entries = nullptr;
+    size_t entryCount = 0;
+
+    std::unique_ptr<MappedFile> file; // Owns the bytes, null for fromMemory
+};
+
+// Write side, used by the packer tool.
+class AssetPackWriter {
+public:
+    void add(std::string name, int width, int height, AssetPackFormat format, int mipmaps, uint32_t flags,
+             std::vector<uint8_t> data);
+
+    std::vector<uint8_t> build() const;
+    bool write(const std::string& path) const;
+
+private:
+    struct Pending {
+        std::string name;
+        AssetPackEntry entry;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Pending> pending;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// XXH64 (xxHash, 64-bit). Fast enough to hash image blobs on every provider creation and
+// stable across platforms, so it can also be persisted.
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
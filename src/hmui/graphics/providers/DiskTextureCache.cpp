@@ -0,0 +1,273 @@
+#include "DiskTextureCache.h"
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#elif !defined(__SWITCH__)
+#include <fcntl.h>
+#include <unistd.h>
+#define HMUI_DISK_CACHE_FSYNC 1
+#endif
+
+namespace fs = std::filesystem;
+
+// A temp file untouched for this long belongs to a writer that died; younger ones may still
+// be written by another process sharing the directory
+static constexpr auto STALE_TEMP_AGE = std::chrono::hours(1);
+
+static std::unique_ptr<DiskTextureCache> instance;
+
+uint64_t DiskTextureKey::fileKey() const {
+    uint64_t fields[5] = {
+        sourceHash,
+        (uint64_t) width,
+        (uint64_t) height,
+        (uint64_t) mipmaps,
+        (uint64_t) DiskTextureCache::VERSION
+    };
+    return xxh64(fields, sizeof(fields));
+}
+
+void DiskTextureCache::enable(const std::string& directory, size_t maxBytes) {
+    instance.reset(new DiskTextureCache(directory, maxBytes));
+}
+
+void DiskTextureCache::disable() {
+    instance.reset();
+}
+
+DiskTextureCache* DiskTextureCache::get() {
+    return instance.get();
+}
+
+DiskTextureCache::DiskTextureCache(std::string directory, size_t maxBytes)
+    : directory(std::move(directory)), maxBytes(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(this->directory, ec);
+    scan();
+}
+
+std::string DiskTextureCache::pathFor(uint64_t fileKey) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 ".hmtc", fileKey);
+    return (fs::path(directory) / name).string();
+}
+
+// A temp name no other writer uses, in this process or in another one sharing the directory:
+// two providers storing the same entry must not write into the same file
+static std::string tempPathFor(const std::string& path) {
+    static const uint64_t process = ((uint64_t) std::random_device{}() << 32)
+                                  ^ (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+    static std::atomic<uint64_t> next{0};
+
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%016" PRIx64 ".%" PRIu64 ".tmp", process, next++);
+    return path + suffix;
+}
+
+// Writes the entry and flushes it to the disk, not just to the OS, before it gets renamed
+static bool writeDurably(const std::string& path, const DiskTextureHeader& header, const uint8_t* data, size_t size) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (size == 0 || std::fwrite(data, size, 1, file) == 1) &&
+              std::fflush(file) == 0;
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(file)) == 0;
+#elif defined(HMUI_DISK_CACHE_FSYNC)
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    return std::fclose(file) == 0 && ok;
+}
+
+// Makes the directory's entries (a new file, a rename) survive a crash. Windows cannot open a
+// directory for this and its renames are journaled; the Switch has no fsync.
+static void syncDirectory(const std::string& directory) {
+#if defined(HMUI_DISK_CACHE_FSYNC)
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return;
+    fsync(fd);
+    ::close(fd);
+#else
+    (void) directory;
+#endif
+}
+
+// Rebuilds the LRU from the directory, oldest modification time last
+void DiskTextureCache::scan() {
+    struct Found {
+        uint64_t fileKey;
+        size_t size;
+        fs::file_time_type time;
+    };
+    std::vector<Found> found;
+
+    std::error_code ec;
+    auto now = fs::file_time_type::clock::now();
+    for (const auto& file : fs::directory_iterator(directory, ec)) {
+        const fs::path& path = file.path();
+
+        // Leftovers of a write that never got renamed, unless it may still be going on
+        if (path.extension() == ".tmp") {
+            std::error_code timeError;
+            fs::file_time_type time = file.last_write_time(timeError);
+            if (!timeError && now - time > STALE_TEMP_AGE) {
+                fs::remove(path, ec);
+            }
+            continue;
+        }
+        if (path.extension() != ".hmtc") continue;
+
+        uint64_t fileKey = 0;
+        if (std::sscanf(path.stem().string().c_str(), "%" SCNx64, &fileKey) != 1) continue;
+
+        std::error_code sizeError, timeError;
+        size_t size = (size_t) file.file_size(sizeError);
+        fs::file_time_type time = file.last_write_time(timeError);
+        if (sizeError || timeError) continue;
+
+        found.push_back({fileKey, size, time});
+    }
+
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+        return a.time > b.time;
+    });
+
+    for (const auto& f : found) {
+        lru.push_back({f.fileKey, f.size});
+        entries[f.fileKey] = std::prev(lru.end());
+        totalBytes += f.size;
+    }
+
+    evict();
+}
+
+bool DiskTextureCache::load(const DiskTextureKey& key, DiskTexture& out) {
+    uint64_t fileKey = key.fileKey();
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(fileKey);
+        if (it == entries.end()) return false;
+
+        lru.splice(lru.begin(), lru, it->second);
+        path = pathFor(fileKey);
+    }
+
+    auto file = MappedFile::open(path);
+
+    DiskTextureHeader header;
+    bool valid = file && file->size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, file->data(), sizeof(header));
+        valid = std::memcmp(header.magic, MAGIC, 4) == 0 &&
+                header.version == VERSION &&
+                header.fileKey == fileKey &&
+                header.dataSize == file->size() - sizeof(header) &&
+                header.width > 0 && header.height > 0;
+    }
+
+    if (!valid) {
+        // Corrupt or deleted behind our back: drop it, the caller decodes and stores again
+        std::lock_guard<std::mutex> lock(mutex);
+        remove(fileKey);
+
+        std::error_code ec;
+        fs::remove(path, ec);
+        return false;
+    }
+
+    // Persist recency for the next launch's scan()
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    out.width = (int) header.width;
+    out.height = (int) header.height;
+    out.mipmaps = std::max(1, (int) header.mipmaps);
+    out.sourceBytes = (size_t) header.sourceBytes;
+    out.data = file->data() + sizeof(header);
+    out.size = (size_t) header.dataSize;
+    out.file = std::move(file);
+    return true;
+}
+
+void DiskTextureCache::store(const DiskTextureKey& key, int width, int height, int mipmaps, size_t sourceBytes,
+                             const uint8_t* data, size_t size) {
+    uint64_t fileKey = key.fileKey();
+    if (sizeof(DiskTextureHeader) + size > maxBytes) return;
+
+    DiskTextureHeader header{};
+    std::memcpy(header.magic, MAGIC, 4);
+    header.version = VERSION;
+    header.fileKey = fileKey;
+    header.width = (uint32_t) width;
+    header.height = (uint32_t) height;
+    header.mipmaps = (uint32_t) mipmaps;
+    header.dataSize = size;
+    header.sourceBytes = sourceBytes;
+
+    std::string path = pathFor(fileKey);
+    std::string temp = tempPathFor(path);
+    std::error_code ec;
+    if (!writeDurably(temp, header, data, size)) {
+        fs::remove(temp, ec);
+        return;
+    }
+    syncDirectory(directory);
+
+    // The entry only becomes visible under its real name once it is complete and on disk, so
+    // a crash leaves either the old state or the whole entry
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return;
+    }
+    syncDirectory(directory);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    remove(fileKey);
+    insert(fileKey, sizeof(header) + size);
+    evict();
+}
+
+size_t DiskTextureCache::getTotalBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalBytes;
+}
+
+void DiskTextureCache::insert(uint64_t fileKey, size_t size) {
+    lru.push_front({fileKey, size});
+    entries[fileKey] = lru.begin();
+    totalBytes += size;
+}
+
+// Forgets an entry (the file itself is left to the caller)
+void DiskTextureCache::remove(uint64_t fileKey) {
+    auto it = entries.find(fileKey);
+    if (it == entries.end()) return;
+
+    totalBytes -= it->second->size;
+    lru.erase(it->second);
+    entries.erase(it);
+}
+
+void DiskTextureCache::evict() {
+    while (totalBytes > maxBytes && !lru.empty()) {
+        uint64_t fileKey = lru.back().fileKey;
+        remove(fileKey);
+
+        std::error_code ec;
+        fs::remove(pathFor(fileKey), ec);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "MappedFile.h"
+
+// What a cached texture was made from and what processing made of it: the size it came out
+// at, not the hints that asked for it, so hints that give the same texture share an entry.
+// Any change to the source bytes gives a different key, so entries never need invalidation.
+struct DiskTextureKey {
+    uint64_t sourceHash = 0;
+    int width = 0;
+    int height = 0;
+    bool mipmaps = false;
+
+    uint64_t fileKey() const;
+};
+
+// On-disk layout of one entry: this header, then RGBA8 pixels (all mip levels) at offset 64.
+struct DiskTextureHeader {
+    char magic[4];          // "HMTC"
+    uint32_t version;
+    uint64_t fileKey;       // Guards against a file renamed into the wrong slot
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipmaps;
+    uint32_t reserved;
+    uint64_t dataSize;
+    uint64_t sourceBytes;   // Decoded size before processing, for the cache stats
+    uint8_t padding[16];
+};
+
+static_assert(sizeof(DiskTextureHeader) == 64, "DiskTextureHeader is part of the file format");
+
+// A cache hit. The pixels point into the mapped file and stay valid while this lives.
+struct DiskTexture {
+    int width = 0;
+    int height = 0;
+    int mipmaps = 1;
+    size_t sourceBytes = 0;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::unique_ptr<MappedFile> file;
+};
+
+// Persistent cache of decoded and resized textures, checked by the image providers before
+// decoding. Entries are written to a temp file of their own, synced to disk and renamed into
+// place, so a crash or a concurrent writer never leaves a torn entry behind; temp files are
+// only cleaned up once they are old enough that no live writer can own them. The directory
+// is capped at maxBytes with LRU eviction, where recency survives restarts through the files'
+// modification time.
+class DiskTextureCache {
+public:
+    static constexpr char MAGIC[4] = {'H', 'M', 'T', 'C'};
+    static constexpr uint32_t VERSION = 2;
+
+    // Disabled until enabled; the directory is created if needed.
+    static void enable(const std::string& directory, size_t maxBytes);
+    static void disable();
+    static DiskTextureCache* get();
+
+    bool load(const DiskTextureKey& key, DiskTexture& out);
+    void store(const DiskTextureKey& key, int width, int height, int mipmaps, size_t sourceBytes,
+               const uint8_t* data, size_t size);
+
+    size_t getTotalBytes();
+    size_t getMaxBytes() const { return maxBytes; }
+
+private:
+    struct Entry {
+        uint64_t fileKey;
+        size_t size;
+    };
+
+    DiskTextureCache(std::string directory, size_t maxBytes);
+
+    void scan();
+    void insert(uint64_t fileKey, size_t size);
+    void remove(uint64_t fileKey);
+    void evict();
+    std::string pathFor(uint64_t fileKey) const;
+
+    std::string directory;
+    size_t maxBytes;
+    size_t totalBytes = 0;
+
+    std::mutex mutex;
+    std::list<Entry> lru; // Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+};
@@ -0,0 +1,154 @@
+#include "ImageProbe.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+uint16_t be16(const uint8_t* p) {
+    return uint16_t((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+// Random access over either a memory buffer or a file, so JPEG can skip segments without
+// reading them.
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+    virtual bool read(size_t offset, uint8_t* out, size_t size) = 0;
+};
+
+class MemorySource : public ByteSource {
+public:
+    MemorySource(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    bool read(size_t offset, uint8_t* out, size_t length) override {
+        if (offset > size || length > size - offset) return false;
+        std::memcpy(out, data + offset, length);
+        return true;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+};
+
+class FileSource : public ByteSource {
+public:
+    explicit FileSource(FILE* file) : file(file) {}
+
+    bool read(size_t offset, uint8_t* out, size_t length) override {
+        if (std::fseek(file, (long) offset, SEEK_SET) != 0) return false;
+        return std::fread(out, 1, length, file) == length;
+    }
+
+private:
+    FILE* file;
+};
+
+bool probePng(ByteSource& src, ImageInfo& out) {
+    // Signature (8) + IHDR length (4) + "IHDR" (4) + width, height, depth, color type
+    uint8_t header[26];
+    if (!src.read(0, header, sizeof(header))) return false;
+    if (std::memcmp(header + 12, "IHDR", 4) != 0) return false;
+
+    out.width = (int) be32(header + 16);
+    out.height = (int) be32(header + 20);
+
+    switch (header[25]) {
+        case 0: out.channels = 1; break; // Gray
+        case 2: out.channels = 3; break; // RGB
+        case 3: out.channels = 3; break; // Palette (4 with a tRNS chunk, which needs a full scan)
+        case 4: out.channels = 2; break; // Gray + alpha
+        case 6: out.channels = 4; break; // RGBA
+        default: return false;
+    }
+    return true;
+}
+
+bool probeQoi(ByteSource& src, ImageInfo& out) {
+    uint8_t header[14];
+    if (!src.read(0, header, sizeof(header))) return false;
+
+    out.width = (int) be32(header + 4);
+    out.height = (int) be32(header + 8);
+    out.channels = header[12];
+    return out.channels == 3 || out.channels == 4;
+}
+
+bool probeJpeg(ByteSource& src, ImageInfo& out) {
+    size_t offset = 2; // After SOI
+
+    // Walk the segment headers until a start-of-frame, skipping everything else
+    for (int guard = 0; guard < 1024; ++guard) {
+        uint8_t marker[4];
+        if (!src.read(offset, marker, sizeof(marker))) return false;
+
+        if (marker[0] != 0xFF) return false;
+        if (marker[1] == 0xFF) { // Fill byte
+            offset += 1;
+            continue;
+        }
+
+        uint8_t type = marker[1];
+        uint16_t length = be16(marker + 2);
+
+        // Markers without a payload
+        if (type == 0xD8 || type == 0x01 || (type >= 0xD0 && type <= 0xD7)) {
+            offset += 2;
+            continue;
+        }
+
+        bool isFrame = type >= 0xC0 && type <= 0xCF && type != 0xC4 && type != 0xC8 && type != 0xCC;
+        if (isFrame) {
+            // Precision (1), height (2), width (2), components (1)
+            uint8_t frame[6];
+            if (!src.read(offset + 4, frame, sizeof(frame))) return false;
+
+            out.height = be16(frame + 1);
+            out.width = be16(frame + 3);
+            out.channels = frame[5];
+            return out.width > 0 && out.height > 0;
+        }
+
+        if (type == 0xD9 || type == 0xDA) return false; // End of image / start of scan without a frame
+        if (length < 2) return false;
+        offset += 2 + length;
+    }
+    return false;
+}
+
+bool probeSource(ByteSource& src, ImageInfo& out) {
+    uint8_t magic[8];
+    if (!src.read(0, magic, 4)) return false;
+
+    if (std::memcmp(magic, "qoif", 4) == 0) return probeQoi(src, out);
+    if (magic[0] == 0xFF && magic[1] == 0xD8) return probeJpeg(src, out);
+
+    static const uint8_t pngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    if (src.read(0, magic, 8) && std::memcmp(magic, pngSignature, 8) == 0) return probePng(src, out);
+
+    return false;
+}
+
+}
+
+bool probeImage(const uint8_t* data, size_t size, ImageInfo& out) {
+    if (data == nullptr) return false;
+    MemorySource src(data, size);
+    return probeSource(src, out);
+}
+
+bool probeImageFile(const std::string& path, ImageInfo& out) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    FileSource src(file);
+    bool ok = probeSource(src, out);
+    std::fclose(file);
+    return ok;
+}
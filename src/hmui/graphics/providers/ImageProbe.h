@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "hmui/graphics/GraphicsContext.h"
+
+// Header-only metadata readers for PNG, JPEG and QOI. No pixel data is decoded.
+
+// Probes an in-memory encoded image (e.g. the bytes given to D_RawTextureProvider).
+bool probeImage(const uint8_t* data, size_t size, ImageInfo& out);
+
+// Probes a file on disk, reading only the header (and JPEG segment headers up to SOF).
+bool probeImageFile(const std::string& path, ImageInfo& out);
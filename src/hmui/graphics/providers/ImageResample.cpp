@@ -0,0 +1,133 @@
+#include "ImageResample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HMUI_RESAMPLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HMUI_RESAMPLE_NEON 1
+#endif
+
+namespace {
+
+// Two output pixels (eight input pixels over two rows) per iteration.
+int halveRowSimd(const uint8_t* row0, const uint8_t* row1, uint8_t* out, int outWidth) {
+    int x = 0;
+#if defined(HMUI_RESAMPLE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+
+    for (; x + 2 <= outWidth; x += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*) (row0 + x * 8));
+        __m128i b = _mm_loadu_si128((const __m128i*) (row1 + x * 8));
+
+        // Vertical sums, 16 bits per channel: [p0 p1] and [p2 p3]
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+        // Horizontal pair sums: p0 + p1 and p2 + p3 in the low halves
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+        __m128i sum = _mm_unpacklo_epi64(lo, hi);
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        _mm_storel_epi64((__m128i*) (out + x * 4), _mm_packus_epi16(sum, zero));
+    }
+#elif defined(HMUI_RESAMPLE_NEON)
+    for (; x + 2 <= outWidth; x += 2) {
+        uint8x16_t a = vld1q_u8(row0 + x * 8);
+        uint8x16_t b = vld1q_u8(row1 + x * 8);
+
+        uint16x8_t lo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));   // [p0 p1]
+        uint16x8_t hi = vaddl_u8(vget_high_u8(a), vget_high_u8(b)); // [p2 p3]
+
+        uint16x8_t sum = vcombine_u16(vadd_u16(vget_low_u16(lo), vget_high_u16(lo)),
+                                      vadd_u16(vget_low_u16(hi), vget_high_u16(hi)));
+        vst1_u8(out + x * 4, vrshrn_n_u16(sum, 2));
+    }
+#endif
+    return x;
+}
+
+}
+
+void halveRGBA8(const uint8_t* src, int width, int height, uint8_t* dst) {
+    int outWidth = width / 2;
+    int outHeight = height / 2;
+    size_t stride = (size_t) width * 4;
+
+    for (int y = 0; y < outHeight; ++y) {
+        const uint8_t* row0 = src + (size_t) (y * 2) * stride;
+        const uint8_t* row1 = row0 + stride;
+        uint8_t* out = dst + (size_t) y * outWidth * 4;
+
+        int x = halveRowSimd(row0, row1, out, outWidth);
+
+        // Scalar tail (and the whole row without SIMD)
+        for (; x < outWidth; ++x) {
+            const uint8_t* a = row0 + x * 8;
+            const uint8_t* b = row1 + x * 8;
+            for (int c = 0; c < 4; ++c) {
+                out[x * 4 + c] = (uint8_t) ((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+            }
+        }
+    }
+}
+
+void downscaleRGBA8(const uint8_t* src, int width, int height, uint8_t* dst, int dstWidth, int dstHeight) {
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> next;
+    const uint8_t* pixels = src;
+
+    // 1. Halve while we stay at or above the target, this does most of the work
+    while (width / 2 >= dstWidth && height / 2 >= dstHeight && width >= 2 && height >= 2) {
+        next.resize((size_t) (width / 2) * (height / 2) * 4);
+        halveRGBA8(pixels, width, height, next.data());
+        current.swap(next);
+        pixels = current.data();
+        width /= 2;
+        height /= 2;
+    }
+
+    if (width == dstWidth && height == dstHeight) {
+        std::memcpy(dst, pixels, (size_t) width * height * 4);
+        return;
+    }
+
+    // 2. Exact area filter for the remaining (< 2x) factor
+    float scaleX = (float) width / dstWidth;
+    float scaleY = (float) height / dstHeight;
+
+    for (int y = 0; y < dstHeight; ++y) {
+        float y0 = y * scaleY;
+        float y1 = std::min((float) height, y0 + scaleY);
+
+        for (int x = 0; x < dstWidth; ++x) {
+            float x0 = x * scaleX;
+            float x1 = std::min((float) width, x0 + scaleX);
+
+            float sum[4] = {0, 0, 0, 0};
+            float area = 0.0f;
+
+            for (int sy = (int) y0; sy < (int) std::ceil(y1); ++sy) {
+                float wy = std::min(y1, (float) sy + 1) - std::max(y0, (float) sy);
+                for (int sx = (int) x0; sx < (int) std::ceil(x1); ++sx) {
+                    float w = wy * (std::min(x1, (float) sx + 1) - std::max(x0, (float) sx));
+                    const uint8_t* p = pixels + ((size_t) sy * width + sx) * 4;
+                    for (int c = 0; c < 4; ++c) sum[c] += p[c] * w;
+                    area += w;
+                }
+            }
+
+            uint8_t* out = dst + ((size_t) y * dstWidth + x) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[c] = (uint8_t) std::clamp(sum[c] / area + 0.5f, 0.0f, 255.0f);
+            }
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+// CPU resampling for RGBA8 images, used at load time to avoid keeping (and sampling)
+// textures that are far larger than they are ever drawn.
+
+// Halves both dimensions with a 2x2 box filter. Uses SSE2 or NEON when available.
+// dst must hold (width / 2) * (height / 2) pixels; an odd last row/column is dropped.
+void halveRGBA8(const uint8_t* src, int width, int height, uint8_t* dst);
+
+// Area-averaging downscale to an arbitrary smaller size. Repeated halving runs first,
+// the exact area filter only covers the remaining factor (< 2x).
+// dst must hold dstWidth * dstHeight pixels.
+void downscaleRGBA8(const uint8_t* src, int width, int height, uint8_t* dst, int dstWidth, int dstHeight);
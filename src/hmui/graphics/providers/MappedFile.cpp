@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+
+#include <fstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif !defined(__SWITCH__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HMUI_MAPPED_FILE_MMAP 1
+#endif
+
+namespace {
+
+bool mapFile(const std::string& path, void*& mapping, const uint8_t*& bytes, size_t& size) {
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER length;
+    HANDLE map = nullptr;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!map) return false;
+
+    void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(map);
+    if (!view) return false;
+
+    mapping = view;
+    bytes = (const uint8_t*) view;
+    size = (size_t) length.QuadPart;
+    return true;
+#elif defined(HMUI_MAPPED_FILE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        view = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    mapping = view;
+    bytes = (const uint8_t*) view;
+    size = (size_t) st.st_size;
+    return true;
+#else
+    (void) path; (void) mapping; (void) bytes; (void) size;
+    return false;
+#endif
+}
+
+void unmapFile(void* mapping, size_t size) {
+#if defined(_WIN32)
+    (void) size;
+    UnmapViewOfFile(mapping);
+#elif defined(HMUI_MAPPED_FILE_MMAP)
+    munmap(mapping, size);
+#else
+    (void) mapping; (void) size;
+#endif
+}
+
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    auto file = std::unique_ptr<MappedFile>(new MappedFile());
+    if (mapFile(path, file->mapping, file->bytes, file->byteCount)) {
+        return file;
+    }
+
+    // No mmap (romfs) or it failed: a single read
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) return nullptr;
+
+    std::streamsize length = stream.tellg();
+    if (length <= 0) return nullptr;
+    stream.seekg(0);
+
+    file->buffer.resize((size_t) length);
+    if (!stream.read((char*) file->buffer.data(), length)) return nullptr;
+
+    file->bytes = file->buffer.data();
+    file->byteCount = file->buffer.size();
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    if (mapping) {
+        unmapFile(mapping, byteCount);
+    }
+}
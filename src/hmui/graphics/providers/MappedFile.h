@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Memory-mapped where the platform allows it, read into
+// memory once otherwise (e.g. romfs on Switch), callers see the same bytes either way.
+class MappedFile {
+public:
+    // Returns nullptr if the file is missing or empty.
+    static std::unique_ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return byteCount; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    MappedFile() = default;
+
+    const uint8_t* bytes = nullptr;
+    size_t byteCount = 0;
+    void* mapping = nullptr;
+    std::vector<uint8_t> buffer;
+};
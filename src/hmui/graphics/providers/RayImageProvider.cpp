@@ -1,63 +1,519 @@
 #include "RayImageProvider.h"
+#include "ImageProbe.h"
+#include "ImageResample.h"
+#include "ContentHash.h"
+#include "DiskTextureCache.h"
+#include "hmui/util/RenderThread.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
-std::unordered_map<std::string, ImageHandle> textureCache;
-std::unordered_map<std::string, Texture2D> loadedTextures;
+// Textures are shared by path; widgets acquire and release them as they scroll in and out
+// of view, so every entry counts its users and is unloaded by the last one. Entries live on
+// the heap: a pipelined frame may still be drawing a handle after its last user let go.
+// An entry is in the cache from the moment its first user starts creating it; ready tells
+// the others when it has been uploaded, or that it could not be.
+struct CachedTexture {
+    Texture2D texture;
+    ImageHandle handle;
+    int refs = 0;
+    size_t residentBytes = 0;
+    size_t sourceBytes = 0;
+    std::shared_future<bool> ready;
+};
 
-ImageHandle* D_TextureProvider::load() {
+// Shared by every HMUI instance in the process, which may run on different threads. The
+// mutex only covers lookups and bookkeeping: probing, decoding and uploading happen outside.
+std::unordered_map<std::string, std::unique_ptr<CachedTexture>> textureCache;
+ImageCacheStats cacheStats;
+std::mutex cacheMutex;
+
+ImageCacheStats getImageCacheStats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheStats;
+}
+
+// Size the image needs to be for the hints: enough pixels to cover the hinted box
+// (BoxFit::Cover needs the most), or false if it is not worth resampling.
+static bool targetSize(int width, int height, const ImageLoadHints& hints, int& outW, int& outH) {
+    if (width <= 0 || height <= 0) return false;
+
+    float sx = hints.maxWidth > 0 ? (float) hints.maxWidth / width : 0.0f;
+    float sy = hints.maxHeight > 0 ? (float) hints.maxHeight / height : 0.0f;
+    float s = std::max(sx, sy);
+
+    // No hint, or less than 2x oversized: the GPU's bilinear filter copes fine
+    if (s <= 0.0f || s > 0.5f) return false;
+
+    outW = std::max(1, (int) std::ceil(width * s));
+    outH = std::max(1, (int) std::ceil(height * s));
+    return true;
+}
+
+static size_t imageBytes(const Image& img) {
+    size_t bytes = 0;
+    int w = img.width;
+    int h = img.height;
+    for (int level = 0; level < std::max(1, img.mipmaps); ++level) {
+        bytes += GetPixelDataSize(w, h, img.format);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    return bytes;
+}
+
+// The load-time pipeline: shrinks the decoded image to what it will be drawn at and
+// builds the mip chain if asked, in place.
+static void processImage(Image& img, const ImageLoadHints& hints) {
+    int targetW = 0, targetH = 0;
+    bool resize = targetSize(img.width, img.height, hints, targetW, targetH);
+    bool mipmaps = hints.mipmaps && img.width > 1 && img.height > 1;
+
+    if (resize || mipmaps) {
+        ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (!resize) {
+            targetW = img.width;
+            targetH = img.height;
+        }
+
+        // Levels are stored back to back, the layout LoadTextureFromImage expects
+        int levels = 1;
+        size_t total = (size_t) targetW * targetH * 4;
+        if (mipmaps) {
+            for (int w = targetW, h = targetH; w >= 2 && h >= 2; w /= 2, h /= 2) {
+                total += (size_t) (w / 2) * (h / 2) * 4;
+                levels++;
+            }
+        }
+
+        auto* pixels = (uint8_t*) MemAlloc((unsigned int) total);
+        if (resize) {
+            downscaleRGBA8((const uint8_t*) img.data, img.width, img.height, pixels, targetW, targetH);
+        } else {
+            std::copy_n((const uint8_t*) img.data, (size_t) targetW * targetH * 4, pixels);
+        }
+
+        uint8_t* level = pixels;
+        for (int i = 1, w = targetW, h = targetH; i < levels; ++i, w /= 2, h /= 2) {
+            uint8_t* next = level + (size_t) w * h * 4;
+            halveRGBA8(level, w, h, next);
+            level = next;
+        }
+
+        UnloadImage(img);
+        img.data = pixels;
+        img.width = targetW;
+        img.height = targetH;
+        img.mipmaps = levels;
+    }
+}
+
+// GPU work runs on the render thread, loads may come from a pipelined UI thread
+static Texture2D loadTextureOnRenderThread(const Image& img) {
+    Texture2D texture;
+    RenderThread::call([&]() {
+        texture = LoadTextureFromImage(img);
+        if (img.mipmaps > 1) {
+            SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+        }
+    });
+    return texture;
+}
+
+PreparedImage::PreparedImage(PreparedImage&& other) noexcept
+    : image(other.image), disk(std::move(other.disk)), sourceBytes(other.sourceBytes),
+      diskHit(other.diskHit), diskStored(other.diskStored) {
+    other.image.data = nullptr;
+}
+
+PreparedImage::~PreparedImage() {
+    if (image.data && !disk.file) {
+        UnloadImage(image);
+    }
+}
+
+// The disk cache key for a source: the size processImage() will make of it, so hints that
+// come out the same share an entry. That size is only known before decoding if the source
+// could be probed; otherwise the key has no source hash and the disk cache is skipped.
+static DiskTextureKey diskKey(uint64_t sourceHash, bool probed, const ImageInfo& source,
+                              const ImageLoadHints& hints) {
+    if (!probed) return DiskTextureKey{};
+
+    int width = source.width, height = source.height;
+    targetSize(source.width, source.height, hints, width, height);
+    return DiskTextureKey{sourceHash, width, height, hints.mipmaps};
+}
+
+// The pixels for a source: from the disk cache when it has them processed, otherwise
+// decode() + processImage(), storing the result for the next launch. A key without a source
+// hash bypasses the disk cache. CPU only, safe on any thread.
+static PreparedImage prepareImage(const DiskTextureKey& key, const std::function<Image()>& decode,
+                                  const ImageLoadHints& hints) {
+    PreparedImage prepared;
+
+    DiskTextureCache* disk = key.sourceHash ? DiskTextureCache::get() : nullptr;
+
+    if (disk && disk->load(key, prepared.disk)) {
+        // Uploaded straight from the mapping
+        prepared.image.data = (void*) prepared.disk.data;
+        prepared.image.width = prepared.disk.width;
+        prepared.image.height = prepared.disk.height;
+        prepared.image.mipmaps = prepared.disk.mipmaps;
+        prepared.image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        prepared.sourceBytes = prepared.disk.sourceBytes;
+        prepared.diskHit = true;
+        return prepared;
+    }
+
+    Image& img = prepared.image;
+    img = decode();
+    prepared.sourceBytes = imageBytes(img);
+    processImage(img, hints);
+
+    // A probe that disagrees with the decoder would file the pixels under the wrong size
+    if (disk && img.data && img.width == key.width && img.height == key.height) {
+        if (img.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        }
+        disk->store(key, img.width, img.height, img.mipmaps, prepared.sourceBytes,
+                    (const uint8_t*) img.data, imageBytes(img));
+        prepared.diskStored = true;
+    }
+
+    return prepared;
+}
+
+// Fills in a new cache entry (texture, handle, sizes) and what it adds to the stats, or
+// returns false if there is nothing to upload. Runs without the cache lock.
+using CreateTexture = std::function<bool(CachedTexture&, ImageCacheStats&)>;
+
+// The texture for cacheKey, holding a reference to it. The first provider to ask creates it;
+// any asking meanwhile wait for that instead of decoding the same image again. Creating one
+// texture never holds up lookups or releases of the others.
+static ImageHandle* acquireTexture(const std::string& cacheKey, const CreateTexture& create) {
+    std::unique_lock<std::mutex> lock(cacheMutex);
+
+    auto it = textureCache.find(cacheKey);
+    if (it != textureCache.end()) {
+        CachedTexture* entry = it->second.get();
+        entry->refs++;
+        std::shared_future<bool> ready = entry->ready;
+        lock.unlock();
+
+        // A failed entry is gone from the cache by now, and so is the reference
+        return ready.get() ? &entry->handle : nullptr;
+    }
+
+    std::promise<bool> created;
+    CachedTexture* entry = textureCache.emplace(cacheKey, std::make_unique<CachedTexture>()).first->second.get();
+    entry->refs = 1;
+    entry->ready = created.get_future().share();
+    lock.unlock();
+
+    ImageCacheStats added;
+    bool ok = false;
+    try {
+        ok = create(*entry, added);
+    } catch (...) {
+        lock.lock();
+        textureCache.erase(cacheKey);
+        lock.unlock();
+        created.set_exception(std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    if (ok) {
+        cacheStats.textures++;
+        cacheStats.residentBytes += entry->residentBytes;
+        cacheStats.sourceBytes += entry->sourceBytes;
+        cacheStats.diskHits += added.diskHits;
+        cacheStats.diskMisses += added.diskMisses;
+    } else {
+        textureCache.erase(cacheKey);
+    }
+    lock.unlock();
+
+    created.set_value(ok);
+    return ok ? &entry->handle : nullptr;
+}
+
+// Shared by the file and raw providers: uploads a finished prefetch, or prepares the image
+// right now as a last resort.
+static CreateTexture createPrepared(std::future<PreparedImage>& pending, const std::function<PreparedImage()>& prepare) {
+    return [&pending, prepare](CachedTexture& entry, ImageCacheStats& added) {
+        PreparedImage prepared = pending.valid() ? pending.get() : prepare();
+        if (prepared.diskHit) added.diskHits++;
+        if (prepared.diskStored) added.diskMisses++;
+
+        entry.texture = loadTextureOnRenderThread(prepared.image);
+        entry.residentBytes = imageBytes(prepared.image);
+        entry.sourceBytes = prepared.sourceBytes;
+        entry.handle = {
+            entry.texture.width,
+            entry.texture.height,
+            (void*) &entry.texture
+        };
+        return true;
+    };
+}
+
+static bool isPendingReady(const std::future<PreparedImage>& pending) {
+    return !pending.valid() || pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// A prefetch another provider's texture made unnecessary: waits for it and frees the pixels
+static void dropPending(std::future<PreparedImage>& pending) {
+    if (pending.valid()) pending.get();
+}
+
+// Also true while another provider is still creating it, prefetching would only decode twice
+static bool isCached(const std::string& cacheKey) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return textureCache.count(cacheKey) > 0;
+}
+
+// Identity of a file without reading it: path, size and modification time
+static uint64_t fileSourceHash(const std::string& path) {
+    std::error_code sizeError, timeError;
+    uint64_t size = (uint64_t) std::filesystem::file_size(path, sizeError);
+    auto time = std::filesystem::last_write_time(path, timeError);
+    if (sizeError || timeError) return 0;
+
+    uint64_t fields[2] = { size, (uint64_t) time.time_since_epoch().count() };
+    return xxh64(fields, sizeof(fields), xxh64(path.data(), path.size()));
+}
+
+// Drops one reference to cacheKey's texture. The last one takes the entry out of the cache
+// right away, but the handle and the texture are only freed once the frame that may still
+// draw them has been submitted.
+static void releaseTexture(const std::string& cacheKey) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = textureCache.find(cacheKey);
+    if (it == textureCache.end() || --it->second->refs > 0) return;
+
+    std::shared_ptr<CachedTexture> retired = std::move(it->second);
+    textureCache.erase(it);
+
+    cacheStats.textures--;
+    cacheStats.residentBytes -= retired->residentBytes;
+    cacheStats.sourceBytes -= retired->sourceBytes;
+
+    RenderThread::retire([retired]() { UnloadTexture(retired->texture); });
+}
+
+D_TextureProvider::D_TextureProvider(const std::string& path) : imagePath(path), texture(nullptr) {
 #ifdef __SWITCH__
     if (imagePath.rfind("assets/", 0) == 0) {
         imagePath = "romfs:/" + imagePath.substr(7);
-        printf("Adjusted image path for Switch: %s\n", imagePath.c_str());
     }
 #endif
+}
 
-    auto it = textureCache.find(imagePath);
-    if (it != textureCache.end()) {
-        return &it->second;
+// Key on the size we will actually upload, so two widgets showing the same file at the
+// same size share a texture, while a thumbnail does not pin the full-resolution one
+std::string D_TextureProvider::makeCacheKey() {
+    std::string key = imagePath;
+    ImageInfo source;
+    int targetW = 0, targetH = 0;
+    if (probe(source) && targetSize(source.width, source.height, hints, targetW, targetH)) {
+        key += "@" + std::to_string(targetW) + "x" + std::to_string(targetH);
     }
+    if (hints.mipmaps) key += "+mips";
+    return key;
+}
 
-    Texture2D texture = LoadTexture(imagePath.c_str());
-    loadedTextures[imagePath] = texture;
-    textureCache[imagePath] = {
-        texture.width,
-        texture.height,
-        (void*) &loadedTextures[imagePath]
-    };
+ImageHandle* D_TextureProvider::load() {
+    if (texture) return texture;
+
+    cacheKey = makeCacheKey();
+    texture = acquireTexture(cacheKey, createPrepared(pending, [&]() {
+        ImageInfo source;
+        bool probed = probe(source);
+        return prepareImage(diskKey(fileSourceHash(imagePath), probed, source, hints),
+                            [&]() { return LoadImage(imagePath.c_str()); }, hints);
+    }));
+    dropPending(pending);
+    return texture;
+}
+
+void D_TextureProvider::prefetch() {
+    if (texture || pending.valid()) return;
+    if (isCached(makeCacheKey())) return;
+
+    ImageInfo source;
+    bool probed = probe(source);
+    pending = std::async(std::launch::async, [path = imagePath, hints = hints, probed, source]() {
+        return prepareImage(diskKey(fileSourceHash(path), probed, source, hints),
+                            [&]() { return LoadImage(path.c_str()); }, hints);
+    });
+}
 
-    return &textureCache[imagePath];
+bool D_TextureProvider::isReady() {
+    return texture || isPendingReady(pending);
 }
 
 void D_TextureProvider::dispose() {
-    auto it = textureCache.find(imagePath);
-    if (it != textureCache.end()) {
-        UnloadTexture(*(Texture2D*)it->second.handle);
-        textureCache.erase(it);
+    if (!texture) return;
+    texture = nullptr;
+
+    releaseTexture(cacheKey);
+}
+
+void D_TextureProvider::setLoadHints(const ImageLoadHints& loadHints) {
+    hints = loadHints;
+}
+
+bool D_TextureProvider::probe(ImageInfo& out) {
+    // Remember failures too, so layout does not hit the disk every frame
+    std::call_once(probed, [this]() {
+        if (!probeImageFile(imagePath, info)) info = ImageInfo{};
+    });
+
+    out = info;
+    return info.width > 0 && info.height > 0;
+}
+
+D_RawTextureProvider::D_RawTextureProvider(std::span<const uint8_t> bytes)
+    : textureBytes(bytes), contentHash(xxh64(bytes.data(), bytes.size())) {}
+
+D_RawTextureProvider::D_RawTextureProvider(std::shared_ptr<const std::vector<uint8_t>> bytes)
+    : owned(std::move(bytes)), textureBytes(*owned), contentHash(xxh64(owned->data(), owned->size())) {}
+
+D_RawTextureProvider::D_RawTextureProvider(std::vector<uint8_t> bytes)
+    : D_RawTextureProvider(std::make_shared<const std::vector<uint8_t>>(std::move(bytes))) {}
+
+// Same bytes + same processing = same texture, whichever provider asked first
+std::string D_RawTextureProvider::makeCacheKey() {
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "raw:%016llx:%zu", (unsigned long long) contentHash, textureBytes.size());
+
+    std::string key = prefix;
+    ImageInfo source;
+    int targetW = 0, targetH = 0;
+    if (probe(source) && targetSize(source.width, source.height, hints, targetW, targetH)) {
+        key += "@" + std::to_string(targetW) + "x" + std::to_string(targetH);
     }
+    if (hints.mipmaps) key += "+mips";
+    return key;
 }
 
 ImageHandle* D_RawTextureProvider::load() {
     if (texture) return texture;
 
-    Image img = LoadImageFromMemory(".png", textureBytes.data(), textureBytes.size());
-    Texture2D tex = LoadTextureFromImage(img);
-    UnloadImage(img);
+    cacheKey = makeCacheKey();
+    texture = acquireTexture(cacheKey, createPrepared(pending, [&]() {
+        ImageInfo source;
+        bool probed = probe(source);
+        return prepareImage(diskKey(contentHash, probed, source, hints), [&]() {
+            return LoadImageFromMemory(".png", textureBytes.data(), (int) textureBytes.size());
+        }, hints);
+    }));
+    dropPending(pending);
+    return texture;
+}
 
-    texture = new ImageHandle {
-        tex.width,
-        tex.height,
-        (void*) new Texture2D(tex)
-    };
+void D_RawTextureProvider::prefetch() {
+    if (texture || pending.valid()) return;
+    if (isCached(makeCacheKey())) return;
 
-    return texture;
+    ImageInfo source;
+    DiskTextureKey key = diskKey(contentHash, probe(source), source, hints);
+
+    // Borrowed bytes must outlive the provider anyway, owned ones are kept alive by the capture
+    pending = std::async(std::launch::async, [bytes = textureBytes, keep = owned, key, hints = hints]() {
+        return prepareImage(key, [&]() {
+            return LoadImageFromMemory(".png", bytes.data(), (int) bytes.size());
+        }, hints);
+    });
+}
+
+bool D_RawTextureProvider::isReady() {
+    return texture || isPendingReady(pending);
 }
 
 void D_RawTextureProvider::dispose() {
-    if (texture) {
-        UnloadTexture(*(Texture2D*)texture->handle);
-        delete (Texture2D*)texture->handle;
-        delete texture;
-        texture = nullptr;
+    if (!texture) return;
+    texture = nullptr;
+
+    releaseTexture(cacheKey);
+}
+
+void D_RawTextureProvider::setLoadHints(const ImageLoadHints& loadHints) {
+    hints = loadHints;
+}
+
+bool D_RawTextureProvider::probe(ImageInfo& out) {
+    return probeImage(textureBytes.data(), textureBytes.size(), out);
+}
+
+D_PackTextureProvider::D_PackTextureProvider(std::shared_ptr<AssetPack> pack, const std::string& name)
+    : pack(std::move(pack)), name(name), texture(nullptr) {
+    cacheKey = "pack:" + this->pack->getPath() + ":" + name;
+}
+
+static bool packPixelFormat(AssetPackFormat format, int& out) {
+    switch (format) {
+        case AssetPackFormat::RGBA8: out = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8; return true;
+        case AssetPackFormat::ETC2_RGBA: out = PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA; return true;
+        case AssetPackFormat::ASTC_4x4_RGBA: out = PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA; return true;
+        case AssetPackFormat::DXT5_RGBA: out = PIXELFORMAT_COMPRESSED_DXT5_RGBA; return true;
     }
-}
\ No newline at end of file
+    return false;
+}
+
+ImageHandle* D_PackTextureProvider::load() {
+    if (texture) return texture;
+
+    texture = acquireTexture(cacheKey, [this](CachedTexture& cached, ImageCacheStats&) {
+        AssetPackTexture entry;
+        int format = 0;
+        if (!pack->find(name, entry) || !packPixelFormat(entry.format, format)) {
+            return false;
+        }
+
+        // The image points into the mapping, LoadTextureFromImage uploads from there directly
+        Image img;
+        img.data = (void*) entry.data;
+        img.width = entry.width;
+        img.height = entry.height;
+        img.mipmaps = entry.mipmaps;
+        img.format = format;
+
+        cached.texture = loadTextureOnRenderThread(img);
+        cached.residentBytes = cached.sourceBytes = entry.size;
+        cached.handle = {
+            cached.texture.width,
+            cached.texture.height,
+            (void*) &cached.texture,
+            entry.premultiplied
+        };
+        return true;
+    });
+    return texture;
+}
+
+void D_PackTextureProvider::dispose() {
+    if (!texture) return;
+    texture = nullptr;
+
+    releaseTexture(cacheKey);
+}
+
+bool D_PackTextureProvider::probe(ImageInfo& out) {
+    AssetPackTexture entry;
+    if (!pack->find(name, entry)) return false;
+
+    out.width = entry.width;
+    out.height = entry.height;
+    out.channels = 4;
+    return true;
+}
@@ -1,32 +1,119 @@
 #pragma once
 
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 #include "raylib.h"
 #include "hmui/graphics/GraphicsContext.h"
+#include "AssetPack.h"
+#include "DiskTextureCache.h"
+
+// Texture memory held by the image providers. sourceBytes is what the same textures would
+// take at their decoded size without mips, the difference is what load-time downscaling saved.
+struct ImageCacheStats {
+    size_t textures = 0;
+    size_t residentBytes = 0;
+    size_t sourceBytes = 0;
+    size_t diskHits = 0;    // Textures uploaded from DiskTextureCache without decoding
+    size_t diskMisses = 0;
+
+    size_t savedBytes() const {
+        return sourceBytes > residentBytes ? sourceBytes - residentBytes : 0;
+    }
+};
+
+ImageCacheStats getImageCacheStats();
+
+// The CPU half of a texture load: processed pixels, decoded or read from the disk cache.
+// Producing one touches no GPU state, so prefetch() builds it on a worker thread and
+// load() only has to upload it.
+struct PreparedImage {
+    Image image{};       // Owned, unless it points into disk.file
+    DiskTexture disk;
+    size_t sourceBytes = 0;
+    bool diskHit = false;
+    bool diskStored = false;
+
+    PreparedImage() = default;
+    PreparedImage(PreparedImage&& other) noexcept;
+    PreparedImage& operator=(PreparedImage&&) = delete;
+    ~PreparedImage();
+};
 
 class D_TextureProvider : public ImageProvider {
 public:
-    explicit D_TextureProvider(const std::string& path) : imagePath(path) {}
+    explicit D_TextureProvider(const std::string& path);
 
     ImageHandle* load() override;
     void dispose() override;
+    bool probe(ImageInfo& out) override;
+    void setLoadHints(const ImageLoadHints& hints) override;
+    void prefetch() override;
+    bool isReady() override;
 
 private:
+    std::string makeCacheKey();
+
     std::string imagePath;
+    std::string cacheKey; // Path + processed size, the same file can be resident at several sizes
+    ImageLoadHints hints;
+    std::future<PreparedImage> pending;
     ImageHandle* texture;
+    ImageInfo info;
+    std::once_flag probed; // Layout may probe from several threads (ParallelLayout)
 };
 
+// Decodes an encoded image held in memory. The bytes are either borrowed (a span over
+// embedded data the caller keeps alive) or shared, never copied. Decoded textures are
+// deduplicated by content hash, so any number of providers over identical bytes share
+// one texture, released by the last of them.
 class D_RawTextureProvider : public ImageProvider {
 public:
-    explicit D_RawTextureProvider(const std::vector<uint8_t>& bytes)
-        : textureBytes(bytes), texture(nullptr) {}
+    explicit D_RawTextureProvider(std::span<const uint8_t> bytes);
+    explicit D_RawTextureProvider(std::shared_ptr<const std::vector<uint8_t>> bytes);
+    explicit D_RawTextureProvider(std::vector<uint8_t> bytes);
+
+    ImageHandle* load() override;
+    void dispose() override;
+    bool probe(ImageInfo& out) override;
+    void setLoadHints(const ImageLoadHints& hints) override;
+    void prefetch() override;
+    bool isReady() override;
+
+    uint64_t getContentHash() const { return contentHash; }
+
+private:
+    std::string makeCacheKey();
+
+    std::shared_ptr<const std::vector<uint8_t>> owned;
+    std::span<const uint8_t> textureBytes;
+    uint64_t contentHash;
+    std::string cacheKey;
+    ImageLoadHints hints;
+    std::future<PreparedImage> pending;
+    ImageHandle* texture = nullptr;
+};
+
+// Uploads a prebaked texture straight out of a mapped AssetPack: no file IO, no decode.
+// Textures are shared between providers of the same pack entry.
+class D_PackTextureProvider : public ImageProvider {
+public:
+    D_PackTextureProvider(std::shared_ptr<AssetPack> pack, const std::string& name);
+
     ImageHandle* load() override;
     void dispose() override;
+    bool probe(ImageInfo& out) override;
+
 private:
-    std::vector<uint8_t> textureBytes;
+    std::shared_ptr<AssetPack> pack;
+    std::string name;
+    std::string cacheKey;
     ImageHandle* texture;
 };
 
 #define TextureProvider(path) std::dynamic_pointer_cast<ImageProvider>(std::make_shared<D_TextureProvider>(path))
-#define RawTextureProvider(bytes) std::dynamic_pointer_cast<ImageProvider>(std::make_shared<D_RawTextureProvider>(bytes))
\ No newline at end of file
+#define RawTextureProvider(bytes) std::dynamic_pointer_cast<ImageProvider>(std::make_shared<D_RawTextureProvider>(bytes))
+#define PackTextureProvider(pack, name) std::dynamic_pointer_cast<ImageProvider>(std::make_shared<D_PackTextureProvider>(pack, name))
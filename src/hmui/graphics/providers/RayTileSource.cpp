@@ -0,0 +1,212 @@
+#include "RayTileSource.h"
+#include "RayImageProvider.h"
+#include "ImageProbe.h"
+#include "ImageResample.h"
+#include "hmui/util/RenderThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+
+#include "raylib.h"
+
+class D_RawTileSource::Pyramid {
+public:
+    explicit Pyramid(std::shared_ptr<const std::vector<uint8_t>> bytes) : bytes(std::move(bytes)) {}
+
+    // Decodes and downsamples up to the level on the first call for it, blocking while
+    // another thread does. nullptr past the 1x1 level or if the image does not decode.
+    std::shared_ptr<const Level> get(int level) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (levels.empty()) {
+            auto base = std::make_shared<Level>();
+            Image img = LoadImageFromMemory(".png", bytes->data(), (int) bytes->size());
+            if (img.data) {
+                ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                base->width = img.width;
+                base->height = img.height;
+                base->pixels.assign((const uint8_t*) img.data, (const uint8_t*) img.data + (size_t) img.width * img.height * 4);
+                UnloadImage(img);
+            }
+            levels.push_back(base);
+        }
+
+        while ((int) levels.size() <= level) {
+            const Level& previous = *levels.back();
+            if (previous.width < 2 || previous.height < 2) return nullptr;
+
+            auto next = std::make_shared<Level>();
+            next->width = previous.width / 2;
+            next->height = previous.height / 2;
+            next->pixels.resize((size_t) next->width * next->height * 4);
+            halveRGBA8(previous.pixels.data(), previous.width, previous.height, next->pixels.data());
+            levels.push_back(next);
+        }
+
+        return levels[level];
+    }
+
+private:
+    std::shared_ptr<const std::vector<uint8_t>> bytes;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<const Level>> levels;
+};
+
+namespace {
+
+// One rectangle of a pyramid level. prefetch() builds the level if needed and copies the
+// region out on a worker thread, so load() only uploads.
+class RegionTextureProvider : public ImageProvider {
+public:
+    RegionTextureProvider(std::shared_ptr<D_RawTileSource::Pyramid> pyramid, int level, int x, int y, int width, int height)
+        : pyramid(std::move(pyramid)), level(level), x(x), y(y), width(width), height(height) {}
+
+    ~RegionTextureProvider() override {
+        dispose();
+    }
+
+    ImageHandle* load() override {
+        if (resident) return &resident->handle;
+
+        std::vector<uint8_t> region = pending.valid() ? pending.get() : cut(*pyramid, level, x, y, width, height);
+        if (region.empty()) return nullptr;
+
+        Image img;
+        img.data = region.data();
+        img.width = width;
+        img.height = height;
+        img.mipmaps = 1;
+        img.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+        resident = std::make_shared<Resident>();
+        RenderThread::call([&]() { resident->texture = LoadTextureFromImage(img); });
+        resident->handle = { resident->texture.width, resident->texture.height, (void*) &resident->texture };
+        return &resident->handle;
+    }
+
+    void prefetch() override {
+        if (resident || pending.valid()) return;
+        pending = std::async(std::launch::async, [pyramid = pyramid, level = level, x = x, y = y, w = width, h = height]() {
+            return cut(*pyramid, level, x, y, w, h);
+        });
+    }
+
+    bool isReady() override {
+        return resident || !pending.valid() || pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // The provider goes away with its evicted tile, the frame being submitted may still
+    // draw the handle
+    void dispose() override {
+        if (!resident) return;
+        RenderThread::retire([retired = std::move(resident)]() { UnloadTexture(retired->texture); });
+        resident = nullptr;
+    }
+
+    bool probe(ImageInfo& out) override {
+        out = ImageInfo{width, height, 4};
+        return true;
+    }
+
+private:
+    struct Resident {
+        Texture2D texture{};
+        ImageHandle handle{};
+    };
+
+    // Empty if the level could not be decoded
+    static std::vector<uint8_t> cut(D_RawTileSource::Pyramid& pyramid, int level, int x, int y, int width, int height) {
+        auto pixels = pyramid.get(level);
+        if (!pixels || x + width > pixels->width || y + height > pixels->height) return {};
+
+        std::vector<uint8_t> region((size_t) width * height * 4);
+        for (int row = 0; row < height; ++row) {
+            std::memcpy(&region[(size_t) row * width * 4],
+                        &pixels->pixels[((size_t) (y + row) * pixels->width + x) * 4],
+                        (size_t) width * 4);
+        }
+        return region;
+    }
+
+    std::shared_ptr<D_RawTileSource::Pyramid> pyramid;
+    int level, x, y, width, height;
+    std::future<std::vector<uint8_t>> pending;
+    std::shared_ptr<Resident> resident;
+};
+
+void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+}
+
+D_DirectoryTileSource::D_DirectoryTileSource(std::string directory, int width, int height, int tileSize, int levels,
+                                             std::string pattern)
+    : directory(std::move(directory)), pattern(std::move(pattern)),
+      width(width), height(height), tileSize(tileSize), levels(levels) {}
+
+std::shared_ptr<ImageProvider> D_DirectoryTileSource::getTile(int level, int column, int row) {
+    if (level < 0 || level >= levels || column < 0 || row < 0 ||
+        column >= getColumns(level) || row >= getRows(level)) {
+        return nullptr;
+    }
+
+    std::string path = pattern;
+    replaceAll(path, "{level}", std::to_string(level));
+    replaceAll(path, "{col}", std::to_string(column));
+    replaceAll(path, "{row}", std::to_string(row));
+
+    return TextureProvider(directory + "/" + path);
+}
+
+D_RawTileSource::D_RawTileSource(std::shared_ptr<const std::vector<uint8_t>> bytes, int tileSize)
+    : pyramid(std::make_shared<Pyramid>(bytes)), tileSize(tileSize) {
+    if (!probeImage(bytes->data(), bytes->size(), info)) {
+        info = ImageInfo{};
+    }
+}
+
+// Trust the decoder over a header we could not probe
+void D_RawTileSource::probeByDecoding() {
+    auto base = pyramid->get(0);
+    info = ImageInfo{base->width, base->height, 4};
+}
+
+int D_RawTileSource::getWidth() {
+    if (info.width == 0) probeByDecoding();
+    return info.width;
+}
+
+int D_RawTileSource::getHeight() {
+    if (info.height == 0) probeByDecoding();
+    return info.height;
+}
+
+int D_RawTileSource::getLevelCount() {
+    // Down to the level that fits in a single tile
+    int levels = 1;
+    int size = std::max(getWidth(), getHeight());
+    while ((size >> (levels - 1)) > tileSize) levels++;
+    return levels;
+}
+
+// Sized from the header: each level is the previous one halved, rounding down, as
+// halveRGBA8() builds it
+std::shared_ptr<ImageProvider> D_RawTileSource::getTile(int level, int column, int row) {
+    if (level < 0 || level >= getLevelCount() || column < 0 || row < 0) return nullptr;
+
+    int levelWidth = getWidth() >> level;
+    int levelHeight = getHeight() >> level;
+    int x = column * tileSize;
+    int y = row * tileSize;
+    if (x >= levelWidth || y >= levelHeight) return nullptr;
+
+    int w = std::min(tileSize, levelWidth - x);
+    int h = std::min(tileSize, levelHeight - y);
+    return std::make_shared<RegionTextureProvider>(pyramid, level, x, y, w, h);
+}
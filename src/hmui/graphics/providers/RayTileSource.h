@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "hmui/graphics/TileSource.h"
+
+// Pre-cut tiles on disk, one image file per tile. The pattern is relative to the
+// directory and may use {level}, {col} and {row}, e.g. "{level}/{col}_{row}.png".
+class D_DirectoryTileSource : public TileSource {
+public:
+    D_DirectoryTileSource(std::string directory, int width, int height, int tileSize, int levels,
+                          std::string pattern = "{level}/{col}_{row}.png");
+
+    int getWidth() override { return width; }
+    int getHeight() override { return height; }
+    int getTileSize() override { return tileSize; }
+    int getLevelCount() override { return levels; }
+
+    std::shared_ptr<ImageProvider> getTile(int level, int column, int row) override;
+
+private:
+    std::string directory;
+    std::string pattern;
+    int width;
+    int height;
+    int tileSize;
+    int levels;
+};
+
+// Cuts an encoded image held in memory into tiles. Its size comes from the header; the
+// image is decoded, and lower levels are box-filtered from it, by the first tile of a
+// level to be prefetched, on that tile's worker thread. Each tile only uploads its own
+// region. An image whose header cannot be probed is decoded the first time its size is asked.
+class D_RawTileSource : public TileSource {
+public:
+    D_RawTileSource(std::shared_ptr<const std::vector<uint8_t>> bytes, int tileSize = 256);
+
+    int getWidth() override;
+    int getHeight() override;
+    int getTileSize() override { return tileSize; }
+    int getLevelCount() override;
+
+    std::shared_ptr<ImageProvider> getTile(int level, int column, int row) override;
+
+    // Decoded RGBA8 pixels of one pyramid level
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    // The levels decoded so far, shared with the tiles so they can build missing ones
+    class Pyramid;
+
+private:
+    void probeByDecoding();
+
+    std::shared_ptr<Pyramid> pyramid;
+    int tileSize;
+    ImageInfo info;
+};
+
+#define DirectoryTileSource(...) std::make_shared<D_DirectoryTileSource>(__VA_ARGS__)
+#define RawTileSource(...) std::make_shared<D_RawTileSource>(__VA_ARGS__)
@@ -0,0 +1,290 @@
+#include "FontMetrics.h"
+#include "Utf8.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// Minimal big-endian reader over the font file, every access is bounds checked.
+struct FontReader {
+    const std::vector<uint8_t>& data;
+
+    bool has(size_t offset, size_t size) const {
+        return offset <= data.size() && size <= data.size() - offset;
+    }
+
+    uint16_t u16(size_t offset) const {
+        if (!has(offset, 2)) return 0;
+        return uint16_t((data[offset] << 8) | data[offset + 1]);
+    }
+
+    int16_t i16(size_t offset) const {
+        return static_cast<int16_t>(u16(offset));
+    }
+
+    uint32_t u32(size_t offset) const {
+        if (!has(offset, 4)) return 0;
+        return (uint32_t(data[offset]) << 24) | (uint32_t(data[offset + 1]) << 16) |
+               (uint32_t(data[offset + 2]) << 8) | uint32_t(data[offset + 3]);
+    }
+
+    // Returns the offset of a table, or 0 if the font does not have it.
+    size_t table(const char* tag) const {
+        uint16_t numTables = u16(4);
+        for (uint16_t i = 0; i < numTables; ++i) {
+            size_t record = 12 + i * 16;
+            if (!has(record, 16)) return 0;
+            if (data[record] == tag[0] && data[record + 1] == tag[1] &&
+                data[record + 2] == tag[2] && data[record + 3] == tag[3]) {
+                return u32(record + 8);
+            }
+        }
+        return 0;
+    }
+};
+
+// Walks the preferred cmap subtable and reports every (codepoint, glyph) mapping.
+template <typename Fn>
+bool forEachMapping(const FontReader& font, size_t cmap, Fn&& fn) {
+    uint16_t numTables = font.u16(cmap + 2);
+    size_t best = 0;
+    int bestRank = 0;
+
+    for (uint16_t i = 0; i < numTables; ++i) {
+        size_t record = cmap + 4 + i * 8;
+        uint16_t platform = font.u16(record);
+        uint16_t encoding = font.u16(record + 2);
+        size_t subtable = cmap + font.u32(record + 4);
+        uint16_t format = font.u16(subtable);
+
+        // Prefer full Unicode (format 12) over BMP-only (format 4)
+        int rank = 0;
+        if (format == 12 && (platform == 3 || platform == 0)) rank = 3;
+        else if (format == 4 && platform == 3 && encoding == 1) rank = 2;
+        else if (format == 4 && platform == 0) rank = 1;
+
+        if (rank > bestRank) {
+            bestRank = rank;
+            best = subtable;
+        }
+    }
+
+    if (best == 0) return false;
+
+    if (font.u16(best) == 12) {
+        uint32_t groups = font.u32(best + 12);
+        for (uint32_t g = 0; g < groups; ++g) {
+            size_t group = best + 16 + g * 12;
+            if (!font.has(group, 12)) break;
+            uint32_t start = font.u32(group);
+            uint32_t end = font.u32(group + 4);
+            uint32_t glyph = font.u32(group + 8);
+            for (uint32_t cp = start; cp <= end && cp <= 0x10FFFF; ++cp) {
+                fn(cp, glyph + (cp - start));
+            }
+        }
+        return true;
+    }
+
+    uint16_t segCount = font.u16(best + 6) / 2;
+    size_t endCodes = best + 14;
+    size_t startCodes = endCodes + segCount * 2 + 2;
+    size_t idDeltas = startCodes + segCount * 2;
+    size_t idRangeOffsets = idDeltas + segCount * 2;
+
+    for (uint16_t s = 0; s < segCount; ++s) {
+        uint16_t end = font.u16(endCodes + s * 2);
+        uint16_t start = font.u16(startCodes + s * 2);
+        uint16_t delta = font.u16(idDeltas + s * 2);
+        uint16_t rangeOffset = font.u16(idRangeOffsets + s * 2);
+
+        for (uint32_t cp = start; cp <= end && cp != 0xFFFF; ++cp) {
+            uint32_t glyph;
+            if (rangeOffset == 0) {
+                glyph = (cp + delta) & 0xFFFF;
+            } else {
+                size_t at = idRangeOffsets + s * 2 + rangeOffset + (cp - start) * 2;
+                glyph = font.u16(at);
+                if (glyph != 0) glyph = (glyph + delta) & 0xFFFF;
+            }
+            if (glyph != 0) fn(cp, glyph);
+        }
+    }
+    return true;
+}
+
+}
+
+std::shared_ptr<const FontMetrics> FontMetrics::fromTrueType(const std::vector<uint8_t>& data, float pixelHeight,
+                                                             std::string sourcePath) {
+    FontReader font{data};
+    if (!font.has(0, 12)) return nullptr;
+
+    size_t head = font.table("head");
+    size_t hhea = font.table("hhea");
+    size_t hmtx = font.table("hmtx");
+    size_t cmap = font.table("cmap");
+    if (head == 0 || hhea == 0 || hmtx == 0 || cmap == 0) return nullptr;
+
+    int ascender = font.i16(hhea + 4);
+    int descender = font.i16(hhea + 6);
+    uint16_t numHMetrics = font.u16(hhea + 34);
+    if (ascender - descender <= 0 || numHMetrics == 0) return nullptr;
+
+    // Same scale as stbtt_ScaleForPixelHeight, which both raylib and ImGui rasterize with
+    float scale = pixelHeight / float(ascender - descender);
+
+    auto glyphAdvance = [&](uint32_t glyph) {
+        uint32_t index = glyph < numHMetrics ? glyph : numHMetrics - 1u;
+        return font.u16(hmtx + index * 4) * scale;
+    };
+
+    auto metrics = std::shared_ptr<FontMetrics>(new FontMetrics());
+    metrics->pixelHeight = pixelHeight;
+    metrics->lineHeight = pixelHeight;
+    metrics->ascent = ascender * scale;
+    metrics->sourcePath = std::move(sourcePath);
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> glyphCodepoints;
+
+    bool mapped = forEachMapping(font, cmap, [&](uint32_t cp, uint32_t glyph) {
+        float advance = glyphAdvance(glyph);
+        if (cp < 128) {
+            metrics->asciiAdvance[cp] = advance;
+        } else {
+            metrics->otherAdvance[cp] = advance;
+        }
+        glyphCodepoints[glyph].push_back(cp);
+    });
+    if (!mapped) return nullptr;
+
+    metrics->fallbackAdvance = glyphAdvance(0);
+
+    // Legacy 'kern' table, format 0 horizontal pairs. GPOS kerning is not read.
+    if (size_t kern = font.table("kern")) {
+        uint16_t numTables = font.u16(kern + 2);
+        size_t subtable = kern + 4;
+
+        for (uint16_t t = 0; t < numTables && font.has(subtable, 6); ++t) {
+            uint16_t length = font.u16(subtable + 2);
+            uint16_t coverage = font.u16(subtable + 4);
+            bool horizontal = (coverage & 0x1) != 0;
+            uint8_t format = coverage >> 8;
+
+            if (horizontal && format == 0) {
+                uint16_t numPairs = font.u16(subtable + 6);
+                for (uint16_t p = 0; p < numPairs; ++p) {
+                    size_t pair = subtable + 14 + p * 6;
+                    if (!font.has(pair, 6)) break;
+
+                    auto left = glyphCodepoints.find(font.u16(pair));
+                    auto right = glyphCodepoints.find(font.u16(pair + 2));
+                    if (left == glyphCodepoints.end() || right == glyphCodepoints.end()) continue;
+
+                    float value = font.i16(pair + 4) * scale;
+                    for (uint32_t l : left->second) {
+                        for (uint32_t r : right->second) {
+                            metrics->kerningPairs[pairKey(l, r)] = value;
+                            if (l < 128 && r < 128) metrics->asciiKerning = true;
+                        }
+                    }
+                }
+            }
+
+            if (length == 0) break;
+            subtable += length;
+        }
+    }
+
+    // Printable ASCII sharing one advance is enough to take the monospace fast path
+    metrics->monospaced = !metrics->hasKerning();
+    for (uint32_t cp = 33; cp < 127 && metrics->monospaced; ++cp) {
+        metrics->monospaced = metrics->asciiAdvance[cp] == metrics->asciiAdvance[32];
+    }
+
+    return metrics;
+}
+
+std::shared_ptr<const FontMetrics> FontMetrics::fromFile(const std::string& path, float pixelHeight) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return nullptr;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return fromTrueType(data, pixelHeight, path);
+}
+
+std::shared_ptr<const FontMetrics> FontMetrics::monospace(float advance, float lineHeight, float ascent) {
+    auto metrics = std::shared_ptr<FontMetrics>(new FontMetrics());
+    metrics->asciiAdvance.fill(advance);
+    metrics->fallbackAdvance = advance;
+    metrics->pixelHeight = lineHeight;
+    metrics->lineHeight = lineHeight;
+    metrics->ascent = ascent;
+    metrics->monospaced = true;
+    return metrics;
+}
+
+std::shared_ptr<const FontMetrics> FontMetrics::fromAdvances(const std::vector<std::pair<uint32_t, float>>& advances,
+                                                             float fallbackAdvance, float pixelHeight,
+                                                             float lineHeight, float ascent) {
+    auto metrics = std::shared_ptr<FontMetrics>(new FontMetrics());
+    metrics->asciiAdvance.fill(fallbackAdvance);
+    metrics->fallbackAdvance = fallbackAdvance;
+    metrics->pixelHeight = pixelHeight;
+    metrics->lineHeight = lineHeight;
+    metrics->ascent = ascent;
+
+    for (const auto& [cp, advance] : advances) {
+        if (cp < 128) {
+            metrics->asciiAdvance[cp] = advance;
+        } else {
+            metrics->otherAdvance[cp] = advance;
+        }
+    }
+
+    metrics->monospaced = true;
+    for (uint32_t cp = 33; cp < 127 && metrics->monospaced; ++cp) {
+        metrics->monospaced = metrics->asciiAdvance[cp] == metrics->asciiAdvance[32];
+    }
+
+    return metrics;
+}
+
+float FontMetrics::kerning(uint32_t left, uint32_t right) const {
+    if (kerningPairs.empty()) return 0.0f;
+    auto it = kerningPairs.find(pairKey(left, right));
+    return it != kerningPairs.end() ? it->second : 0.0f;
+}
+
+Rect FontMetrics::measure(std::string_view text, float scale) const {
+    float height = lineHeight * scale;
+
+    bool ascii = true;
+    for (char c : text) {
+        if (static_cast<uint8_t>(c) >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+
+    // Fast paths: fixed advance, or per-byte table lookups without kerning
+    if (ascii && monospaced && fallbackAdvance == asciiAdvance[32]) {
+        return Rect(0, 0, float(text.size()) * fallbackAdvance * scale, height);
+    }
+
+    float width = 0.0f;
+    if (ascii && !asciiKerning) {
+        for (char c : text) width += asciiAdvance[static_cast<uint8_t>(c)];
+        return Rect(0, 0, width * scale, height);
+    }
+
+    uint32_t previous = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t cp = decodeUtf8(text, i);
+        width += advance(cp) + (previous ? kerning(previous, cp) : 0.0f);
+        previous = cp;
+    }
+
+    return Rect(0, 0, width * scale, height);
+}
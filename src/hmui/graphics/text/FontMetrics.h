@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hmui/graphics/GraphicsContext.h"
+
+// Advance, kerning and vertical metrics for one font face at one pixel height.
+// Everything is loaded up front and never mutated afterwards, so a FontMetrics can be
+// shared between threads and queried from layout running off the render thread.
+class FontMetrics {
+public:
+    // Parses hhea/hmtx/cmap/kern from a TrueType/OpenType (glyf) font.
+    // Returns nullptr if the data is not a font we understand.
+    static std::shared_ptr<const FontMetrics> fromTrueType(const std::vector<uint8_t>& data, float pixelHeight,
+                                                           std::string sourcePath = "");
+    static std::shared_ptr<const FontMetrics> fromFile(const std::string& path, float pixelHeight);
+
+    // Fixed-advance metrics for monospace or bitmap fonts.
+    static std::shared_ptr<const FontMetrics> monospace(float advance, float lineHeight, float ascent);
+
+    // Per-codepoint advances for a bitmap font a backend draws itself; codepoints not listed
+    // advance by fallbackAdvance.
+    static std::shared_ptr<const FontMetrics> fromAdvances(const std::vector<std::pair<uint32_t, float>>& advances,
+                                                           float fallbackAdvance, float pixelHeight,
+                                                           float lineHeight, float ascent);
+
+    // Matches ImGui's built-in ProggyClean font (7x13), used when no font is configured.
+    static std::shared_ptr<const FontMetrics> defaultFont() {
+        return monospace(7.0f, 13.0f, 10.0f);
+    }
+
+    float advance(uint32_t codepoint) const {
+        if (codepoint < 128) return asciiAdvance[codepoint];
+        auto it = otherAdvance.find(codepoint);
+        return it != otherAdvance.end() ? it->second : fallbackAdvance;
+    }
+
+    float kerning(uint32_t left, uint32_t right) const;
+
+    // Size of a single line of text at the given scale (no wrapping).
+    Rect measure(std::string_view text, float scale = 1.0f) const;
+
+    float getPixelHeight() const { return pixelHeight; }
+    float getLineHeight() const { return lineHeight; }
+    float getAscent() const { return ascent; }
+    bool isMonospace() const { return monospaced; }
+    bool hasKerning() const { return !kerningPairs.empty(); }
+
+    // Font file these metrics were read from, empty for built-in metrics.
+    // Backends load the same file so glyphs land where layout expects them.
+    const std::string& getSourcePath() const { return sourcePath; }
+
+private:
+    FontMetrics() { asciiAdvance.fill(0.0f); }
+
+    static uint64_t pairKey(uint32_t left, uint32_t right) {
+        return (uint64_t(left) << 32) | right;
+    }
+
+    std::array<float, 128> asciiAdvance;
+    std::unordered_map<uint32_t, float> otherAdvance;
+    std::unordered_map<uint64_t, float> kerningPairs;
+    float fallbackAdvance = 0.0f;
+    float pixelHeight = 0.0f;
+    float lineHeight = 0.0f;
+    float ascent = 0.0f;
+    bool monospaced = false;
+    bool asciiKerning = false;
+    std::string sourcePath;
+};
@@ -0,0 +1,112 @@
+#include "GlyphAtlas.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const AtlasGlyph& GlyphAtlas::getGlyph(uint32_t codepoint, int pixelSize) {
+    SizeCache& cache = sizes[pixelSize];
+
+    int32_t* slot = nullptr;
+    if (codepoint < 128) {
+        slot = &cache.ascii[codepoint];
+    } else {
+        slot = &cache.other.try_emplace(codepoint, -1).first->second;
+    }
+
+    if (*slot >= 0) {
+        return glyphs[*slot];
+    }
+
+    AtlasGlyph glyph;
+    GlyphBitmap bitmap;
+    if (rasterizer->rasterize(codepoint, pixelSize, bitmap)) {
+        glyph.offsetX = bitmap.offsetX;
+        glyph.offsetY = bitmap.offsetY;
+
+        int x = 0, y = 0;
+        if (bitmap.width > 0 && bitmap.height > 0 && pack(bitmap.width, bitmap.height, glyph.page, x, y)) {
+            Page& page = pages[glyph.page];
+            for (int row = 0; row < bitmap.height; ++row) {
+                std::memcpy(&page.alpha[(y + row) * PAGE_SIZE + x],
+                            &bitmap.alpha[row * bitmap.width], bitmap.width);
+            }
+            page.dirty = true;
+            glyph.src = Rect((float) x, (float) y, (float) bitmap.width, (float) bitmap.height);
+        }
+    }
+
+    *slot = static_cast<int32_t>(glyphs.size());
+    glyphs.push_back(glyph);
+    return glyphs.back();
+}
+
+bool GlyphAtlas::pack(int width, int height, int& page, int& x, int& y) {
+    int w = width + PADDING;
+    int h = height + PADDING;
+    if (w > PAGE_SIZE || h > PAGE_SIZE) {
+        return false;
+    }
+
+    // Only the newest page is open for packing; older pages are full.
+    if (pages.empty()) {
+        pages.emplace_back();
+    }
+
+    Page* current = &pages.back();
+
+    // Start a new shelf if this glyph does not fit horizontally
+    if (current->shelfX + w > PAGE_SIZE) {
+        current->shelfY += current->shelfHeight;
+        current->shelfX = 0;
+        current->shelfHeight = 0;
+    }
+
+    // Start a new page if the shelf does not fit vertically
+    if (current->shelfY + h > PAGE_SIZE) {
+        pages.emplace_back();
+        current = &pages.back();
+    }
+
+    page = static_cast<int>(pages.size()) - 1;
+    x = current->shelfX;
+    y = current->shelfY;
+
+    current->shelfX += w;
+    current->shelfHeight = std::max(current->shelfHeight, h);
+    return true;
+}
+
+void GlyphAtlas::layout(std::string_view text, float x, float y, const FontMetrics& metrics, float scale,
+                        std::vector<GlyphQuad>& out) {
+    int pixelSize = std::max(1, (int) std::lround(metrics.getPixelHeight() * scale));
+
+    float penX = x;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t cp = decodeUtf8(text, i);
+        if (previous) penX += metrics.kerning(previous, cp) * scale;
+
+        const AtlasGlyph& glyph = getGlyph(cp, pixelSize);
+        if (glyph.page >= 0) {
+            out.push_back(GlyphQuad{
+                glyph.page,
+                glyph.src,
+                Rect(penX + glyph.offsetX, y + glyph.offsetY, glyph.src.width, glyph.src.height)
+            });
+        }
+
+        penX += metrics.advance(cp) * scale;
+        previous = cp;
+    }
+}
+
+void GlyphAtlas::flush(const std::function<void(int, const Page&)>& upload) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].dirty) {
+            upload(static_cast<int>(i), pages[i]);
+            pages[i].dirty = false;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "hmui/graphics/GraphicsContext.h"
+#include "FontMetrics.h"
+
+// A single rasterized glyph, 8-bit coverage, as produced by a GlyphRasterizer.
+struct GlyphBitmap {
+    int width = 0;
+    int height = 0;
+    float offsetX = 0.0f; // Pen position -> top-left of the bitmap
+    float offsetY = 0.0f; // Line top -> top-left of the bitmap
+    std::vector<uint8_t> alpha;
+};
+
+// Backend hook that turns a codepoint into pixels. The atlas calls it only on cache misses.
+class GlyphRasterizer {
+public:
+    virtual ~GlyphRasterizer() = default;
+    virtual bool rasterize(uint32_t codepoint, int pixelSize, GlyphBitmap& out) = 0;
+};
+
+// Where a glyph lives inside the atlas. Pen advances come from FontMetrics, not from here.
+struct AtlasGlyph {
+    int page = -1;
+    Rect src;             // Pixel rect inside the page (empty for whitespace)
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+};
+
+// One textured quad of laid-out text, in the caller's coordinate space.
+struct GlyphQuad {
+    int page;
+    Rect src;
+    Rect dst;
+};
+
+// Dynamic glyph atlas: glyphs are rasterized on first use at the pixel size they are
+// drawn with and shelf-packed into fixed-size pages. The backend uploads dirty pages
+// once per frame, so any amount of text at a handful of sizes costs a handful of textures.
+class GlyphAtlas {
+public:
+    static constexpr int PAGE_SIZE = 512;
+    static constexpr int PADDING = 1;
+
+    struct Page {
+        std::vector<uint8_t> alpha = std::vector<uint8_t>(PAGE_SIZE * PAGE_SIZE, 0);
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+        bool dirty = false;
+    };
+
+    explicit GlyphAtlas(std::unique_ptr<GlyphRasterizer> rasterizer)
+        : rasterizer(std::move(rasterizer)) {}
+
+    // Returns the cached glyph, rasterizing and packing it on a miss.
+    const AtlasGlyph& getGlyph(uint32_t codepoint, int pixelSize);
+
+    // Appends one quad per visible glyph, with the pen starting at (x, y). Glyph positions
+    // follow the metrics' advances and kerning, so drawn text matches what layout measured.
+    void layout(std::string_view text, float x, float y, const FontMetrics& metrics, float scale,
+                std::vector<GlyphQuad>& out);
+
+    // Calls upload(pageIndex, page) for every page touched since the last call.
+    void flush(const std::function<void(int, const Page&)>& upload);
+
+    size_t pageCount() const { return pages.size(); }
+    const Page& getPage(int index) const { return pages[index]; }
+
+private:
+    // ASCII is looked up through a flat table per size; everything else goes through the map.
+    struct SizeCache {
+        std::array<int32_t, 128> ascii;
+        std::unordered_map<uint32_t, int32_t> other;
+        SizeCache() { ascii.fill(-1); }
+    };
+
+    bool pack(int width, int height, int& page, int& x, int& y);
+
+    std::unique_ptr<GlyphRasterizer> rasterizer;
+    std::unordered_map<int, SizeCache> sizes;
+    std::vector<AtlasGlyph> glyphs;
+    std::vector<Page> pages;
+};
@@ -0,0 +1,208 @@
+#include "TextLayout.h"
+#include "Utf8.h"
+
+#include <algorithm>
+
+namespace {
+
+class LineBreaker {
+public:
+    LineBreaker(const FontMetrics& metrics, std::string_view text, const TextLayoutParams& params, TextLayoutResult& out)
+        : metrics(metrics), text(text), params(params), out(out) {}
+
+    void run() {
+        size_t pos = 0;
+        while (!full) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+
+            breakParagraph(pos, end);
+            if (end >= text.size()) break;
+            pos = end + 1;
+        }
+
+        if (truncated && params.ellipsis && !out.lines.empty()) {
+            applyEllipsis();
+        }
+
+        float lineHeight = metrics.getLineHeight() * params.scale;
+        for (const auto& line : out.lines) {
+            out.width = std::max(out.width, line.width);
+        }
+        out.height = lineHeight * (float) out.lines.size();
+        out.minValidWidth = std::min(out.width, params.maxWidth);
+    }
+
+private:
+    float measure(size_t start, size_t end) const {
+        return metrics.measure(text.substr(start, end - start), params.scale).width;
+    }
+
+    // Width [start, next) adds after the glyph at previous, kerning included, so glyphs placed
+    // one at a time sum to what measure() gives for the whole run
+    float glyphWidth(size_t previous, size_t start, size_t next) const {
+        if (previous == std::string_view::npos) return measure(start, next);
+        return measure(previous, next) - measure(previous, start);
+    }
+
+    void noteBreak(float widthNeeded) {
+        out.maxValidWidth = std::min(out.maxValidWidth, widthNeeded);
+    }
+
+    // Commits [lineStart, lineEnd) as a line. Returns false once maxLines is exceeded.
+    bool emit() {
+        if (params.maxLines > 0 && (int) out.lines.size() >= params.maxLines) {
+            full = true;
+            truncated = true;
+            return false;
+        }
+
+        out.lines.push_back(TextLine{std::string(text.substr(lineStart, lineEnd - lineStart)), lineWidth});
+        lastLineStart = lineStart;
+        lineOpen = false;
+        lineWidth = 0.0f;
+        return true;
+    }
+
+    void open(size_t at) {
+        lineStart = lineEnd = at;
+        lineWidth = 0.0f;
+        lineOpen = true;
+    }
+
+    void breakParagraph(size_t start, size_t end) {
+        open(start);
+
+        size_t i = start;
+        while (i < end) {
+            size_t wordStart = i;
+            while (wordStart < end && text[wordStart] == ' ') ++wordStart;
+            if (wordStart >= end) break;
+
+            size_t wordEnd = wordStart;
+            while (wordEnd < end && text[wordEnd] != ' ') ++wordEnd;
+
+            if (lineEnd == lineStart) {
+                // First word of the paragraph, its leading spaces are kept
+                float width = measure(lineStart, wordEnd);
+                if (width <= params.maxWidth) {
+                    lineEnd = wordEnd;
+                    lineWidth = width;
+                } else {
+                    placeByGlyph(lineStart, wordEnd);
+                    if (full) return;
+                }
+            } else {
+                float gap = measure(lineEnd, wordStart);
+                float word = measure(wordStart, wordEnd);
+
+                if (lineWidth + gap + word <= params.maxWidth) {
+                    lineEnd = wordEnd;
+                    lineWidth += gap + word;
+                } else {
+                    // Spaces at a wrap point are dropped
+                    noteBreak(lineWidth + gap + word);
+                    if (!emit()) return;
+                    open(wordStart);
+
+                    if (word <= params.maxWidth) {
+                        lineEnd = wordEnd;
+                        lineWidth = word;
+                    } else {
+                        placeByGlyph(wordStart, wordEnd);
+                        if (full) return;
+                    }
+                }
+            }
+
+            i = wordEnd;
+        }
+
+        if (lineOpen) emit();
+    }
+
+    // Places [from, to) on the current line glyph by glyph, wrapping whenever the line is full.
+    void placeByGlyph(size_t from, size_t to) {
+        size_t i = from;
+        size_t previous = std::string_view::npos;
+        while (i < to) {
+            size_t next = i;
+            decodeUtf8(text, next);
+            float glyph = glyphWidth(previous, i, next);
+
+            if (lineEnd > lineStart && lineWidth + glyph > params.maxWidth) {
+                noteBreak(lineWidth + glyph);
+                if (!emit()) return;
+                open(i);
+                glyph = measure(i, next);
+            }
+
+            lineEnd = next;
+            lineWidth += glyph;
+            previous = i;
+            i = next;
+        }
+    }
+
+    // Refills the last kept line with as much of the remaining text as fits next to "...".
+    void applyEllipsis() {
+        TextLine& last = out.lines.back();
+        float ellipsis = metrics.measure(TextLayout::ELLIPSIS, params.scale).width;
+
+        size_t stop = text.find('\n', lastLineStart);
+        if (stop == std::string_view::npos) stop = text.size();
+
+        size_t end = lastLineStart;
+        size_t previous = std::string_view::npos;
+        float width = 0.0f;
+        while (end < stop) {
+            size_t next = end;
+            decodeUtf8(text, next);
+            float glyph = glyphWidth(previous, end, next);
+
+            if (width + glyph + ellipsis > params.maxWidth) {
+                noteBreak(width + glyph + ellipsis);
+                break;
+            }
+            width += glyph;
+            previous = end;
+            end = next;
+        }
+
+        // Do not leave a dangling space before the ellipsis
+        while (end > lastLineStart && text[end - 1] == ' ') {
+            --end;
+        }
+        width = measure(lastLineStart, end);
+
+        last.text.assign(text.substr(lastLineStart, end - lastLineStart));
+        last.text.append(TextLayout::ELLIPSIS);
+        last.width = width + ellipsis;
+    }
+
+    const FontMetrics& metrics;
+    std::string_view text;
+    const TextLayoutParams& params;
+    TextLayoutResult& out;
+
+    size_t lineStart = 0;
+    size_t lineEnd = 0;
+    size_t lastLineStart = 0;
+    float lineWidth = 0.0f;
+    bool lineOpen = false;
+    bool full = false;
+    bool truncated = false;
+};
+
+}
+
+void TextLayout::breakLines(const FontMetrics& metrics, std::string_view text,
+                            const TextLayoutParams& params, TextLayoutResult& out) {
+    out.lines.clear();
+    out.width = 0.0f;
+    out.height = 0.0f;
+    out.minValidWidth = 0.0f;
+    out.maxValidWidth = INFINITY;
+
+    LineBreaker(metrics, text, params, out).run();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FontMetrics.h"
+
+struct TextLayoutParams {
+    float scale = 1.0f;
+    float maxWidth = INFINITY;  // INFINITY disables word wrapping (explicit '\n' still breaks)
+    int maxLines = 0;           // 0 = unlimited
+    bool ellipsis = false;      // Append "..." to the last line when text is cut by maxLines
+};
+
+struct TextLine {
+    std::string text;   // Ready to draw, includes the ellipsis if any
+    float width = 0.0f;
+};
+
+struct TextLayoutResult {
+    std::vector<TextLine> lines;
+    float width = 0.0f;   // Widest line
+    float height = 0.0f;
+
+    // Re-breaking yields the same lines for any maxWidth in [minValidWidth, maxValidWidth):
+    // below it the widest line overflows, at or above it the next word/glyph fits on a line.
+    float minValidWidth = 0.0f;
+    float maxValidWidth = INFINITY;
+};
+
+// Greedy word wrapping on top of FontMetrics. Words wider than a line are broken between
+// glyphs. Pure CPU code, safe to call from any thread.
+class TextLayout {
+public:
+    static constexpr std::string_view ELLIPSIS = "...";
+
+    static void breakLines(const FontMetrics& metrics, std::string_view text,
+                           const TextLayoutParams& params, TextLayoutResult& out);
+};
+
+// Per-widget cache of a line-break result. Resizing only triggers a re-break when the
+// width crosses one of the result's break points, not on every layout pass.
+class TextLayoutCache {
+public:
+    const TextLayoutResult& get(const FontMetrics& metrics, std::string_view text, const TextLayoutParams& params) {
+        if (!isValidFor(metrics, text, params)) {
+            TextLayout::breakLines(metrics, text, params, result);
+            cachedMetrics = &metrics;
+            cachedText.assign(text);
+            cachedParams = params;
+            valid = true;
+            breaks++;
+        }
+        return result;
+    }
+
+    const TextLayoutResult& getResult() const { return result; }
+    bool hasResult() const { return valid; }
+    // Times get() had to re-break; the other calls were served from the cache
+    size_t getBreakCount() const { return breaks; }
+    void invalidate() { valid = false; }
+
+private:
+    bool isValidFor(const FontMetrics& metrics, std::string_view text, const TextLayoutParams& params) const {
+        return valid &&
+               cachedMetrics == &metrics &&
+               cachedParams.scale == params.scale &&
+               cachedParams.maxLines == params.maxLines &&
+               cachedParams.ellipsis == params.ellipsis &&
+               params.maxWidth >= result.minValidWidth &&
+               (params.maxWidth < result.maxValidWidth || result.maxValidWidth == INFINITY) &&
+               cachedText == text;
+    }
+
+    bool valid = false;
+    size_t breaks = 0;
+    const FontMetrics* cachedMetrics = nullptr;
+    std::string cachedText;
+    TextLayoutParams cachedParams;
+    TextLayoutResult result;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Decodes one UTF-8 sequence starting at text[i] and advances i.
+// Malformed sequences decode to U+FFFD and consume a single byte.
+inline uint32_t decodeUtf8(std::string_view text, size_t& i) {
+    auto byte = [&](size_t at) { return static_cast<uint8_t>(text[at]); };
+
+    uint8_t lead = byte(i);
+    int length = 1;
+    uint32_t cp = lead;
+
+    if (lead >= 0xF0 && lead < 0xF8) {
+        length = 4;
+        cp = lead & 0x07;
+    } else if (lead >= 0xE0 && lead < 0xF0) {
+        length = 3;
+        cp = lead & 0x0F;
+    } else if (lead >= 0xC0 && lead < 0xE0) {
+        length = 2;
+        cp = lead & 0x1F;
+    } else if (lead >= 0x80) {
+        i += 1;
+        return 0xFFFD;
+    }
+
+    if (i + length > text.size()) {
+        i += 1;
+        return 0xFFFD;
+    }
+
+    for (int k = 1; k < length; ++k) {
+        uint8_t next = byte(i + k);
+        if ((next & 0xC0) != 0x80) {
+            i += 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (next & 0x3F);
+    }
+
+    i += length;
+    return cp;
+}
@@ -3,8 +3,16 @@
 #include <algorithm>
 #include <limits>
 #include <iostream>
+#include <stdexcept>
+#include "hmui/HMUI.h"
 
-std::shared_ptr<FocusManager> FocusManager::instance = nullptr;
+FocusManager* FocusManager::get() {
+    HMUI* hmui = HMUI::current();
+    if (hmui == nullptr) {
+        throw std::runtime_error("FocusManager used outside of an HMUI update, draw or build");
+    }
+    return hmui->getFocusManager();
+}
 
 void FocusManager::registerNode(std::shared_ptr<FocusNode> node) {
     nodes.push_back(node);
@@ -59,13 +67,15 @@ bool FocusManager::isFocused(const std::shared_ptr<FocusNode>& node) {
 }
 
 void FocusManager::submit() {
-    if (currentFocus && currentFocus->onSubmit) {
-        currentFocus->onSubmit();
+    // The callback may pop its own route, which drops the node from the scope
+    auto node = currentFocus;
+    if (node && node->onSubmit) {
+        node->onSubmit();
     }
 }
 
-Rect FocusManager::getRect(const std::weak_ptr<InternalDrawable>& ptr) {
-    if (auto widget = ptr.lock()) {
+Rect FocusManager::getRect(const InternalDrawable* widget) {
+    if (widget) {
         // We need ABSOLUTE coordinates.
         // Assuming InternalDrawable::getBounds returns relative/local bounds
         // You might need to implement a 'getAbsoluteBounds' in InternalDrawable 
@@ -90,14 +100,15 @@ void FocusManager::moveFocus(FocusDirection dir) {
     Rect currentRect = getRect(currentFocus->widget);
     Point c1 = center(currentRect);
 
-    std::shared_ptr<FocusNode> bestCandidate = nullptr;
+    // Candidates are only looked at, no reference counting until one is picked
+    const std::shared_ptr<FocusNode>* bestCandidate = nullptr;
     float bestScore = std::numeric_limits<float>::max();
 
-    for (auto& node : nodes) {
+    for (const auto& node : nodes) {
         if (node == currentFocus) continue;
         
         // Ensure widget is still valid
-        if (node->widget.expired()) continue;
+        if (!node->widget) continue;
 
         Rect targetRect = getRect(node->widget);
         Point c2 = center(targetRect);
@@ -127,13 +138,13 @@ void FocusManager::moveFocus(FocusDirection dir) {
             // You can improve this by penalizing misalignment on the secondary axis.
             if (distSq < bestScore) {
                 bestScore = distSq;
-                bestCandidate = node;
+                bestCandidate = &node;
             }
         }
     }
 
     if (bestCandidate) {
-        setFocus(bestCandidate);
+        setFocus(*bestCandidate);
         std::cout << "Focused: " << currentFocus->id << "\n";
     }
 }
@@ -176,4 +187,26 @@ void FocusManager::popScope() {
     nodes = scope.nodes;
     currentFocus = scope.currentFocus;
     focusHistory = scope.focusHistory;
-}
\ No newline at end of file
+}
+
+FocusScope FocusManager::detachScope() {
+    FocusScope detached;
+    detached.nodes = std::move(nodes);
+    detached.currentFocus = std::move(currentFocus);
+    detached.focusHistory = std::move(focusHistory);
+
+    nodes.clear();
+    currentFocus = nullptr;
+    focusHistory.clear();
+    popScope();
+
+    return detached;
+}
+
+void FocusManager::attachScope(FocusScope scope) {
+    pushScope();
+
+    nodes = std::move(scope.nodes);
+    currentFocus = std::move(scope.currentFocus);
+    focusHistory = std::move(scope.focusHistory);
+}
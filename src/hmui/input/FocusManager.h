@@ -10,7 +10,7 @@ using FocusCallback = std::function<void()>;
 
 struct FocusNode {
     std::string id;
-    std::weak_ptr<InternalDrawable> widget; // Reference to the widget (to get bounds)
+    InternalDrawable* widget = nullptr; // The widget (to get bounds), cleared when it is disposed
     FocusCallback onFocus;
     FocusCallback onBlur;
     FocusCallback onSubmit;
@@ -26,11 +26,8 @@ enum class FocusDirection { Up, Down, Left, Right };
 
 class FocusManager {
 public:
-    static std::shared_ptr<FocusManager> instance;
-    static std::shared_ptr<FocusManager> get() { 
-        if(!instance) instance = std::make_shared<FocusManager>();
-        return instance; 
-    }
+    // The focus manager of the current HMUI (HMUI::current()), throws outside of one
+    static FocusManager* get();
 
     void registerNode(std::shared_ptr<FocusNode> node);
     void unregisterNode(std::shared_ptr<FocusNode> node);
@@ -50,6 +47,11 @@ public:
     void pushScope();
     void popScope();
 
+    // Keep-alive routes: detachScope() takes the current scope out intact (restoring the one
+    // below, like popScope), attachScope() saves the current one and makes it current again.
+    FocusScope detachScope();
+    void attachScope(FocusScope scope);
+
     // Check if a specific node is focused (for visual styling)
     bool isFocused(const std::shared_ptr<FocusNode>& node);
 
@@ -64,5 +66,5 @@ private:
 
     // Helpers for spatial math
     float getDistance(const Rect& r1, const Rect& r2);
-    Rect getRect(const std::weak_ptr<InternalDrawable>& ptr);
+    Rect getRect(const InternalDrawable* widget);
 };
\ No newline at end of file
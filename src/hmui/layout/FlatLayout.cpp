@@ -0,0 +1,426 @@
+#include "FlatLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "hmui/widgets/AppContext.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/Drawable.h"
+#include "hmui/widgets/Expanded.h"
+#include "hmui/widgets/Row.h"
+#include "hmui/widgets/Scrollable.h"
+#include "hmui/widgets/FlexBox.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HMUI_LAYOUT_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HMUI_LAYOUT_NEON 1
+#endif
+
+namespace {
+
+// out[k] = start + sum(sizes[j] + gap, j < k): the main-axis offsets of a run of siblings.
+// Four at a time with an in-register scan, then the carry moves on to the next four.
+void offsetsFromSizes(const float* sizes, float* out, size_t n, float start, float gap) {
+    size_t k = 0;
+#if defined(HMUI_LAYOUT_SSE2)
+    __m128 carry = _mm_set1_ps(start);
+    const __m128 step = _mm_set1_ps(gap);
+
+    for (; k + 4 <= n; k += 4) {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(sizes + k), step);
+        __m128 sum = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(sum), 8)));
+
+        // Inclusive to exclusive
+        _mm_storeu_ps(out + k, _mm_add_ps(carry, _mm_sub_ps(sum, v)));
+        carry = _mm_add_ps(carry, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    float running = _mm_cvtss_f32(carry);
+#elif defined(HMUI_LAYOUT_NEON)
+    float32x4_t carry = vdupq_n_f32(start);
+    const float32x4_t step = vdupq_n_f32(gap);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    for (; k + 4 <= n; k += 4) {
+        float32x4_t v = vaddq_f32(vld1q_f32(sizes + k), step);
+        float32x4_t sum = vaddq_f32(v, vextq_f32(zero, v, 3));
+        sum = vaddq_f32(sum, vextq_f32(zero, sum, 2));
+
+        vst1q_f32(out + k, vaddq_f32(carry, vsubq_f32(sum, v)));
+        carry = vaddq_f32(carry, vdupq_laneq_f32(sum, 3));
+    }
+    float running = vgetq_lane_f32(carry, 0);
+#else
+    float running = start;
+#endif
+
+    for (; k < n; ++k) {
+        out[k] = running;
+        running += sizes[k] + gap;
+    }
+}
+
+void distribute(MainAxisAlignment alignment, float freeSpace, size_t count, float& offset, float& spaceBetween) {
+    switch (alignment) {
+        case MainAxisAlignment::START:
+            offset = 0.0f;
+            break;
+        case MainAxisAlignment::END:
+            offset = freeSpace;
+            break;
+        case MainAxisAlignment::CENTER:
+            offset = freeSpace / 2.0f;
+            break;
+        case MainAxisAlignment::SPACE_BETWEEN:
+            if (count > 1) spaceBetween = freeSpace / (count - 1);
+            break;
+        case MainAxisAlignment::SPACE_AROUND:
+            spaceBetween = freeSpace / count;
+            offset = spaceBetween / 2.0f;
+            break;
+    }
+}
+
+}
+
+void FlatLayout::layout(InternalDrawable* newRoot, const BoxConstraints& constraints) {
+    if (isStale(newRoot)) {
+        rebuild(newRoot);
+    }
+    if (widget.empty()) return;
+
+    layoutNode(0, constraints);
+    x[0] = 0.0f;
+    y[0] = 0.0f;
+    writeBack();
+}
+
+// D_Container::setChild() swaps a child without going through anything that bumps the
+// structure generation
+bool FlatLayout::isStale(InternalDrawable* newRoot) const {
+    if (newRoot != root || generation != InternalDrawable::getStructureGeneration()) return true;
+
+    for (uint32_t index : containers) {
+        InternalDrawable* child = static_cast<D_Container*>(target[index])->getChild().get();
+        InternalDrawable* flattened = childCount[index] > 0 ? widget[firstChild[index]] : nullptr;
+        if (child != flattened) return true;
+    }
+    return false;
+}
+
+void FlatLayout::rebuild(InternalDrawable* newRoot) {
+    root = newRoot;
+    generation = InternalDrawable::getStructureGeneration();
+    customCount = 0;
+
+    widget.clear();
+    target.clear();
+    kind.clear();
+    parent.clear();
+    firstChild.clear();
+    childCount.clear();
+    flex.clear();
+    containers.clear();
+
+    if (!root) return;
+    addChild(root, NONE);
+
+    // Breadth-first: each node appends its children as one block, so siblings are
+    // contiguous in every array and a parent's loops walk plain ranges.
+    for (uint32_t i = 0; i < widget.size(); ++i) {
+        describe(i);
+    }
+
+    size_t count = widget.size();
+    width.assign(count, 0.0f);
+    height.assign(count, 0.0f);
+    x.assign(count, 0.0f);
+    y.assign(count, 0.0f);
+}
+
+void FlatLayout::addChild(InternalDrawable* child, uint32_t parentIndex) {
+    InternalDrawable* resolved = child;
+    while (resolved && resolved->getLayoutKind() == LayoutKind::Forward) {
+        resolved = static_cast<Drawable*>(resolved)->getSelf();
+    }
+
+    widget.push_back(child);
+    target.push_back(resolved ? resolved : child);
+    kind.push_back(resolved ? resolved->getLayoutKind() : LayoutKind::Custom);
+    parent.push_back(parentIndex);
+    firstChild.push_back(0);
+    childCount.push_back(0);
+
+    // FlexBox only treats direct Expanded children as flexible
+    flex.push_back(child->getLayoutKind() == LayoutKind::Expanded
+                   ? static_cast<D_Expanded*>(child)->getProps().flex : -1);
+}
+
+// Appends a node's children
+void FlatLayout::describe(uint32_t index) {
+    InternalDrawable* node = target[index];
+    uint32_t first = (uint32_t) widget.size();
+
+    auto addChildren = [&](const ChildrenList& children) {
+        for (const auto& child : children) addChild(child.get(), index);
+    };
+    auto addSingle = [&](InternalDrawable* child) {
+        if (child) addChild(child, index);
+    };
+
+    switch (kind[index]) {
+        case LayoutKind::Column:
+            addChildren(static_cast<D_Column*>(node)->getChildren());
+            break;
+        case LayoutKind::Row:
+            addChildren(static_cast<D_Row*>(node)->getChildren());
+            break;
+        case LayoutKind::Flex:
+            addChildren(static_cast<D_FlexBox*>(node)->getProps().children);
+            break;
+        case LayoutKind::Container:
+            containers.push_back(index);
+            addSingle(static_cast<D_Container*>(node)->getChild().get());
+            break;
+        case LayoutKind::Expanded:
+            addSingle(static_cast<D_Expanded*>(node)->getProps().child.get());
+            break;
+        case LayoutKind::Fill:
+            addSingle(static_cast<D_AppContext*>(node)->getActiveView());
+            break;
+        default:
+            customCount++;
+            break;
+    }
+
+    firstChild[index] = first;
+    childCount[index] = (uint32_t) widget.size() - first;
+}
+
+// Read on every pass, the structure is all that is kept between passes
+FlatLayout::LinearParams FlatLayout::linearParams(uint32_t index) const {
+    InternalDrawable* node = target[index];
+
+    switch (kind[index]) {
+        case LayoutKind::Column: {
+            auto* column = static_cast<D_Column*>(node);
+            return {column->getMainAxisAlignment(), column->getCrossAxisAlignment(), false, false};
+        }
+        case LayoutKind::Row: {
+            auto* row = static_cast<D_Row*>(node);
+            return {row->getMainAxisAlignment(), row->getCrossAxisAlignment(), true, false};
+        }
+        default: {
+            const auto& props = static_cast<D_FlexBox*>(node)->getProps();
+            return {props.mainAxisAlignment, props.crossAxisAlignment,
+                    props.direction == Direction::Horizontal, true};
+        }
+    }
+}
+
+void FlatLayout::layoutNode(uint32_t index, const BoxConstraints& constraints) {
+    uint32_t first = firstChild[index];
+
+    switch (kind[index]) {
+        case LayoutKind::Column:
+        case LayoutKind::Row:
+        case LayoutKind::Flex:
+            layoutLinear(index, constraints);
+            break;
+
+        case LayoutKind::Container:
+            layoutContainer(index, constraints);
+            break;
+
+        case LayoutKind::Expanded:
+            // Pass-through, the flex parent decides the constraints
+            if (childCount[index] > 0) {
+                layoutNode(first, constraints);
+                width[index] = width[first];
+                height[index] = height[first];
+                x[first] = 0.0f;
+                y[first] = 0.0f;
+            } else {
+                width[index] = constraints.minWidth;
+                height[index] = constraints.minHeight;
+            }
+            break;
+
+        case LayoutKind::Fill:
+            width[index] = constraints.maxWidth;
+            height[index] = constraints.maxHeight;
+            if (childCount[index] > 0) {
+                layoutNode(first, BoxConstraints::tight(width[index], height[index]));
+                width[first] = width[index];
+                height[first] = height[index];
+                x[first] = 0.0f;
+                y[first] = 0.0f;
+            }
+            break;
+
+        default: {
+            // Not flattened: the widget lays out its own subtree
+            InternalDrawable* node = target[index];
+            node->layout(constraints);
+            Rect size = node->getBounds();
+            width[index] = size.width;
+            height[index] = size.height;
+            break;
+        }
+    }
+}
+
+void FlatLayout::layoutLinear(uint32_t index, const BoxConstraints& constraints) {
+    const LinearParams p = linearParams(index);
+    uint32_t first = firstChild[index];
+    uint32_t count = childCount[index];
+    bool horizontal = p.horizontal;
+
+    // Main/cross views over the sibling block
+    float* mainSize = (horizontal ? width.data() : height.data()) + first;
+    float* crossSize = (horizontal ? height.data() : width.data()) + first;
+    float* mainPos = (horizontal ? x.data() : y.data()) + first;
+    float* crossPos = (horizontal ? y.data() : x.data()) + first;
+    const int* flexFactor = flex.data() + first;
+
+    float minMain = horizontal ? constraints.minWidth : constraints.minHeight;
+    float maxMain = horizontal ? constraints.maxWidth : constraints.maxHeight;
+    float minCross = horizontal ? constraints.minHeight : constraints.minWidth;
+    float maxCross = horizontal ? constraints.maxHeight : constraints.maxWidth;
+
+    // Children are unbounded along the main axis
+    BoxConstraints loose = horizontal
+        ? BoxConstraints(0.0f, INFINITY, 0.0f, constraints.maxHeight)
+        : BoxConstraints(0.0f, constraints.maxWidth, 0.0f, INFINITY);
+
+    float usedMain = 0.0f;
+    float largestCross = 0.0f;
+    int totalFlex = 0;
+
+    for (uint32_t k = 0; k < count; ++k) {
+        if (p.flex && flexFactor[k] >= 0) {
+            totalFlex += flexFactor[k];
+            mainSize[k] = 0.0f;
+            crossSize[k] = 0.0f;
+            continue;
+        }
+        layoutNode(first + k, loose);
+    }
+
+    // Sizes are contiguous now, reduce them in one go
+    for (uint32_t k = 0; k < count; ++k) {
+        usedMain += mainSize[k];
+        largestCross = std::max(largestCross, crossSize[k]);
+    }
+
+    float finalMain;
+    if (p.flex) {
+        finalMain = (maxMain == INFINITY) ? usedMain : maxMain;
+        finalMain = std::max(finalMain, minMain);
+
+        if (totalFlex > 0) {
+            float spacePerFlex = std::max(0.0f, finalMain - usedMain) / totalFlex;
+
+            for (uint32_t k = 0; k < count; ++k) {
+                if (flexFactor[k] < 0) continue;
+                float flexSize = spacePerFlex * flexFactor[k];
+
+                BoxConstraints tightMain = horizontal
+                    ? BoxConstraints(flexSize, flexSize, 0.0f, constraints.maxHeight)
+                    : BoxConstraints(0.0f, constraints.maxWidth, flexSize, flexSize);
+                layoutNode(first + k, tightMain);
+                largestCross = std::max(largestCross, crossSize[k]);
+            }
+        }
+    } else {
+        finalMain = std::max(minMain, usedMain);
+        if (maxMain != INFINITY && maxMain == minMain) finalMain = maxMain;
+    }
+
+    float finalCross = std::max(minCross, largestCross);
+    if (maxCross != INFINITY && maxCross == minCross) finalCross = maxCross;
+
+    float boundsMain = std::clamp(finalMain, minMain, maxMain);
+    float boundsCross = std::clamp(finalCross, minCross, maxCross);
+    (horizontal ? width : height)[index] = boundsMain;
+    (horizontal ? height : width)[index] = boundsCross;
+
+    // Main axis: alignment, then a prefix sum over the sizes
+    float contentMain = totalFlex > 0 ? boundsMain : usedMain;
+    float freeSpace = boundsMain - contentMain;
+    float offset = 0.0f;
+    float spaceBetween = 0.0f;
+
+    bool align = p.flex ? (freeSpace > 0 && totalFlex == 0) : (freeSpace > 0 && count > 0);
+    if (align) {
+        distribute(p.mainAxis, freeSpace, count, offset, spaceBetween);
+    }
+    offsetsFromSizes(mainSize, mainPos, count, offset, spaceBetween);
+
+    // Cross axis
+    switch (p.crossAxis) {
+        case CrossAxisAlignment::START:
+            std::fill(crossPos, crossPos + count, 0.0f);
+            break;
+        case CrossAxisAlignment::CENTER:
+            for (uint32_t k = 0; k < count; ++k) crossPos[k] = (boundsCross - crossSize[k]) / 2.0f;
+            break;
+        case CrossAxisAlignment::END:
+            for (uint32_t k = 0; k < count; ++k) crossPos[k] = boundsCross - crossSize[k];
+            break;
+    }
+}
+
+// Same rules as D_Container::layout()
+void FlatLayout::layoutContainer(uint32_t index, const BoxConstraints& constraints) {
+    const ContainerProperties& p = static_cast<D_Container*>(target[index])->getProps();
+
+    float deflatedMaxWidth = std::max(0.0f, constraints.maxWidth - p.margin.left - p.margin.right);
+    float deflatedMaxHeight = std::max(0.0f, constraints.maxHeight - p.margin.top - p.margin.bottom);
+    float deflatedMinWidth = std::max(0.0f, constraints.minWidth - p.margin.left - p.margin.right);
+    float deflatedMinHeight = std::max(0.0f, constraints.minHeight - p.margin.top - p.margin.bottom);
+
+    float targetMaxWidth = (p.width > 0) ? p.width : deflatedMaxWidth;
+    float targetMaxHeight = (p.height > 0) ? p.height : deflatedMaxHeight;
+
+    float contentWidth = 0.0f;
+    float contentHeight = 0.0f;
+
+    uint32_t child = firstChild[index];
+    bool hasChild = childCount[index] > 0;
+
+    if (hasChild) {
+        BoxConstraints childConstraints(0, std::max(0.0f, targetMaxWidth - p.padding.left - p.padding.right),
+                                        0, std::max(0.0f, targetMaxHeight - p.padding.top - p.padding.bottom));
+        layoutNode(child, childConstraints);
+        contentWidth = width[child];
+        contentHeight = height[child];
+    }
+
+    float finalW = (p.width > 0) ? p.width : (contentWidth + p.padding.left + p.padding.right);
+    float finalH = (p.height > 0) ? p.height : (contentHeight + p.padding.top + p.padding.bottom);
+
+    finalW = std::clamp(finalW, deflatedMinWidth, deflatedMaxWidth);
+    finalH = std::clamp(finalH, deflatedMinHeight, deflatedMaxHeight);
+    width[index] = finalW;
+    height[index] = finalH;
+
+    if (hasChild) {
+        float spaceForChildW = finalW - p.padding.left - p.padding.right;
+        float spaceForChildH = finalH - p.padding.top - p.padding.bottom;
+        x[child] = p.padding.left + (spaceForChildW - width[child]) * p.alignment.x;
+        y[child] = p.padding.top + (spaceForChildH - height[child]) * p.alignment.y;
+    }
+}
+
+// Parents before children, so a child's bounds are final even where a parent's setBounds()
+// also touches them (Expanded, AppContext)
+void FlatLayout::writeBack() {
+    for (size_t i = 0; i < widget.size(); ++i) {
+        widget[i]->setBounds(Rect(x[i], y[i], width[i], height[i]));
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "hmui/widgets/InternalDrawable.h"
+
+// Alternative to the recursive layout() pass. The widget tree is flattened once into
+// structure-of-arrays, with every node's children stored next to each other, and rebuilt
+// only when InternalDrawable::getStructureGeneration() changes or a Container's child has
+// been swapped. Only the structure is kept: sizes, padding and alignments are read from the
+// widgets on every pass, so changing them needs no rebuild. Column, Row, FlexBox,
+// Container, Expanded, AppContext and Drawable layouts then run as loops over those
+// arrays, without virtual calls or pointer chasing; main-axis offsets are a SIMD prefix
+// sum over the sibling sizes. Any other widget (LayoutKind::Custom) is laid out through
+// its own layout() as before, so the engine can be adopted one widget type at a time.
+// Results are written back with setBounds(), drawing is unchanged.
+class FlatLayout {
+public:
+    void layout(InternalDrawable* root, const BoxConstraints& constraints);
+
+    // Forces a rebuild on the next layout, e.g. after a custom widget changed its children
+    void invalidate() { root = nullptr; }
+
+    size_t getNodeCount() const { return widget.size(); }
+    size_t getCustomCount() const { return customCount; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct LinearParams {
+        MainAxisAlignment mainAxis;
+        CrossAxisAlignment crossAxis;
+        bool horizontal;
+        bool flex; // FlexBox rules: Expanded children, main size fills bounded constraints
+    };
+
+    bool isStale(InternalDrawable* newRoot) const;
+    void rebuild(InternalDrawable* newRoot);
+    void addChild(InternalDrawable* child, uint32_t parentIndex);
+    void describe(uint32_t index);
+    LinearParams linearParams(uint32_t index) const;
+
+    void layoutNode(uint32_t index, const BoxConstraints& constraints);
+    void layoutLinear(uint32_t index, const BoxConstraints& constraints);
+    void layoutContainer(uint32_t index, const BoxConstraints& constraints);
+    void writeBack();
+
+    InternalDrawable* root = nullptr;
+    uint64_t generation = 0;
+    size_t customCount = 0;
+
+    // Structure, one entry per node; a node's children are [firstChild, firstChild + childCount)
+    std::vector<InternalDrawable*> widget;  // Receives setBounds()
+    std::vector<InternalDrawable*> target;  // Describes the layout, differs for Forward nodes
+    std::vector<LayoutKind> kind;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> firstChild;
+    std::vector<uint32_t> childCount;
+    std::vector<int> flex;                  // Expanded flex factor, -1 for everything else
+    std::vector<uint32_t> containers;       // Container nodes, whose child can be swapped in place
+
+    // Per pass
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<float> x;
+    std::vector<float> y;
+};
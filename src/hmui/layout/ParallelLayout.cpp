@@ -0,0 +1,46 @@
+#include "ParallelLayout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "hmui/widgets/FrameArena.h"
+
+namespace {
+    std::unique_ptr<ThreadPool> pool;
+    std::atomic<size_t> threshold{64};
+
+    // Tasks run inside tasks while a thread helps out in TaskGroup::wait()
+    thread_local size_t taskDepth = 0;
+}
+
+ParallelLayout::TaskScope::TaskScope(HMUI* owner) : scope(owner) {
+    if (taskDepth++ == 0 && ThreadPool::isWorkerThread()) {
+        FrameArena::reset();
+    }
+}
+
+ParallelLayout::TaskScope::~TaskScope() {
+    taskDepth--;
+}
+
+void ParallelLayout::enable(size_t threads, size_t newThreshold) {
+    pool = std::make_unique<ThreadPool>(threads);
+    setThreshold(newThreshold);
+}
+
+void ParallelLayout::disable() {
+    pool.reset();
+}
+
+size_t ParallelLayout::getThreshold() {
+    return threshold.load(std::memory_order_relaxed);
+}
+
+void ParallelLayout::setThreshold(size_t newThreshold) {
+    // Weight 0 marks skipped children, those are never worth a task
+    threshold.store(std::max<size_t>(newThreshold, 1), std::memory_order_relaxed);
+}
+
+ThreadPool* ParallelLayout::getPool() {
+    return pool.get();
+}
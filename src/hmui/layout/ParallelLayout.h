@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include "hmui/HMUI.h"
+#include "hmui/util/ThreadPool.h"
+
+// Opt-in parallel layout. Containers whose children are laid out independently of each
+// other (Stack, Wrap, the non-flex pass of FlexBox) fork every child whose subtree has at
+// least getThreshold() nodes onto a work-stealing pool, lay the small ones out themselves
+// and join before positioning. Child sizes are only combined after the join, in child
+// order on the calling thread, so the result is bit-identical to a serial layout.
+// While enabled, a custom widget's layout() may run on a worker thread and must only
+// write to its own subtree.
+// The pool is shared by every HMUI instance in the process; each task runs with the HMUI
+// that forked it current, whichever thread picks it up.
+class ParallelLayout {
+public:
+    // threads: workers besides the UI thread, 0 for one per remaining hardware thread.
+    // Call outside of layout.
+    static void enable(size_t threads = 0, size_t threshold = 64);
+    static void disable();
+
+    static bool isEnabled() { return getPool() != nullptr; }
+
+    // Null while disabled. Also used by ParallelPaint.
+    static ThreadPool* getPool();
+
+    static size_t getThreshold();
+    static void setThreshold(size_t threshold);
+
+    // Set up around every forked task: makes the forking HMUI current, and on a pool thread
+    // starting an outermost task, rewinds that thread's FrameArena. Scratch memory never
+    // outlives the task that took it, so a pool thread has nothing alive between tasks.
+    class TaskScope {
+    public:
+        explicit TaskScope(HMUI* owner);
+        ~TaskScope();
+
+        TaskScope(const TaskScope&) = delete;
+        TaskScope& operator=(const TaskScope&) = delete;
+
+    private:
+        HMUI::Scope scope;
+    };
+
+    // Calls layoutChild(i) for each i in [0, count) and returns once all are done.
+    // weightOf(i) is the subtree size of child i, 0 for children layoutChild(i) skips.
+    template<typename Weight, typename Fn>
+    static void forEach(size_t count, Weight&& weightOf, Fn&& layoutChild) {
+        ThreadPool* pool = getPool();
+        if (!pool || count < 2) {
+            for (size_t i = 0; i < count; ++i) layoutChild(i);
+            return;
+        }
+
+        size_t threshold = getThreshold();
+        HMUI* owner = HMUI::current();
+        auto task = [&layoutChild, owner](size_t i) {
+            TaskScope scope(owner);
+            layoutChild(i);
+        };
+        ThreadPool::TaskGroup group(*pool);
+
+        // The last large child is kept for this thread, it would only steal it back
+        size_t kept = count;
+        for (size_t i = 0; i < count; ++i) {
+            if (weightOf(i) < threshold) continue;
+            if (kept != count) {
+                // Pointer + index, small enough for std::function not to allocate
+                auto* function = &task;
+                group.run([function, kept]() { (*function)(kept); });
+            }
+            kept = i;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (i == kept || weightOf(i) < threshold) layoutChild(i);
+        }
+
+        group.wait();
+    }
+};
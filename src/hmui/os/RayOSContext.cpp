@@ -75,6 +75,10 @@ bool RayOSContext::isGamepadButtonPressed(int id, ControllerButton button) {
     return IsGamepadButtonPressed(id, static_cast<int>(button));
 
 }
+bool RayOSContext::IsKeyboardButtonPressed(int virtualKey) {
+    return IsKeyPressed(virtualKey);
+}
+
 float RayOSContext::getGamepadAxis(int id, ControllerAxis axis) {
     return GetGamepadAxisMovement(id, static_cast<int>(axis));
 }
\ No newline at end of file
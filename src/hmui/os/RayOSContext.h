@@ -22,6 +22,7 @@ public:
     void showCursor(bool show) override;
     bool isGamepadAvailable(int id) override;
     bool isGamepadButtonPressed(int id, ControllerButton button) override;
+    bool IsKeyboardButtonPressed(int virtualKey) override;
     float getGamepadAxis(int id, ControllerAxis axis) override;
     ~RayOSContext() override = default;
 };
\ No newline at end of file
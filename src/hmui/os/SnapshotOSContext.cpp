@@ -0,0 +1,95 @@
+#include "SnapshotOSContext.h"
+
+#include "hmui/util/RenderThread.h"
+
+void SnapshotOSContext::init() {
+    RenderThread::call([this]() { source->init(); });
+}
+
+void SnapshotOSContext::dispose() {
+    RenderThread::call([this]() { source->dispose(); });
+}
+
+void SnapshotOSContext::capture() {
+    source->update();
+
+    State& back = states[1 - frontIndex];
+    back.mouseDelta = source->getMouseDelta();
+    back.mousePosition = source->getMousePosition();
+    back.mouseWheel = source->getMouseWheel();
+
+    for (int button = 0; button < MAX_MOUSE_BUTTONS; ++button) {
+        back.mousePressed[button] = source->isMouseButtonPressed(button);
+        back.mouseReleased[button] = source->isMouseButtonReleased(button);
+        back.mouseDown[button] = source->isMouseButtonDown(button);
+    }
+
+    back.touchDevice = source->isTouchDevice();
+    back.touchActive = source->isTouchActive();
+
+    for (int key = 0; key < MAX_KEYS; ++key) {
+        back.keysPressed[key] = source->IsKeyboardButtonPressed(key);
+    }
+
+    for (int id = 0; id < MAX_GAMEPADS; ++id) {
+        Gamepad& gamepad = back.gamepads[id];
+        gamepad.available = source->isGamepadAvailable(id);
+        if (!gamepad.available) {
+            gamepad = Gamepad{};
+            continue;
+        }
+
+        for (int button = 0; button < GAMEPAD_BUTTONS; ++button) {
+            gamepad.pressed[button] = source->isGamepadButtonPressed(id, static_cast<ControllerButton>(button));
+        }
+        for (int axis = 0; axis < GAMEPAD_AXES; ++axis) {
+            gamepad.axes[axis] = source->getGamepadAxis(id, static_cast<ControllerAxis>(axis));
+        }
+    }
+}
+
+void SnapshotOSContext::publish() {
+    frontIndex = 1 - frontIndex;
+}
+
+void SnapshotOSContext::setMousePosition(Coord& pos) {
+    RenderThread::post([this, pos]() mutable { source->setMousePosition(pos); });
+}
+
+void SnapshotOSContext::setMouseCursor(int cursor) {
+    RenderThread::post([this, cursor]() { source->setMouseCursor(cursor); });
+}
+
+void SnapshotOSContext::setClipboardText(const char* text) {
+    RenderThread::post([this, copy = std::string(text)]() { source->setClipboardText(copy.c_str()); });
+}
+
+const char* SnapshotOSContext::getClipboardText() {
+    RenderThread::call([this]() {
+        const char* text = source->getClipboardText();
+        clipboard = text ? text : "";
+    });
+    return clipboard.c_str();
+}
+
+void SnapshotOSContext::showCursor(bool show) {
+    RenderThread::post([this, show]() { source->showCursor(show); });
+}
+
+bool SnapshotOSContext::isGamepadAvailable(int id) {
+    return id >= 0 && id < MAX_GAMEPADS && front().gamepads[id].available;
+}
+
+bool SnapshotOSContext::isGamepadButtonPressed(int id, ControllerButton button) {
+    int index = static_cast<int>(button);
+    return isGamepadAvailable(id) && index >= 0 && index < GAMEPAD_BUTTONS && front().gamepads[id].pressed[index];
+}
+
+bool SnapshotOSContext::IsKeyboardButtonPressed(int virtualKey) {
+    return virtualKey >= 0 && virtualKey < MAX_KEYS && front().keysPressed[virtualKey];
+}
+
+float SnapshotOSContext::getGamepadAxis(int id, ControllerAxis axis) {
+    int index = static_cast<int>(axis);
+    return isGamepadAvailable(id) && index >= 0 && index < GAMEPAD_AXES ? front().gamepads[id].axes[index] : 0.0f;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <memory>
+#include <string>
+#include "OSContext.h"
+
+// Serves input from a copy of another OSContext taken once per frame, so the UI can run on a
+// different thread than the one that owns the window (FramePipeline). The render thread
+// capture()s into a back buffer and publish() swaps it in between UI frames; the UI thread
+// only ever reads the front buffer. Calls with side effects (cursor, clipboard) are run on
+// the render thread through RenderThread.
+// Keyboard state covers virtual keys below MAX_KEYS, gamepads below MAX_GAMEPADS.
+class SnapshotOSContext : public OSContext {
+public:
+    static constexpr int MAX_KEYS = 512;
+    static constexpr int MAX_GAMEPADS = 4;
+    static constexpr int MAX_MOUSE_BUTTONS = 8;
+
+    explicit SnapshotOSContext(std::shared_ptr<OSContext> source) : source(std::move(source)) {}
+
+    // Render thread
+    void capture();
+    void publish();
+
+    OSContext& getSource() { return *source; }
+
+    void init() override;
+    void update() override {}
+    void dispose() override;
+
+    Coord getMouseDelta() override { return front().mouseDelta; }
+    Coord getMousePosition() override { return front().mousePosition; }
+    void setMousePosition(Coord& pos) override;
+    Coord getMouseWheel() override { return front().mouseWheel; }
+    bool isMouseButtonPressed(int button) override { return mouseBit(front().mousePressed, button); }
+    bool isMouseButtonReleased(int button) override { return mouseBit(front().mouseReleased, button); }
+    bool isMouseButtonDown(int button) override { return mouseBit(front().mouseDown, button); }
+    void setMouseCursor(int cursor) override;
+    bool isTouchDevice() override { return front().touchDevice; }
+    bool isTouchActive() override { return front().touchActive; }
+    void setClipboardText(const char* text) override;
+    // Fetched on demand, blocks until the render thread gets to it (at most about a frame)
+    const char* getClipboardText() override;
+    void showCursor(bool show) override;
+    bool isGamepadAvailable(int id) override;
+    bool isGamepadButtonPressed(int id, ControllerButton button) override;
+    bool IsKeyboardButtonPressed(int virtualKey) override;
+    float getGamepadAxis(int id, ControllerAxis axis) override;
+
+private:
+    static constexpr int GAMEPAD_BUTTONS = static_cast<int>(ControllerButton::RIGHT_THUMB) + 1;
+    static constexpr int GAMEPAD_AXES = static_cast<int>(ControllerAxis::RIGHT_TRIGGER) + 1;
+
+    struct Gamepad {
+        bool available = false;
+        std::bitset<GAMEPAD_BUTTONS> pressed;
+        std::array<float, GAMEPAD_AXES> axes{};
+    };
+
+    struct State {
+        Coord mouseDelta;
+        Coord mousePosition;
+        Coord mouseWheel;
+        std::bitset<MAX_MOUSE_BUTTONS> mousePressed;
+        std::bitset<MAX_MOUSE_BUTTONS> mouseReleased;
+        std::bitset<MAX_MOUSE_BUTTONS> mouseDown;
+        bool touchDevice = false;
+        bool touchActive = false;
+        std::bitset<MAX_KEYS> keysPressed;
+        std::array<Gamepad, MAX_GAMEPADS> gamepads;
+    };
+
+    const State& front() const { return states[frontIndex]; }
+
+    static bool mouseBit(const std::bitset<MAX_MOUSE_BUTTONS>& bits, int button) {
+        return button >= 0 && button < MAX_MOUSE_BUTTONS && bits[button];
+    }
+
+    std::shared_ptr<OSContext> source;
+    std::array<State, 2> states;
+    int frontIndex = 0;
+    std::string clipboard;
+};
@@ -0,0 +1,119 @@
+#include "Async.h"
+
+#include <algorithm>
+#include <exception>
+#include "hmui/HMUI.h"
+#include "TaskQueue.h"
+#include "ThreadPool.h"
+
+Async::promise_type::promise_type() : state(std::make_shared<AsyncState>()) {
+    state->owner = HMUI::current();
+    if (state->owner) state->inbox = state->owner->tasks;
+}
+
+void Async::promise_type::unhandled_exception() {
+    state->finished.store(true, std::memory_order_release);
+
+    // Surfaces from the owner's update(), whichever thread the coroutine was on
+    if (auto queue = state->inbox.lock()) {
+        queue->post([error = std::current_exception()]() { std::rethrow_exception(error); });
+        return;
+    }
+    throw;
+}
+
+ThreadPool& Async::backgroundPool() {
+    static ThreadPool pool(2);
+    return pool;
+}
+
+void AsyncResume::operator()() {
+    std::coroutine_handle<> resuming = std::exchange(handle, nullptr);
+    if (isCancelled()) {
+        resuming.destroy();
+        return;
+    }
+
+    HMUI::Scope scope(state->owner);
+    resuming.resume();
+}
+
+void AsyncNextFrame::await_suspend(std::coroutine_handle<Async::promise_type> handle) {
+    std::shared_ptr<AsyncState> state = handle.promise().state;
+    AsyncResume resume(handle, state);
+    // Dropping it destroys the coroutine, awaiter included, so nothing may be touched after
+    if (resume.isCancelled()) return;
+
+    // A coroutine started outside of any HMUI belongs to the first one it waits for
+    if (!state->owner) {
+        state->owner = &hmui;
+        state->inbox = hmui.tasks;
+    }
+
+    if (hmui.isDrivingThread()) {
+        hmui.park(std::move(resume), nullptr);
+        return;
+    }
+
+    // Another thread cannot know whether the owner is still alive, only the inbox can tell
+    if (auto queue = state->inbox.lock()) {
+        queue->post(std::move(resume));
+    }
+}
+
+void AsyncBackground::await_suspend(std::coroutine_handle<Async::promise_type> handle) {
+    AsyncResume resume(handle, handle.promise().state);
+    if (resume.isCancelled()) return;
+
+    Async::backgroundPool().post(std::move(resume));
+}
+
+bool AsyncImage::await_ready() {
+    provider->prefetch();
+    return provider->isReady();
+}
+
+void AsyncImage::await_suspend(std::coroutine_handle<Async::promise_type> handle) {
+    std::shared_ptr<AsyncState> state = handle.promise().state;
+    AsyncResume resume(handle, state);
+    if (resume.isCancelled()) return;
+
+    if (!state->owner) {
+        state->owner = &hmui;
+        state->inbox = hmui.tasks;
+    }
+
+    if (hmui.isDrivingThread()) {
+        hmui.park(std::move(resume), provider);
+        return;
+    }
+
+    // Parked by the UI thread once it gets to the task, the owner is alive while it drains
+    if (auto queue = state->inbox.lock()) {
+        queue->post([owner = state->owner, resume = std::move(resume), image = provider]() mutable {
+            owner->park(std::move(resume), std::move(image));
+        });
+    }
+}
+
+ImageHandle* AsyncImage::await_resume() {
+    return provider->load();
+}
+
+void AsyncTasks::add(Async task) {
+    std::erase_if(tasks, [](const Async& running) { return running.isFinished() || running.isCancelled(); });
+    tasks.push_back(std::move(task));
+}
+
+void AsyncTasks::cancel() {
+    for (Async& task : tasks) {
+        task.cancel();
+    }
+    tasks.clear();
+}
+
+size_t AsyncTasks::getRunning() const {
+    return std::count_if(tasks.begin(), tasks.end(), [](const Async& running) {
+        return !running.isFinished() && !running.isCancelled();
+    });
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class HMUI;
+class ImageProvider;
+class TaskQueue;
+class ThreadPool;
+struct ImageHandle;
+
+// Shared by a coroutine, its Async handles and whatever queue it is suspended in
+struct AsyncState {
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    HMUI* owner = nullptr;            // Made current while the coroutine runs
+    std::weak_ptr<TaskQueue> inbox;   // The owner's posted tasks, gone with the owner
+};
+
+// A coroutine that loads or computes without blocking the frame: it runs on the UI thread
+// until it suspends at co_await HMUI::nextFrame(), backgroundThread() or loadImage():
+//
+//   Async SaveList::load() {
+//       co_await hmui()->backgroundThread();
+//       auto saves = readSaveHeaders();        // Blocking IO, off the UI thread
+//       co_await hmui()->nextFrame();          // Back on the UI thread
+//       setSaves(std::move(saves));
+//   }
+//
+// Starts right away, on the calling thread, with the current HMUI as its owner. Dropping
+// the Async leaves the coroutine running; cancel() makes it stop at its next co_await,
+// where the coroutine frame is destroyed instead of resumed. What it throws is rethrown
+// from the owner's next update().
+class Async {
+public:
+    struct promise_type {
+        promise_type();
+
+        Async get_return_object() {
+            return Async(state);
+        }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() {
+            state->finished.store(true, std::memory_order_release);
+        }
+
+        void unhandled_exception();
+
+        std::shared_ptr<AsyncState> state;
+    };
+
+    Async() = default;
+
+    void cancel() {
+        if (state) state->cancelled.store(true, std::memory_order_release);
+    }
+
+    // Ran to its end (or threw)
+    bool isFinished() const {
+        return state && state->finished.load(std::memory_order_acquire);
+    }
+
+    bool isCancelled() const {
+        return state && state->cancelled.load(std::memory_order_acquire);
+    }
+
+    // Where backgroundThread() resumes coroutines; two threads, meant for blocking IO
+    static ThreadPool& backgroundPool();
+
+private:
+    explicit Async(std::shared_ptr<AsyncState> state) : state(std::move(state)) {}
+
+    std::shared_ptr<AsyncState> state;
+};
+
+// A suspended coroutine as queues hold it. Resuming a cancelled one destroys it instead,
+// and so does dropping one that never ran (a queue torn down with its HMUI).
+class AsyncResume {
+public:
+    AsyncResume(std::coroutine_handle<> handle, std::shared_ptr<AsyncState> state)
+        : handle(handle), state(std::move(state)) {}
+
+    AsyncResume(AsyncResume&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr)), state(std::move(other.state)) {}
+
+    AsyncResume& operator=(AsyncResume&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    AsyncResume(const AsyncResume&) = delete;
+    AsyncResume& operator=(const AsyncResume&) = delete;
+
+    ~AsyncResume() {
+        if (handle) handle.destroy();
+    }
+
+    bool isCancelled() const {
+        return state->cancelled.load(std::memory_order_acquire);
+    }
+
+    void operator()();
+
+private:
+    std::coroutine_handle<> handle;
+    std::shared_ptr<AsyncState> state;
+};
+
+// Awaitables returned by HMUI, only usable from an Async coroutine
+
+struct AsyncNextFrame {
+    HMUI& hmui;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<Async::promise_type> handle);
+    void await_resume() const noexcept {}
+};
+
+struct AsyncBackground {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<Async::promise_type> handle);
+    void await_resume() const noexcept {}
+};
+
+struct AsyncImage {
+    HMUI& hmui;
+    std::shared_ptr<ImageProvider> provider;
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<Async::promise_type> handle);
+    ImageHandle* await_resume();
+};
+
+// The tasks of one owner, typically a widget: add() them as they are started, cancel() in
+// dispose(). The destructor cancels whatever is still running.
+class AsyncTasks {
+public:
+    AsyncTasks() = default;
+    ~AsyncTasks() { cancel(); }
+
+    AsyncTasks(const AsyncTasks&) = delete;
+    AsyncTasks& operator=(const AsyncTasks&) = delete;
+
+    void add(Async task);
+    void cancel();
+
+    // Tasks that have neither finished nor been cancelled
+    size_t getRunning() const;
+
+private:
+    std::vector<Async> tasks;
+};
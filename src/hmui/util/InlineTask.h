@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A move-only void() callable that stores closures of up to INLINE_SIZE bytes in place, so
+// queueing a lambda capturing a few pointers or values never touches the heap. Larger
+// closures, and ones that may throw while being moved, are boxed on the heap instead.
+class InlineTask {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    InlineTask() = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineTask>>>
+    InlineTask(F&& function) {
+        using T = std::decay_t<F>;
+        if constexpr (fitsInline<T>()) {
+            new (storage) T(std::forward<F>(function));
+            ops = &inlineOps<T>;
+        } else {
+            *reinterpret_cast<T**>(storage) = new T(std::forward<F>(function));
+            ops = &boxedOps<T>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept {
+        take(other);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() {
+        reset();
+    }
+
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const {
+        return ops != nullptr;
+    }
+
+    // False when the closure did not fit and was boxed
+    bool isInline() const {
+        return ops == nullptr || !ops->boxed;
+    }
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+        bool boxed;
+    };
+
+    template<typename T>
+    static constexpr bool fitsInline() {
+        return sizeof(T) <= INLINE_SIZE && alignof(T) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<T>;
+    }
+
+    template<typename T>
+    static constexpr Ops inlineOps = {
+        [](void* storage) { (*std::launder(reinterpret_cast<T*>(storage)))(); },
+        [](void* from, void* to) noexcept {
+            T* source = std::launder(reinterpret_cast<T*>(from));
+            new (to) T(std::move(*source));
+            source->~T();
+        },
+        [](void* storage) noexcept { std::launder(reinterpret_cast<T*>(storage))->~T(); },
+        false
+    };
+
+    template<typename T>
+    static constexpr Ops boxedOps = {
+        [](void* storage) { (**reinterpret_cast<T**>(storage))(); },
+        [](void* from, void* to) noexcept { *reinterpret_cast<T**>(to) = *reinterpret_cast<T**>(from); },
+        [](void* storage) noexcept { delete *reinterpret_cast<T**>(storage); },
+        true
+    };
+
+    void take(InlineTask& other) noexcept {
+        if (other.ops) {
+            other.ops->move(other.storage, storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
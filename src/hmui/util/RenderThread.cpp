@@ -0,0 +1,124 @@
+#include "RenderThread.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+    struct Call {
+        std::function<void()> function;
+        const std::function<void()>* borrowed = nullptr; // call() waits, no need to copy
+        std::exception_ptr error;
+        bool done = false;
+        bool waited = false;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Call*> queue;
+    std::thread::id owner;
+    bool bound = false;
+
+    // With the lock held; returns with it held
+    void runQueued(std::unique_lock<std::mutex>& lock) {
+        while (!queue.empty()) {
+            Call* call = queue.front();
+            queue.pop_front();
+            lock.unlock();
+
+            try {
+                if (call->borrowed) (*call->borrowed)();
+                else call->function();
+            } catch (...) {
+                call->error = std::current_exception();
+            }
+
+            lock.lock();
+            if (call->waited) {
+                call->done = true;
+                wake.notify_all();
+            } else {
+                delete call;
+            }
+        }
+    }
+}
+
+void RenderThread::bind() {
+    std::lock_guard<std::mutex> lock(mutex);
+    owner = std::this_thread::get_id();
+    bound = true;
+}
+
+void RenderThread::unbind() {
+    std::unique_lock<std::mutex> lock(mutex);
+    runQueued(lock);
+    bound = false;
+}
+
+bool RenderThread::isCurrent() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !bound || owner == std::this_thread::get_id();
+}
+
+void RenderThread::call(const std::function<void()>& fn) {
+    if (isCurrent()) {
+        fn();
+        return;
+    }
+
+    Call call;
+    call.borrowed = &fn;
+    call.waited = true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queue.push_back(&call);
+    wake.notify_all();
+    wake.wait(lock, [&call]() { return call.done; });
+
+    if (call.error) std::rethrow_exception(call.error);
+}
+
+void RenderThread::post(std::function<void()> fn) {
+    if (isCurrent()) {
+        fn();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(new Call{std::move(fn)});
+    wake.notify_all();
+}
+
+void RenderThread::retire(std::function<void()> fn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!bound) {
+        lock.unlock();
+        fn();
+        return;
+    }
+
+    queue.push_back(new Call{std::move(fn)});
+    wake.notify_all();
+}
+
+void RenderThread::service() {
+    std::unique_lock<std::mutex> lock(mutex);
+    runQueued(lock);
+}
+
+void RenderThread::serviceUntil(const std::function<bool()>& done) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        runQueued(lock);
+        if (done()) return;
+        wake.wait(lock);
+    }
+}
+
+void RenderThread::notify() {
+    std::lock_guard<std::mutex> lock(mutex);
+    wake.notify_all();
+}
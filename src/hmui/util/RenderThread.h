@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+
+// The thread that owns the window and the GPU context. Code that talks to the graphics API
+// (texture uploads, window and cursor calls) goes through call() or post(), so it stays
+// correct when the UI runs on another thread (FramePipeline). Until a thread is bound,
+// everything runs inline on the caller.
+class RenderThread {
+public:
+    // Makes the calling thread the render thread
+    static void bind();
+    static void unbind();
+    static bool isCurrent();
+
+    // Runs fn on the render thread and waits for it to finish, rethrowing what it threw.
+    // Inline when called from the render thread or while none is bound.
+    static void call(const std::function<void()>& fn);
+
+    // Queues fn for the render thread's next service() without waiting; what it throws is
+    // dropped. Inline while none is bound or when already on the render thread.
+    static void post(std::function<void()> fn);
+
+    // Frees what a display list may still point at (texture handles, textures). Always
+    // queued while a thread is bound, even from the render thread itself, and run by its
+    // next service(): FramePipeline only services once the frame being submitted has been
+    // drawn. Inline while none is bound, where nothing is drawn behind the UI's back.
+    static void retire(std::function<void()> fn);
+
+    // Render thread: runs everything queued so far
+    static void service();
+
+    // Render thread: runs queued calls as they arrive until done() holds. Whoever makes it
+    // hold must call notify() afterwards.
+    static void serviceUntil(const std::function<bool()>& done);
+
+    static void notify();
+};
@@ -0,0 +1,91 @@
+#include "SlicedTask.h"
+
+SlicedTask::SlicedTask(std::function<void()> function) : function(std::move(function)) {}
+
+SlicedTask::~SlicedTask() {
+    cancel();
+}
+
+bool SlicedTask::resume(std::chrono::steady_clock::duration budget) {
+    return run(std::chrono::steady_clock::now() + budget);
+}
+
+void SlicedTask::finish() {
+    run(std::chrono::steady_clock::time_point::max());
+}
+
+bool SlicedTask::run(std::chrono::steady_clock::time_point until) {
+    if (finished) return true;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        deadline = until;
+        taskTurn = true;
+
+        if (!started) {
+            started = true;
+            thread = std::thread([this]() {
+                running = this;
+                try {
+                    function();
+                } catch (const Cancelled&) {
+                } catch (...) {
+                    if (!cancelling) error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> done(mutex);
+                finished = true;
+                taskTurn = false;
+                wake.notify_all();
+            });
+        } else {
+            wake.notify_all();
+        }
+
+        wake.wait(lock, [this]() { return !taskTurn; });
+    }
+
+    if (!finished) return false;
+
+    thread.join();
+    if (error) {
+        std::exception_ptr rethrow = std::move(error);
+        error = nullptr;
+        std::rethrow_exception(rethrow);
+    }
+    return true;
+}
+
+void SlicedTask::cancel() {
+    if (!started || finished) {
+        if (thread.joinable()) thread.join();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cancelling = true;
+        taskTurn = true;
+        wake.notify_all();
+        wake.wait(lock, [this]() { return !taskTurn; });
+    }
+    thread.join();
+}
+
+void SlicedTask::checkpoint() {
+    SlicedTask* task = running;
+    if (!task) return;
+
+    // Both only change while the helper waits, which this thread is not doing
+    if (task->cancelling) throw Cancelled{};
+    if (std::chrono::steady_clock::now() >= task->deadline) task->yield();
+}
+
+void SlicedTask::yield() {
+    std::unique_lock<std::mutex> lock(mutex);
+    taskTurn = false;
+    wake.notify_all();
+    wake.wait(lock, [this]() { return taskTurn; });
+
+    if (cancelling) throw Cancelled{};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs a function a slice at a time on behalf of the calling thread, for work that is plain
+// recursion and cannot be cut up by hand, like building and initializing a widget tree.
+//
+// The function runs on a helper thread, but only while the caller is blocked in resume():
+// the two never run at the same time, and each sees everything the other did before handing
+// over, as if it all ran on the caller. Past the slice's budget, the function hands control
+// back at its next checkpoint(). Widget construction, Drawable::init() and Drawable::layout()
+// have checkpoints, so a route is split between composed widgets; the init or layout of a
+// single leaf widget is never split.
+//
+// The helper starts with no thread-local state of its own: the function opens whatever
+// scopes it needs (HMUI::Scope, WidgetArena::Scope...). It must not call the graphics API
+// directly, RenderThread::call() is the way there.
+class SlicedTask {
+public:
+    explicit SlicedTask(std::function<void()> function);
+
+    // Cancels the function if it has not finished
+    ~SlicedTask();
+
+    SlicedTask(const SlicedTask&) = delete;
+    SlicedTask& operator=(const SlicedTask&) = delete;
+
+    // Runs the function until it finishes or a checkpoint past budget. Returns true once it
+    // has finished, rethrowing what it threw.
+    bool resume(std::chrono::steady_clock::duration budget);
+
+    // Runs the rest of the function without slicing
+    void finish();
+
+    bool isFinished() const { return finished; }
+
+    // Unwinds the function from the checkpoint it is waiting at (checkpoint() throws
+    // Cancelled there) and waits for it. What it throws while unwinding is dropped.
+    void cancel();
+
+    // Called from code that may run inside a task: gives the rest of the slice back if the
+    // budget is used up. Does nothing outside of a task.
+    static void checkpoint();
+
+    struct Cancelled {};
+
+private:
+    bool run(std::chrono::steady_clock::time_point until);
+    void yield();
+
+    std::function<void()> function;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool taskTurn = false;      // The helper runs, the caller waits
+    bool started = false;
+    bool finished = false;
+    bool cancelling = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::exception_ptr error;
+    std::thread thread;
+
+    static inline thread_local SlicedTask* running = nullptr;
+};
@@ -0,0 +1,111 @@
+#include "TaskQueue.h"
+
+#include <cstdint>
+
+TaskQueue::TaskQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+
+    // A slot is free for position p when its sequence is p, holds a task when it is p + 1
+    for (size_t i = 0; i < size; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+TaskQueue::~TaskQueue() = default;
+
+void TaskQueue::post(InlineTask task) {
+    if (spilled.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        if (spilled.load(std::memory_order_relaxed)) {
+            overflow.push_back(std::move(task));
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    if (tryPush(task)) return;
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    spilled.store(true, std::memory_order_release);
+    overflow.push_back(std::move(task));
+    overflowCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool TaskQueue::tryPush(InlineTask& task) {
+    size_t position = tail.load(std::memory_order_relaxed);
+
+    while (true) {
+        Slot& slot = slots[position & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        auto distance = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (distance == 0) {
+            // Claimed once the CAS succeeds, nobody else writes this slot until it is read
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.task = std::move(task);
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (distance < 0) {
+            return false; // Full: the consumer has not read this slot's previous task yet
+        } else {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TaskQueue::pop(InlineTask& out) {
+    // Taken from the overflow list earlier, so posted before anything now in the ring
+    if (!draining.empty()) {
+        out = std::move(draining.front());
+        draining.pop_front();
+        return true;
+    }
+
+    Slot& slot = slots[head & mask];
+    if (slot.sequence.load(std::memory_order_acquire) == head + 1) {
+        out = std::move(slot.task);
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    if (!spilled.load(std::memory_order_acquire)) return false;
+
+    // A claimed slot that is still being written may hold a task posted before one in the
+    // overflow list by the same thread; wait for it (next drain) rather than reorder them
+    if (tail.load(std::memory_order_acquire) != head) return false;
+
+    // Take the whole list in one go: producers are back on the ring as soon as it is empty,
+    // instead of spilling until the consumer has popped the list a task at a time
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        draining.swap(overflow);
+        spilled.store(false, std::memory_order_release);
+    }
+
+    if (draining.empty()) return false;
+    out = std::move(draining.front());
+    draining.pop_front();
+    return true;
+}
+
+size_t TaskQueue::drain(std::chrono::steady_clock::duration budget) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point deadline = Clock::now() + budget;
+
+    size_t ran = 0;
+    InlineTask task;
+    while (pop(task)) {
+        ran++;
+        task();
+        task.reset();
+
+        if (Clock::now() >= deadline) break;
+    }
+    return ran;
+}
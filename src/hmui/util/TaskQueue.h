@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "InlineTask.h"
+
+// Multi-producer, single-consumer queue of tasks for the UI thread. Producers claim a slot
+// of a fixed ring with one compare-and-swap and build the task in it, so posting never locks
+// and, for closures that fit an InlineTask, never allocates.
+// A producer that finds the ring full spills into a locked overflow list instead of
+// blocking or dropping the task; once anything has spilled, every post goes there until the
+// consumer has emptied the ring and taken the list over, all of it under one lock. Tasks
+// from the same thread therefore always run in the order they were posted. Tasks from
+// different threads have no order between them.
+class TaskQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit TaskQueue(size_t capacity = 1024);
+    ~TaskQueue();
+
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    // Any thread
+    void post(InlineTask task);
+
+    // Consumer thread: runs tasks until the queue is empty or budget has passed, at least
+    // one if there is any. Returns how many ran. A task that throws is consumed and the
+    // exception propagates, the tasks behind it stay queued.
+    size_t drain(std::chrono::steady_clock::duration budget);
+
+    // Posts that went to the overflow list since the queue was created
+    size_t getOverflowCount() const {
+        return overflowCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence{0};
+        InlineTask task;
+    };
+
+    bool tryPush(InlineTask& task);
+    bool pop(InlineTask& out);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot producers claim
+    alignas(64) size_t head = 0;             // Next slot the consumer reads
+
+    std::mutex overflowMutex;
+    std::deque<InlineTask> overflow;
+    std::deque<InlineTask> draining;         // Consumer only: the overflow list it took over
+    std::atomic<bool> spilled{false};
+    std::atomic<size_t> overflowCount{0};
+};
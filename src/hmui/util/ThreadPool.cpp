@@ -0,0 +1,149 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local size_t ThreadPool::currentIndex = 0;
+
+ThreadPool::ThreadPool(size_t count) {
+    if (count == 0) {
+        size_t hardware = std::thread::hardware_concurrency();
+        count = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    for (size_t i = 0; i <= count; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::localQueue() const {
+    return currentPool == this ? currentIndex : threads.size();
+}
+
+void ThreadPool::push(Task task) {
+    Queue& queue = *queues[localQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    {
+        // Taken so a worker between its check and its wait cannot miss the wakeup
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::pop(size_t index, Task& out) {
+    Queue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+
+    out = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(size_t thief, Task& out) {
+    size_t count = queues.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Queue& queue = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        // Oldest first: usually the biggest piece of work left in that queue
+        out = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::tryRunOne() {
+    size_t index = localQueue();
+
+    Task task;
+    if (!pop(index, task) && !steal(index, task)) return false;
+
+    execute(task);
+    return true;
+}
+
+void ThreadPool::execute(Task& task) {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+
+    try {
+        task.function();
+    } catch (...) {
+        if (task.group) {
+            std::lock_guard<std::mutex> lock(task.group->errorMutex);
+            if (!task.group->error) task.group->error = std::current_exception();
+        }
+    }
+    task.function.reset();
+
+    if (!task.group) return;
+
+    // Last access to the group: its waiter may return and destroy it right after this
+    task.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (tryRunOne()) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
+
+void ThreadPool::post(InlineTask task) {
+    push(Task{std::move(task), nullptr});
+}
+
+void ThreadPool::TaskGroup::run(std::function<void()> task) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.push(Task{std::move(task), this});
+}
+
+void ThreadPool::TaskGroup::wait() {
+    while (pending.load(std::memory_order_acquire) > 0) {
+        // Help instead of blocking; yield while the last tasks run elsewhere
+        if (!pool.tryRunOne()) std::this_thread::yield();
+    }
+
+    if (error) {
+        std::exception_ptr rethrow = std::move(error);
+        error = nullptr;
+        std::rethrow_exception(rethrow);
+    }
+}
+
+ThreadPool::TaskGroup::~TaskGroup() {
+    // Tasks point at us, never leave before they are done
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!pool.tryRunOne()) std::this_thread::yield();
+    }
+}
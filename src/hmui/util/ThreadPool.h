@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "InlineTask.h"
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own tasks at
+// the back (newest first, cache-warm) and steals from the front of the others when it runs
+// dry. Threads outside the pool share one extra deque.
+// Waiting on a TaskGroup never blocks while there is work: the waiting thread runs queued
+// tasks itself, so a task may fork and wait on its own group without starving the pool.
+class ThreadPool {
+public:
+    // 0 threads: one per hardware thread, minus the caller's
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadCount() const { return threads.size(); }
+
+    // True on the threads of any pool
+    static bool isWorkerThread() { return currentPool != nullptr; }
+
+    // Runs task on some worker without anyone waiting for it; what it throws is dropped.
+    // Tasks still queued when the pool is destroyed are destroyed without running.
+    void post(InlineTask task);
+
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        void run(std::function<void()> task);
+
+        // Returns once every task has finished, rethrowing the first exception one threw
+        void wait();
+
+    private:
+        friend class ThreadPool;
+
+        ThreadPool& pool;
+        std::atomic<size_t> pending{0};
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+private:
+    struct Task {
+        InlineTask function;
+        TaskGroup* group = nullptr; // Null for post()
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task);
+    bool tryRunOne();
+    bool pop(size_t index, Task& out);
+    bool steal(size_t thief, Task& out);
+    void execute(Task& task);
+    void workerLoop(size_t index);
+
+    // Index of the calling thread's own queue: a worker's, or the shared external one
+    size_t localQueue() const;
+
+    std::vector<std::unique_ptr<Queue>> queues; // threads.size() workers + 1 external
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued{0};
+    bool stopping = false;
+
+    static thread_local ThreadPool* currentPool;
+    static thread_local size_t currentIndex;
+};
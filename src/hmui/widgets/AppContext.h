@@ -4,11 +4,15 @@
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
+#include <list>
+#include <chrono>
 #include <functional>
 #include <optional>
 #include <string>
 #include "InternalDrawable.h"
 #include "hmui/input/FocusManager.h"
+#include "hmui/util/SlicedTask.h"
 
 // Factory for creating routes
 using RouteBuilder = std::function<std::shared_ptr<InternalDrawable>()>;
@@ -16,6 +20,16 @@ using RouteBuilder = std::function<std::shared_ptr<InternalDrawable>()>;
 struct AppContextProperties {
     std::unordered_map<std::string, RouteBuilder> routes;
     std::string initialRoute;
+
+    // Routes listed here are parked instead of disposed when popped or replaced, with their
+    // widget state, textures and focus scope intact, and pushing them again restores the
+    // parked instance instead of rebuilding it. At most keepAliveLimit views are parked,
+    // the least recently parked one is disposed first.
+    std::unordered_set<std::string> keepAlive;
+    size_t keepAliveLimit = 4;
+
+    // Time per frame spent uploading the textures of prewarmed routes
+    float prewarmBudgetMs = 2.0f;
 };
 
 class D_AppContext : public InternalDrawable {
@@ -23,19 +37,37 @@ public:
     explicit D_AppContext(AppContextProperties props)
         : properties(std::move(props)) {}
 
-    // --- Singleton / Factory Management ---
+    // --- Factory Management ---
+    // One AppContext per HMUI, created while that HMUI is current (from a build())
 
     static std::shared_ptr<D_AppContext> create(AppContextProperties props) {
-        if (instance) throw std::runtime_error("AppContext already exists");
+        HMUI* owner = HMUI::current();
+        if (owner == nullptr) throw std::runtime_error("AppContext created outside of an HMUI");
+        if (owner->getAppContext()) throw std::runtime_error("AppContext already exists");
         auto ptr = std::make_shared<D_AppContext>(std::move(props));
-        instance = ptr;
+        owner->setAppContext(ptr);
         return ptr;
     }
 
-    static std::shared_ptr<D_AppContext> get() { return instance; }
+    static std::shared_ptr<D_AppContext> get() {
+        HMUI* owner = HMUI::current();
+        return owner ? owner->getAppContext() : nullptr;
+    }
 
     // --- Layout Protocol ---
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Fill;
+    }
+
+    InternalDrawable* getActiveView() const {
+        return stack.empty() ? nullptr : stack.back().view.get();
+    }
+
+    size_t getSubtreeSize() const override {
+        return 1 + (stack.empty() ? 0 : stack.back().view->getSubtreeSize());
+    }
+
     void layout(BoxConstraints constraints) override {
         // AppContext fills the Window (or parent) completely
         bounds.width = constraints.maxWidth;
@@ -43,7 +75,7 @@ public:
 
         // Force the active view to also fill the AppContext
         if (!stack.empty()) {
-            auto& activeView = stack.back();
+            auto& activeView = stack.back().view;
             
             // Pass tight constraints: Child MUST be exactly this size
             activeView->layout(BoxConstraints::tight(bounds.width, bounds.height));
@@ -64,42 +96,81 @@ public:
     }
 
     void push(std::shared_ptr<InternalDrawable> view) {
-        if (!view) return;
-
-        FocusManager::get()->pushScope();
-        FocusManager::get()->blur();
-        view->init();
-        view->setParent(shared_from_this());
-        stack.push_back(view);
+        push(std::move(view), "");
     }
 
     // Overload to push by route name
     void pushNamed(const std::string& routeName) {
+        if (restore(routeName)) return;
+
         auto builder = getRouteBuilder(routeName);
         if (builder.has_value()) {
-            push(builder.value()());
+            // Every route gets its own arena, released with the last of its widgets
+            WidgetArena::Scope arena(WidgetArena::create());
+            push(builder.value()(), routeName);
         }
     }
 
     void pop() {
         if (stack.size() <= 1) return; // Don't pop the last view
-
-        auto oldView = stack.back();
-        oldView->dispose();
-        stack.pop_back();
-        FocusManager::get()->popScope();
+        retireTop();
     }
 
     void replace(std::shared_ptr<InternalDrawable> view) {
         if (!stack.empty()) {
-            auto oldView = stack.back();
-            oldView->dispose();
-            stack.pop_back();
-            FocusManager::get()->popScope();
+            retireTop();
         }
         push(view);
     }
 
+    void replaceNamed(const std::string& routeName) {
+        if (!stack.empty()) {
+            retireTop();
+        }
+        pushNamed(routeName);
+    }
+
+    bool isParked(const std::string& routeName) const {
+        return parked.find(routeName) != parked.end() || prewarmed.find(routeName) != prewarmed.end();
+    }
+
+    // Builds, inits and lays out a route ahead of time, under its own focus scope, and starts
+    // decoding its images on worker threads. All of it is time-sliced across the following
+    // updates (prewarmBudgetMs per frame): the build a slice at a time (SlicedTask), then the
+    // texture uploads. A later pushNamed() just swaps the prepared view in; one that comes
+    // before the prewarm is done finishes the build right away.
+    void prewarm(const std::string& routeName) {
+        if (isParked(routeName)) return;
+
+        auto builder = getRouteBuilder(routeName);
+        if (!builder.has_value()) return;
+
+        PrewarmedView& entry = prewarmed[routeName];
+        entry.building = std::make_unique<SlicedTask>([this, &entry, owner = HMUI::current(), build = *builder]() {
+            HMUI::Scope scope(owner);
+            WidgetArena::Scope arena(WidgetArena::create());
+            ImagePrefetchScope prefetch;
+
+            auto view = build();
+            view->init();
+            view->setParent(this);
+            entry.pendingImages = std::move(prefetch.images);
+
+            // Warm text and layout caches too, at the size it will be shown at
+            if (bounds.width > 0.0f && bounds.height > 0.0f) {
+                view->layout(BoxConstraints::tight(bounds.width, bounds.height));
+                view->setBounds(Rect(0, 0, bounds.width, bounds.height));
+            }
+
+            entry.view = std::move(view);
+        });
+    }
+
+    bool isPrewarmed(const std::string& routeName) const {
+        auto it = prewarmed.find(routeName);
+        return it != prewarmed.end() && !it->second.building && it->second.pendingImages.empty();
+    }
+
     // --- Lifecycle ---
 
     void init() override {
@@ -113,31 +184,51 @@ public:
         }
 
         // Initialize the first view
+        WidgetArena::Scope arena(WidgetArena::create());
         auto initialView = routeBuilderOpt.value()();
-        push(initialView);
+        push(initialView, properties.initialRoute);
     }
 
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         // Only draw the top-most view
         if (!stack.empty()) {
             // x, y are the absolute coordinates of AppContext (usually 0,0)
-            stack.back()->onDraw(ctx, x, y);
+            stack.back().view->onDraw(ctx, x, y);
         }
     }
 
     void onUpdate(float delta) override {
+        // Views popped since the last update are no longer running any code, free them now
+        retired.clear();
+
         // Only update the top-most view
         if (!stack.empty()) {
-            stack.back()->onUpdate(delta);
+            stack.back().view->onUpdate(delta);
         }
+
+        pumpPrewarm();
     }
 
     void dispose() override {
         // Clean up entire stack
         while (!stack.empty()) {
-            stack.back()->dispose();
+            stack.back().view->dispose();
             stack.pop_back();
         }
+        notifyStructureChanged();
+
+        for (auto& [route, entry] : parked) {
+            entry.view->dispose();
+        }
+        parked.clear();
+        parkOrder.clear();
+
+        for (auto& [route, entry] : prewarmed) {
+            // Half built: unwound where it stopped, nothing was loaded yet
+            if (entry.building) entry.building->cancel();
+            else entry.view->dispose();
+        }
+        prewarmed.clear();
     }
 
     // --- Bounds/Parent Boilerplate ---
@@ -149,19 +240,180 @@ public:
         // If we are resized, we update the child immediately if it exists,
         // though usually layout() handles this logic.
         if (!stack.empty()) {
-            stack.back()->setBounds(Rect(0, 0, rect.width, rect.height));
+            stack.back().view->setBounds(Rect(0, 0, rect.width, rect.height));
         }
     }
 
-    void setParent(const std::shared_ptr<InternalDrawable>& parent) override { 
+    void setParent(InternalDrawable* parent) override {
         // AppContext is usually the root, but if embedded, this is fine.
     }
 
 protected:
-    inline static std::shared_ptr<D_AppContext> instance = nullptr;
-    std::vector<std::shared_ptr<InternalDrawable>> stack;
+    struct StackEntry {
+        std::shared_ptr<InternalDrawable> view;
+        std::string route; // Empty for views pushed directly
+    };
+
+    struct ParkedView {
+        std::shared_ptr<InternalDrawable> view;
+        FocusScope focus;
+        std::list<std::string>::iterator order;
+    };
+
+    struct PrewarmedView {
+        std::shared_ptr<InternalDrawable> view;     // Null until built
+        std::unique_ptr<SlicedTask> building;       // Builds, inits and lays out the view
+        FocusScope focus;
+        std::vector<PrefetchedImage> pendingImages; // Decoding, not uploaded yet
+    };
+
+    void push(std::shared_ptr<InternalDrawable> view, const std::string& route) {
+        if (!view) return;
+
+        // Views built by Drawable::init() go to the route's arena, or a new one for direct pushes
+        WidgetArena::Scope arena;
+
+        FocusManager::get()->pushScope();
+        FocusManager::get()->blur();
+        view->init();
+        view->setParent(this);
+        stack.push_back({view, route});
+        notifyStructureChanged();
+    }
+
+    // Takes the top view off the stack: parked if its route is keep-alive, disposed otherwise
+    void retireTop() {
+        StackEntry top = std::move(stack.back());
+        stack.pop_back();
+        notifyStructureChanged();
+
+        if (top.route.empty() || !properties.keepAlive.count(top.route) || properties.keepAliveLimit == 0) {
+            top.view->dispose();
+            FocusManager::get()->popScope();
+
+            // Nothing else owns the tree any more, but a pop usually comes from one of its own
+            // callbacks which is still running: keep it alive until the next update.
+            retired.push_back(std::move(top.view));
+            return;
+        }
+
+        // A second instance of the same route replaces the older parked one
+        discardParked(top.route);
+
+        parkOrder.push_back(top.route);
+        parked[top.route] = ParkedView{std::move(top.view), FocusManager::get()->detachScope(),
+                                       std::prev(parkOrder.end())};
+
+        while (parked.size() > properties.keepAliveLimit) {
+            discardParked(parkOrder.front());
+        }
+    }
+
+    // Puts a parked or prewarmed view on top, O(1): no build, no init, focus resumes where it was
+    bool restore(const std::string& route) {
+        auto warm = prewarmed.find(route);
+        if (warm != prewarmed.end()) {
+            if (warm->second.building) buildSlice(warm, true);
+
+            // Images still decoding finish on their own, load() picks up the result
+            PrewarmedView entry = std::move(warm->second);
+            prewarmed.erase(warm);
+
+            FocusManager::get()->attachScope(std::move(entry.focus));
+            stack.push_back({std::move(entry.view), route});
+            notifyStructureChanged();
+            return true;
+        }
+
+        auto it = parked.find(route);
+        if (it == parked.end()) return false;
+
+        ParkedView entry = std::move(it->second);
+        parkOrder.erase(entry.order);
+        parked.erase(it);
+
+        FocusManager::get()->attachScope(std::move(entry.focus));
+        stack.push_back({std::move(entry.view), route});
+        notifyStructureChanged();
+        return true;
+    }
+
+    // Builds prewarmed routes, then uploads their decoded images, until the frame budget is
+    // used up. Images whose decode has not finished are skipped, the UI thread never waits
+    // on a worker.
+    void pumpPrewarm() {
+        if (prewarmed.empty()) return;
+
+        auto start = std::chrono::steady_clock::now();
+        auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float, std::milli>(properties.prewarmBudgetMs));
+
+        for (auto it = prewarmed.begin(); it != prewarmed.end(); ++it) {
+            if (it->second.building) {
+                auto left = budget - (std::chrono::steady_clock::now() - start);
+                if (left <= left.zero() || !buildSlice(it, false, left)) return;
+            }
+
+            auto& pending = it->second.pendingImages;
+            for (size_t i = 0; i < pending.size();) {
+                if (std::chrono::steady_clock::now() - start >= budget) return;
+
+                if (pending[i].provider->isReady()) {
+                    // The widget owns the texture from here on, so a route that is never
+                    // pushed still releases it when it is disposed
+                    if (ImageHandle* handle = pending[i].provider->load()) {
+                        pending[i].adopt(handle);
+                    }
+                    pending[i] = std::move(pending.back());
+                    pending.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+
+            // Free the list here rather than in the push that restores the route
+            if (pending.empty()) pending.shrink_to_fit();
+        }
+    }
+
+    // Runs a prewarm's build for one slice, or to its end, with the route's focus scope
+    // current. True once it is built; a build that throws is dropped and rethrown.
+    bool buildSlice(std::unordered_map<std::string, PrewarmedView>::iterator it, bool finish,
+                    std::chrono::steady_clock::duration budget = {}) {
+        PrewarmedView& entry = it->second;
+        FocusManager::get()->attachScope(std::move(entry.focus));
+
+        bool built;
+        try {
+            if (finish) entry.building->finish();
+            built = finish || entry.building->resume(budget);
+        } catch (...) {
+            FocusManager::get()->popScope();
+            prewarmed.erase(it);
+            throw;
+        }
+
+        entry.focus = FocusManager::get()->detachScope();
+        if (built) entry.building = nullptr;
+        return built;
+    }
+
+    void discardParked(const std::string& route) {
+        auto it = parked.find(route);
+        if (it == parked.end()) return;
+
+        // Its focus nodes live in the detached scope, they go away with it
+        it->second.view->dispose();
+        parkOrder.erase(it->second.order);
+        parked.erase(it);
+    }
+
+    std::vector<StackEntry> stack;
+    std::unordered_map<std::string, ParkedView> parked;
+    std::list<std::string> parkOrder; // Oldest first
+    std::unordered_map<std::string, PrewarmedView> prewarmed;
+    std::vector<std::shared_ptr<InternalDrawable>> retired; // Disposed, freed on the next update
     AppContextProperties properties;
-    Rect bounds;
 };
 
 #define AppContext(...) D_AppContext::create(AppContextProperties{__VA_ARGS__})
\ No newline at end of file
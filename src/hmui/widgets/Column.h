@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hmui/widgets/InternalDrawable.h"
+#include "hmui/widgets/FrameArena.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -17,22 +18,28 @@ struct ColumnProperties {
 class D_Column : public InternalDrawable {
 public:
     explicit D_Column(
-        const ColumnProperties& properties
-    ) : children(properties.children), 
+        ColumnProperties properties
+    ) : children(std::move(properties.children)), 
         mainAxisAlignment(properties.mainAxisAlignment), 
         crossAxisAlignment(properties.crossAxisAlignment) {};
 
     void init() override {
         for (const auto& child : children) {
             child->init();
-            child->setParent(shared_from_this());
+            child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        size_t size = 1;
+        for (const auto& child : children) size += child->getSubtreeSize();
+        return size;
+    }
+
     void layout(BoxConstraints constraints) override {
         float maxChildWidth = 0.0f;
         float totalChildrenHeight = 0.0f;
-        std::vector<Rect> childSizes;
+        ScratchVector<Rect> childSizes(FrameArena::get());
         childSizes.reserve(children.size());
 
         BoxConstraints childConstraints(0.0f, constraints.maxWidth, 0.0f, INFINITY);
@@ -109,6 +116,14 @@ public:
         }
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Column;
+    }
+
+    const ChildrenList& getChildren() const { return children; }
+    MainAxisAlignment getMainAxisAlignment() const { return mainAxisAlignment; }
+    CrossAxisAlignment getCrossAxisAlignment() const { return crossAxisAlignment; }
+
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         for (const auto& child : children) {
             Rect childLocalParams = child->getBounds();
@@ -140,7 +155,6 @@ protected:
     std::vector<std::shared_ptr<InternalDrawable>> children;
     MainAxisAlignment mainAxisAlignment;
     CrossAxisAlignment crossAxisAlignment;
-    Rect bounds;
 };
 
-#define Column(...) std::make_shared<D_Column>(ColumnProperties{__VA_ARGS__})
\ No newline at end of file
+#define Column(...) WidgetArena::make<D_Column>(ColumnProperties{__VA_ARGS__})
\ No newline at end of file
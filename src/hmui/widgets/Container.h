@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "InternalDrawable.h"
+#include "SharedProperties.h"
 
 struct ContainerProperties {
     float width = 0; // 0 implies "auto" / wrap content
@@ -20,17 +21,26 @@ struct ContainerProperties {
 
 class D_Container : public InternalDrawable {
 public:
-    explicit D_Container(ContainerProperties properties) 
-        : properties(std::move(properties)) {};
+    // The child is taken out of the properties, the rest can then be shared
+    explicit D_Container(ContainerProperties properties)
+        : child(std::move(properties.child)), properties(shareProperties(std::move(properties))) {}
+
+    // Points at properties other containers use too; their child field is ignored
+    D_Container(std::shared_ptr<const ContainerProperties> properties, std::shared_ptr<InternalDrawable> child)
+        : child(std::move(child)), properties(std::move(properties)) {}
 
     // In a real engine, init() might register events, but it shouldn't do layout.
     void init() override {
-        if (properties.child) {
-            properties.child->init();
-            properties.child->setParent(shared_from_this());
+        if (child) {
+            child->init();
+            child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return 1 + (child ? child->getSubtreeSize() : 0);
+    }
+
     // --- The Core Flutter Logic: Layout ---
     // This function must be called by the Parent before onDraw
     void layout(BoxConstraints constraints) override {
@@ -39,23 +49,23 @@ public:
         // and increases the minimum space the container takes in the parent.
         // (Simplified here: we subtract margin from incoming constraints for the inner calculation)
         
-        float deflatedMaxWidth = std::max(0.0f, constraints.maxWidth - properties.margin.left - properties.margin.right);
-        float deflatedMaxHeight = std::max(0.0f, constraints.maxHeight - properties.margin.top - properties.margin.bottom);
-        float deflatedMinWidth = std::max(0.0f, constraints.minWidth - properties.margin.left - properties.margin.right);
-        float deflatedMinHeight = std::max(0.0f, constraints.minHeight - properties.margin.top - properties.margin.bottom);
+        float deflatedMaxWidth = std::max(0.0f, constraints.maxWidth - properties->margin.left - properties->margin.right);
+        float deflatedMaxHeight = std::max(0.0f, constraints.maxHeight - properties->margin.top - properties->margin.bottom);
+        float deflatedMinWidth = std::max(0.0f, constraints.minWidth - properties->margin.left - properties->margin.right);
+        float deflatedMinHeight = std::max(0.0f, constraints.minHeight - properties->margin.top - properties->margin.bottom);
 
         // 2. Determine Constraints for "Self" (The Container Box)
         // If properties.width is set, enforce it (Tight constraint). 
         // Otherwise, respect parent constraints (Loose constraint).
-        float targetMinWidth = (properties.width > 0) ? properties.width : deflatedMinWidth;
-        float targetMaxWidth = (properties.width > 0) ? properties.width : deflatedMaxWidth;
-        float targetMinHeight = (properties.height > 0) ? properties.height : deflatedMinHeight;
-        float targetMaxHeight = (properties.height > 0) ? properties.height : deflatedMaxHeight;
+        float targetMinWidth = (properties->width > 0) ? properties->width : deflatedMinWidth;
+        float targetMaxWidth = (properties->width > 0) ? properties->width : deflatedMaxWidth;
+        float targetMinHeight = (properties->height > 0) ? properties->height : deflatedMinHeight;
+        float targetMaxHeight = (properties->height > 0) ? properties->height : deflatedMaxHeight;
 
         // 3. Determine Constraints for the Child
         // Child space = Container Size - Padding
-        float childAvailableMaxWidth = std::max(0.0f, targetMaxWidth - properties.padding.left - properties.padding.right);
-        float childAvailableMaxHeight = std::max(0.0f, targetMaxHeight - properties.padding.top - properties.padding.bottom);
+        float childAvailableMaxWidth = std::max(0.0f, targetMaxWidth - properties->padding.left - properties->padding.right);
+        float childAvailableMaxHeight = std::max(0.0f, targetMaxHeight - properties->padding.top - properties->padding.bottom);
         
         BoxConstraints childConstraints(0, childAvailableMaxWidth, 0, childAvailableMaxHeight);
 
@@ -63,9 +73,9 @@ public:
         float contentHeight = 0;
 
         // 4. Layout the Child (Recursion)
-        if (properties.child) {
-            properties.child->layout(childConstraints);
-            Rect childRect = properties.child->getBounds(); // Assuming getBounds returns size after layout
+        if (child) {
+            child->layout(childConstraints);
+            Rect childRect = child->getBounds(); // Assuming getBounds returns size after layout
             contentWidth = childRect.width;
             contentHeight = childRect.height;
         }
@@ -75,13 +85,13 @@ public:
         // If width auto: use child width + padding.
         // Finally: Clamp to parent constraints.
         
-        float finalW = (properties.width > 0) 
-            ? properties.width 
-            : (contentWidth + properties.padding.left + properties.padding.right);
+        float finalW = (properties->width > 0) 
+            ? properties->width 
+            : (contentWidth + properties->padding.left + properties->padding.right);
         
-        float finalH = (properties.height > 0) 
-            ? properties.height 
-            : (contentHeight + properties.padding.top + properties.padding.bottom);
+        float finalH = (properties->height > 0) 
+            ? properties->height 
+            : (contentHeight + properties->padding.top + properties->padding.bottom);
 
         // Ensure we respect the parent's incoming constraints
         finalW = std::clamp(finalW, deflatedMinWidth, deflatedMaxWidth);
@@ -92,27 +102,31 @@ public:
         bounds.height = finalH;
 
         // 6. Alignment (Positioning the Child)
-        if (properties.child) {
+        if (child) {
             // Available space for child to move around in
-            float spaceForChildW = finalW - properties.padding.left - properties.padding.right;
-            float spaceForChildH = finalH - properties.padding.top - properties.padding.bottom;
+            float spaceForChildW = finalW - properties->padding.left - properties->padding.right;
+            float spaceForChildH = finalH - properties->padding.top - properties->padding.bottom;
             
-            Rect childRect = properties.child->getBounds();
+            Rect childRect = child->getBounds();
 
             // Calculate offset based on alignment (-1.0 to 1.0 or 0.0 to 1.0 depending on your Alignment impl)
             // Assuming Alignment is 0.0(left) to 1.0(right)
-            float xOffset = properties.padding.left + (spaceForChildW - childRect.width) * properties.alignment.x;
-            float yOffset = properties.padding.top + (spaceForChildH - childRect.height) * properties.alignment.y;
+            float xOffset = properties->padding.left + (spaceForChildW - childRect.width) * properties->alignment.x;
+            float yOffset = properties->padding.top + (spaceForChildH - childRect.height) * properties->alignment.y;
 
             // Set the child's local position relative to this container
             // (Assumes InternalDrawable has a way to set local position relative to parent)
-            properties.child->setBounds(Rect(xOffset, yOffset, childRect.width, childRect.height));
+            child->setBounds(Rect(xOffset, yOffset, childRect.width, childRect.height));
         }
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Container;
+    }
+
     void dispose() override {
-        if (properties.child) {
-            properties.child->dispose();
+        if (child) {
+            child->dispose();
         }
     }
 
@@ -121,8 +135,8 @@ public:
         // Apply Margin Offset:
         // The "bounds" calculated in layout usually represent the visual box. 
         // If margin is "outer space", we usually draw at x + margin.left.
-        float drawX = x + properties.margin.left;
-        float drawY = y + properties.margin.top;
+        float drawX = x + properties->margin.left;
+        float drawY = y + properties->margin.top;
 
         Rect contentRect = Rect(drawX, drawY, bounds.width, bounds.height);
 
@@ -132,24 +146,24 @@ public:
 #endif
 
         // Draw Background
-        if(properties.color.a > 0.0f){
-            ctx->fillRect(contentRect, properties.color);
+        if(properties->color.a > 0.0f){
+            ctx->fillRect(contentRect, properties->color);
         }
 
         // Clip (Scissor)
-        if (properties.clipToBounds) {
+        if (properties->clipToBounds) {
             ctx->setScissor(contentRect);
         }
 
         // Draw Child
-        if (properties.child) {
-            Rect childLocalInfo = properties.child->getBounds();
+        if (child) {
+            Rect childLocalInfo = child->getBounds();
             // child->onDraw takes absolute coordinates
-            properties.child->onDraw(ctx, drawX + childLocalInfo.x, drawY + childLocalInfo.y);
+            child->onDraw(ctx, drawX + childLocalInfo.x, drawY + childLocalInfo.y);
         }
 
         // Restore Clip
-        if (properties.clipToBounds) {
+        if (properties->clipToBounds) {
             ctx->clearScissor();
         }
     
@@ -160,8 +174,8 @@ public:
     }
 
     void onUpdate(float delta) override {
-        if (properties.child) {
-            properties.child->onUpdate(delta);
+        if (child) {
+            child->onUpdate(delta);
         }
     }
 
@@ -174,10 +188,29 @@ public:
         bounds = rect;
     }
 
-    ContainerProperties properties;
+    const ContainerProperties& getProps() const { return *properties; }
+
+    // Copy-on-write: containers sharing these properties keep theirs. The child field of the
+    // result is not used, setChild() replaces the child.
+    ContainerProperties& editProps() { return editProperties(properties); }
+
+    void setColor(const Color2D& color) {
+        editProps().color = color;
+    }
+
+    const std::shared_ptr<InternalDrawable>& getChild() const { return child; }
+
+    // Swaps the child in place. The caller initialises the new child, as for any widget it
+    // adds to a live tree; layout picks the change up on its next pass.
+    void setChild(std::shared_ptr<InternalDrawable> newChild) {
+        child = std::move(newChild);
+        if (child) child->setParent(this);
+    }
+
 protected:
-    Rect bounds;
+    std::shared_ptr<InternalDrawable> child;
+    std::shared_ptr<const ContainerProperties> properties;
 };
 
 #define Container(...) \
-    std::make_shared<D_Container>(ContainerProperties{__VA_ARGS__})
+    WidgetArena::make<D_Container>(ContainerProperties{__VA_ARGS__})
@@ -14,20 +14,36 @@ public:
     }
 
     void init() override {
+        SlicedTask::checkpoint();
         self = this->build();
         if (!self) {
              throw std::runtime_error("build() returned nullptr");
         }
         self->init();
+        notifyStructureChanged();
+    }
+
+    size_t getSubtreeSize() const override {
+        return self ? self->getSubtreeSize() : 1;
     }
 
     void layout(BoxConstraints constraints) override {
         if (self == nullptr) {
             throw std::runtime_error("Drawable has not been initialized, forgot to call super.init()?");
         }
+        SlicedTask::checkpoint();
         self->layout(constraints);
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Forward;
+    }
+
+    // The built tree, null before init()
+    InternalDrawable* getSelf() const {
+        return self.get();
+    }
+
     void dispose() override {
         if (self == nullptr) {
             throw std::runtime_error("Drawable has not been initialized, forgot to call super.init()?");
@@ -65,14 +81,14 @@ public:
         return self->getBounds();
     }
 
-    std::shared_ptr<InternalDrawable> getParent() const override {
+    InternalDrawable* getParent() const override {
         if (self == nullptr) {
             throw std::runtime_error("Drawable has not been initialized, forgot to call super.init()?");
         }
         return self->getParent();
     }
 
-    void setParent(const std::shared_ptr<InternalDrawable>& _parent) override {
+    void setParent(InternalDrawable* _parent) override {
         if (self == nullptr) {
             throw std::runtime_error("Drawable has not been initialized, forgot to call super.init()?");
         }
@@ -15,10 +15,14 @@ public:
     void init() override {
         if (properties.child) {
             properties.child->init();
-            properties.child->setParent(shared_from_this());
+            properties.child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return 1 + (properties.child ? properties.child->getSubtreeSize() : 0);
+    }
+
     void layout(BoxConstraints constraints) override {
         // If used outside of a Flex container (Row/Column) that recognizes it,
         // it behaves like a pass-through container.
@@ -31,6 +35,10 @@ public:
         }
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Expanded;
+    }
+
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         if (properties.child) properties.child->onDraw(ctx, x, y);
     }
@@ -57,4 +65,4 @@ protected:
     ExpandedProperties properties;
 };
 
-#define Expanded(...) std::make_shared<D_Expanded>(ExpandedProperties{__VA_ARGS__})
\ No newline at end of file
+#define Expanded(...) WidgetArena::make<D_Expanded>(ExpandedProperties{__VA_ARGS__})
\ No newline at end of file
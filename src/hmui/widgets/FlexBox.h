@@ -1,7 +1,9 @@
 #pragma once
 
 #include "hmui/widgets/InternalDrawable.h"
+#include "hmui/widgets/FrameArena.h"
 #include "hmui/widgets/Expanded.h"
+#include "hmui/layout/ParallelLayout.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -18,22 +20,33 @@ struct FlexBoxProperties {
 
 class D_FlexBox : public InternalDrawable {
 public:
-    explicit D_FlexBox(const FlexBoxProperties& properties) 
-        : properties(properties) {};
+    explicit D_FlexBox(FlexBoxProperties properties) 
+        : properties(std::move(properties)) {};
 
     void init() override {
+        childWeights.clear();
+        subtreeSize = 1;
+
         for (const auto& child : properties.children) {
             child->init();
-            child->setParent(shared_from_this());
+            child->setParent(this);
+
+            auto weight = static_cast<uint32_t>(child->getSubtreeSize());
+            childWeights.push_back(dynamic_cast<D_Expanded*>(child.get()) ? 0 : weight);
+            subtreeSize += weight;
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return subtreeSize;
+    }
+
     void layout(BoxConstraints constraints) override {
         float maxCrossSize = 0.0f;
         float usedMainSize = 0.0f;
         int totalFlex = 0;
         
-        std::vector<Rect> childSizes(properties.children.size());
+        ScratchVector<Rect> childSizes(properties.children.size(), FrameArena::get());
         bool isRow = properties.direction == Direction::Horizontal;
 
         // 1. Layout Non-Flexible Children
@@ -41,15 +54,25 @@ public:
             ? BoxConstraints(0.0f, INFINITY, 0.0f, constraints.maxHeight)
             : BoxConstraints(0.0f, constraints.maxWidth, 0.0f, INFINITY);
 
+        // Non-flexible children only depend on the constraints, so they can be laid out in
+        // parallel; their sizes are summed afterwards, in order
+        ParallelLayout::forEach(properties.children.size(),
+            [this](size_t i) { return childWeights[i]; },
+            [this, &looseConstraints, &childSizes](size_t i) {
+                auto& child = properties.children[i];
+                if (dynamic_cast<D_Expanded*>(child.get())) return;
+
+                child->layout(looseConstraints);
+                childSizes[i] = child->getBounds();
+            });
+
         for (size_t i = 0; i < properties.children.size(); ++i) {
             auto& child = properties.children[i];
             
             if (auto expanded = std::dynamic_pointer_cast<D_Expanded>(child)) {
                 totalFlex += expanded->getProps().flex;
             } else {
-                child->layout(looseConstraints);
-                Rect size = child->getBounds();
-                childSizes[i] = size;
+                Rect size = childSizes[i];
                 
                 maxCrossSize = std::max(maxCrossSize, isRow ? size.height : size.width);
                 usedMainSize += isRow ? size.width : size.height;
@@ -147,6 +170,12 @@ public:
         }
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Flex;
+    }
+
+    const FlexBoxProperties& getProps() const { return properties; }
+
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         for (const auto& child : properties.children) {
             Rect p = child->getBounds();
@@ -164,7 +193,8 @@ public:
 
 protected:
     FlexBoxProperties properties;
-    Rect bounds;
+    std::vector<uint32_t> childWeights; // Subtree sizes resolved in init(), 0 for Expanded
+    size_t subtreeSize = 1;
 };
 
-#define FlexBox(...) std::make_shared<D_FlexBox>(FlexBoxProperties{__VA_ARGS__})
\ No newline at end of file
+#define FlexBox(...) WidgetArena::make<D_FlexBox>(FlexBoxProperties{__VA_ARGS__})
\ No newline at end of file
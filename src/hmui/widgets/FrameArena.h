@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Scratch memory for temporaries that do not outlive a frame (layout child sizes, wrap runs).
+// Allocation is a pointer bump into a buffer that HMUI rewinds at the start of every frame.
+// When a frame needs more than the buffer holds the excess comes from the heap, and the
+// buffer is grown by that much on the next reset, so steady-state frames never allocate.
+// Each thread has its own arena, so HMUI instances on different threads never share one.
+// HMUI resets the arena of the thread running its frame; pool threads rewind theirs at the
+// start of every task they run for parallel layout or paint (ParallelLayout::TaskScope).
+class FrameArena {
+public:
+    static std::pmr::memory_resource* get() {
+        State& state = local();
+        if (!state.resource) state.rewind();
+        return &*state.resource;
+    }
+
+    // Invalidates everything this thread was handed out since its last reset
+    static void reset() {
+        local().rewind();
+    }
+
+    static size_t getCapacity() {
+        return local().buffer.size();
+    }
+
+private:
+    static constexpr size_t INITIAL_SIZE = 64 * 1024;
+
+    // Heap fallback that remembers how much the buffer fell short by
+    class Overflow : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    protected:
+        void* do_allocate(size_t size, size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    struct State {
+        std::vector<std::byte> buffer = std::vector<std::byte>(INITIAL_SIZE);
+        Overflow overflow;
+        std::optional<std::pmr::monotonic_buffer_resource> resource;
+
+        void rewind() {
+            resource.reset(); // Returns any overflow blocks
+
+            if (overflow.bytes > 0) {
+                buffer.resize(buffer.size() + overflow.bytes);
+                overflow.bytes = 0;
+            }
+
+            resource.emplace(buffer.data(), buffer.size(), &overflow);
+        }
+    };
+
+    static State& local() {
+        static thread_local State state;
+        return state;
+    }
+};
+
+// A vector for frame temporaries: ScratchVector<Rect> sizes(FrameArena::get());
+template<typename T>
+using ScratchVector = std::pmr::vector<T>;
@@ -2,6 +2,7 @@
 
 #include "hmui/widgets/InternalDrawable.h"
 #include "hmui/input/FocusManager.h"
+#include "hmui/widgets/SharedProperties.h"
 #include <memory>
 #include <functional>
 #include <utility>
@@ -30,46 +31,57 @@ struct GestureDetectorProperties {
 
 class D_GestureDetector : public InternalDrawable {
 public:
+    // The child is taken out of the properties. What is left (callbacks, focus) is only
+    // allocated when something is set, most detectors share one default block.
     explicit D_GestureDetector(GestureDetectorProperties properties)
-        : properties(std::move(properties)) {}
+        : child(std::move(properties.child)), properties(share(std::move(properties))) {}
+
+    // Points at properties other detectors use too; their child field is ignored
+    D_GestureDetector(std::shared_ptr<const GestureDetectorProperties> properties,
+                      std::shared_ptr<InternalDrawable> child)
+        : child(std::move(child)), properties(std::move(properties)) {}
 
     void init() override {
         InternalDrawable::init();
 
-        if (properties.child) {
-            properties.child->init();
-            properties.child->setParent(shared_from_this());
+        if (child) {
+            child->init();
+            child->setParent(this);
         }
 
-        if (properties.focusable) {
-            focusNode = std::make_shared<FocusNode>();
+        if (properties->focusable) {
+            focusNode = WidgetArena::make<FocusNode>();
             focusNode->id = "GestureDetector_" + std::to_string(reinterpret_cast<std::uintptr_t>(this));
-            focusNode->widget = shared_from_this();
+            focusNode->widget = this;
 
             // Define behaviors
             focusNode->onFocus = [this]() {
-                if (properties.onHover) properties.onHover(properties.child, 0, 0);
+                if (properties->onHover) properties->onHover(child, 0, 0);
             };
 
             focusNode->onBlur = [this]() {
-                if (properties.onHoverEnd) properties.onHoverEnd(properties.child, 0, 0);
+                if (properties->onHoverEnd) properties->onHoverEnd(child, 0, 0);
             };
 
             focusNode->onSubmit = [this]() {
-                if (properties.onTap) properties.onTap(properties.child, 0, 0);
+                if (properties->onTap) properties->onTap(child, 0, 0);
             };
 
             FocusManager::get()->registerNode(focusNode);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return 1 + (child ? child->getSubtreeSize() : 0);
+    }
+
     void layout(BoxConstraints constraints) override {
-        if (properties.child) {
+        if (child) {
             // Pass constraints through to child
-            properties.child->layout(constraints);
+            child->layout(constraints);
             
             // GestureDetector adopts the size of its child
-            Rect childBounds = properties.child->getBounds();
+            Rect childBounds = child->getBounds();
             bounds.width = childBounds.width;
             bounds.height = childBounds.height;
         } else {
@@ -82,21 +94,21 @@ public:
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         absoluteRect = Rect(x, y, bounds.width, bounds.height);
 
-        if (properties.child) {
-            properties.child->onDraw(ctx, x, y);
+        if (child) {
+            child->onDraw(ctx, x, y);
         }
 
-        if (properties.focusable && focusNode && FocusManager::get()->isFocused(focusNode)) {
-            ctx->drawRect(absoluteRect, properties.focusDecorator.color, properties.focusDecorator.thickness);
+        if (properties->focusable && focusNode && FocusManager::get()->isFocused(focusNode)) {
+            ctx->drawRect(absoluteRect, properties->focusDecorator.color, properties->focusDecorator.thickness);
         }
     }
 
     void onUpdate(float delta) override {
-        if (properties.child) {
-            properties.child->onUpdate(delta);
+        if (child) {
+            child->onUpdate(delta);
         }
 
-        auto os = hmui->getOSContext();
+        auto os = hmui()->getOSContext();
         auto mousePos = os->getMousePosition();
 
         // Hit Test using the absolute rect captured during Draw
@@ -109,10 +121,10 @@ public:
         if (!os->isTouchDevice()) {
             if (isHovering && !isHovered) {
                 isHovered = true;
-                if (properties.onHover) properties.onHover(properties.child, mousePos.x, mousePos.y);
+                if (properties->onHover) properties->onHover(child, mousePos.x, mousePos.y);
             } else if (!isHovering && isHovered) {
                 isHovered = false;
-                if (properties.onHoverEnd) properties.onHoverEnd(properties.child, mousePos.x, mousePos.y);
+                if (properties->onHoverEnd) properties->onHoverEnd(child, mousePos.x, mousePos.y);
             }
         }
 
@@ -122,7 +134,7 @@ public:
         if (isHovering && isMouseDown) {
             if (!isPressed) {
                 isPressed = true;
-                if (properties.onTap) properties.onTap(properties.child, mousePos.x, mousePos.y);
+                if (properties->onTap) properties->onTap(child, mousePos.x, mousePos.y);
             }
         } else {
             // Logic for release: 
@@ -130,18 +142,18 @@ public:
             // (Note: standard UI triggers release even if mouse left bounds, as long as it started there)
             if (isPressed && !isMouseDown) {
                 isPressed = false;
-                if (properties.onTapRelease) properties.onTapRelease(properties.child, mousePos.x, mousePos.y);
+                if (properties->onTapRelease) properties->onTapRelease(child, mousePos.x, mousePos.y);
             }
         }
 
         // 3. Controller Press Logic (if focused)
         if (focusNode && FocusManager::get()->isFocused(focusNode) && os->isGamepadAvailable(0)) {
-            if (properties.onControllerPress) {
+            if (properties->onControllerPress) {
                 for (int btn = static_cast<int>(ControllerButton::LEFT_FACE_UP); 
                      btn <= static_cast<int>(ControllerButton::RIGHT_FACE_LEFT); 
                      ++btn) {
                     if (os->isGamepadButtonPressed(0, static_cast<ControllerButton>(btn))) {
-                        properties.onControllerPress(properties.child, static_cast<ControllerButton>(btn));
+                        properties->onControllerPress(child, static_cast<ControllerButton>(btn));
                     }
                 }
             }
@@ -156,18 +168,38 @@ public:
         bounds = rect;
     }
 
+    ~D_GestureDetector() override {
+        // The node may outlive us in a focus history
+        if (focusNode) focusNode->widget = nullptr;
+    }
+
     void dispose() override {
         if (focusNode) {
+            focusNode->widget = nullptr;
             FocusManager::get()->unregisterNode(focusNode);
             focusNode = nullptr;
         }
 
-        if (properties.child) properties.child->dispose();
+        if (child) child->dispose();
     }
 
+    const GestureDetectorProperties& getProps() const { return *properties; }
+
+    // Copy-on-write, see Container; takes effect for focus at the next init()
+    GestureDetectorProperties& editProps() { return editProperties(properties); }
+
 protected:
-    GestureDetectorProperties properties;
-    Rect bounds;         // Local size
+    static std::shared_ptr<const GestureDetectorProperties> share(GestureDetectorProperties properties) {
+        static const std::shared_ptr<const GestureDetectorProperties> defaults =
+            std::make_shared<GestureDetectorProperties>();
+
+        bool used = properties.focusable || properties.onTap || properties.onTapRelease || properties.onHover ||
+                    properties.onHoverEnd || properties.onControllerPress || properties.onControllerRelease;
+        return used ? shareProperties(std::move(properties)) : defaults;
+    }
+
+    std::shared_ptr<InternalDrawable> child;
+    std::shared_ptr<const GestureDetectorProperties> properties;
     Rect absoluteRect;   // Global position for hit testing
     std::shared_ptr<FocusNode> focusNode;
     bool isHovered = false;
@@ -175,4 +207,4 @@ protected:
 };
 
 #define GestureDetector(...) \
-    std::make_shared<D_GestureDetector>(GestureDetectorProperties{__VA_ARGS__})
+    WidgetArena::make<D_GestureDetector>(GestureDetectorProperties{__VA_ARGS__})
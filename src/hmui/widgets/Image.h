@@ -17,6 +17,20 @@ struct ImageProperties {
     
     BoxFit fit = BoxFit::Contain;
     Alignment alignment = Alignment::Center();
+
+    // Texture residency: the texture starts decoding in the background once the image comes
+    // within residencyMargin pixels of the visible area (or will, at the current scroll speed,
+    // within prefetchTime seconds), is uploaded when the decode is done and released after
+    // releaseDelay seconds off-screen.
+    float residencyMargin = 256.0f;
+    float prefetchTime = 0.5f;
+    float releaseDelay = 2.0f;
+
+    // Filled into the image's final rect while its texture is not resident
+    Color2D placeholderColor = Color2D(0.0f, 0.0f, 0.0f, 0.0f);
+
+    // Build a mip chain at load, for images that are drawn at several sizes
+    bool mipmaps = false;
 };
 
 class D_Image : public InternalDrawable {
@@ -30,8 +44,26 @@ public:
             throw std::runtime_error("Image must have a valid ImageProvider");
         }
 
-        // Load the image resource
-        image = properties.provider->load();
+        // With an explicit size the texture is drawn into that box and never needs more
+        // pixels than it, let the provider shrink it at load. scale only sizes the image when
+        // it has no explicit size. BoxFit::None draws at native size, so no hint there.
+        ImageLoadHints hints;
+        if (properties.fit != BoxFit::None) {
+            hints.maxWidth = (int) std::ceil(properties.width);
+            hints.maxHeight = (int) std::ceil(properties.height);
+        }
+        hints.mipmaps = properties.mipmaps;
+        properties.provider->setLoadHints(hints);
+
+        // Being prewarmed: start decoding now, the prewarm uploads it before we are shown and
+        // hands us the texture, released by release() like one we loaded
+        if (auto* prefetch = ImagePrefetchScope::get()) {
+            prefetch->add(properties.provider, [this](ImageHandle* handle) {
+                if (!image) image = handle;
+            });
+        }
+
+        // The texture is not loaded here, onUpdate() acquires it once we get close to the screen
     }
 
     void layout(BoxConstraints constraints) override {
@@ -39,7 +71,13 @@ public:
         float intrinsicW = 0.0f;
         float intrinsicH = 0.0f;
 
-        if (image) {
+        // Prefer the header over the texture: the size is known before the pixels are
+        // decoded, so a late texture never shifts the layout
+        ImageInfo info;
+        if (properties.provider && properties.provider->probe(info)) {
+            intrinsicW = info.width * properties.scale;
+            intrinsicH = info.height * properties.scale;
+        } else if (image) {
             intrinsicW = image->width * properties.scale;
             intrinsicH = image->height * properties.scale;
         }
@@ -60,22 +98,46 @@ public:
     }
 
     void dispose() override {
-        if (properties.provider) {
-            properties.provider->dispose();
-        }
+        release();
     }
 
     void onDraw(GraphicsContext* ctx, float x, float y) override {
-        // 1. Safety Check: If image is null OR bounds are invalid, do nothing.
+        // Remember where we are on screen, onUpdate() decides on residency from it
+        absoluteRect = Rect(x, y, bounds.width, bounds.height);
+        visibleArea = ctx->getClipRect();
+        drawn = true;
+
+        // 1. Safety Check: If bounds are invalid, do nothing.
         // This prevents pushing invalid scissors or drawing nothing.
-        if (!image || bounds.width <= 0.0f || bounds.height <= 0.0f) {
+        if (bounds.width <= 0.0f || bounds.height <= 0.0f) {
+            return;
+        }
+
+        // 2. Placeholder: pixels not resident yet, but the header already gave us the final rect
+        if (!image) {
+            ImageInfo info;
+            if (properties.placeholderColor.a > 0.0f && properties.provider->probe(info)) {
+                ctx->fillRect(getDestinationRect(x, y, bounds.width, bounds.height,
+                                                 info.width * properties.scale,
+                                                 info.height * properties.scale),
+                              properties.placeholderColor);
+            }
             return;
         }
 
         // 3. Calculate Layout
+        // Geometry follows the source size: the texture may have been downscaled at load
+        float iw = (float) image->width;
+        float ih = (float) image->height;
+        ImageInfo info;
+        if (properties.provider->probe(info)) {
+            iw = (float) info.width;
+            ih = (float) info.height;
+        }
+
         Rect dest = getDestinationRect(x, y, bounds.width, bounds.height, 
-                                     image->width * properties.scale, 
-                                     image->height * properties.scale);
+                                     iw * properties.scale, 
+                                     ih * properties.scale);
 
         // 4. Draw
         ctx->drawImage(
@@ -85,6 +147,39 @@ public:
         );
     }
 
+    void onUpdate(float delta) override {
+        if (!drawn) {
+            // Not painted since the last update (e.g. covered by another route)
+            updateResidency(false, delta);
+            return;
+        }
+        drawn = false;
+
+        // Track screen-space velocity so images ahead of a scroll are loaded early
+        if (delta > 0.0f && hasLastRect) {
+            float vx = (absoluteRect.x - lastRect.x) / delta;
+            float vy = (absoluteRect.y - lastRect.y) / delta;
+            velocityX = lerp(velocityX, vx, 0.5f);
+            velocityY = lerp(velocityY, vy, 0.5f);
+        }
+        lastRect = absoluteRect;
+        hasLastRect = true;
+
+        float margin = properties.residencyMargin;
+        Rect area(visibleArea.x - margin, visibleArea.y - margin,
+                  visibleArea.width + margin * 2.0f, visibleArea.height + margin * 2.0f);
+
+        Rect ahead = absoluteRect;
+        ahead.x += velocityX * properties.prefetchTime;
+        ahead.y += velocityY * properties.prefetchTime;
+
+        updateResidency(absoluteRect.intersects(area) || ahead.intersects(area), delta);
+    }
+
+    bool isResident() const {
+        return image != nullptr;
+    }
+
     Rect getBounds() const override {
         return bounds;
     }
@@ -94,9 +189,54 @@ public:
     }
 
 protected:
+    void updateResidency(bool wanted, float delta) {
+        if (wanted) {
+            offscreenTime = 0.0f;
+            if (image) return;
+
+            // Decode off the UI thread and only upload once that is done, load() would block
+            // on the decode. The placeholder is drawn meanwhile.
+            if (!prefetched) {
+                properties.provider->prefetch();
+                prefetched = true;
+            }
+            if (properties.provider->isReady()) {
+                image = properties.provider->load();
+                prefetched = false;
+            }
+            return;
+        }
+
+        offscreenTime += delta;
+        if (image && offscreenTime >= properties.releaseDelay) {
+            release();
+        }
+    }
+
+    void release() {
+        if (image && properties.provider) {
+            properties.provider->dispose();
+        }
+        image = nullptr;
+    }
+
+    static float lerp(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+
     ImageProperties properties;
     ImageHandle* image = nullptr;
-    Rect bounds;
+
+    // Residency tracking
+    Rect absoluteRect;
+    Rect visibleArea;
+    Rect lastRect;
+    bool hasLastRect = false;
+    bool drawn = false;
+    bool prefetched = false; // Decode started, not loaded yet
+    float velocityX = 0.0f;
+    float velocityY = 0.0f;
+    float offscreenTime = 0.0f;
 
 private:
     // Calculates the destination rect for the image content based on BoxFit and Alignment
@@ -155,4 +295,4 @@ private:
     }
 };
 
-#define Image(...) std::make_shared<D_Image>(ImageProperties{__VA_ARGS__})
\ No newline at end of file
+#define Image(...) WidgetArena::make<D_Image>(ImageProperties{__VA_ARGS__})
\ No newline at end of file
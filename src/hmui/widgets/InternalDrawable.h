@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include "hmui/HMUI.h"
 #include "hmui/graphics/GraphicsContext.h"
+#include "hmui/widgets/WidgetArena.h"
 #include <algorithm>
 #include <cmath>
 
@@ -95,10 +97,44 @@ enum class BoxFit {
     ScaleDown   // Like None, but scales down if image is too large (like Contain)
 };
 
-class InternalDrawable : public std::enable_shared_from_this<InternalDrawable> {
+// The built-in layout algorithm a widget's layout() implements. FlatLayout runs these itself
+// over flat arrays; anything else (Custom) is laid out by calling layout(). A subclass that
+// overrides layout() must report Custom again.
+enum class LayoutKind : uint8_t {
+    Custom,
+    Column,
+    Row,
+    Flex,       // D_FlexBox
+    Container,
+    Expanded,
+    Fill,       // Fills the constraints, single child stretched over it (AppContext)
+    Forward     // Is its single child as far as layout goes (Drawable)
+};
+
+// Ownership runs strictly downwards: parents own their children through shared_ptrs and a
+// child only keeps a raw back-pointer, so dropping a route's root frees its whole tree.
+// Nodes are kept small (vtable, bounds, parent: 32 bytes on 64-bit), the widget types add
+// their properties on top, see WidgetFootprint.h.
+class InternalDrawable {
 public:
-    InternalDrawable() : bounds(Rect(0, 0, 0, 0)) {}
-    virtual ~InternalDrawable() = default;
+    InternalDrawable() : bounds(Rect(0, 0, 0, 0)) { liveCount++; }
+    InternalDrawable(const InternalDrawable& other) : bounds(other.bounds) { liveCount++; }
+    virtual ~InternalDrawable() { liveCount--; }
+
+    // Widgets currently alive, to check that popped routes are actually freed
+    static size_t getLiveCount() {
+        return liveCount.load(std::memory_order_relaxed);
+    }
+
+    // Call when a widget changes which children it lays out (e.g. a route push), so cached
+    // copies of the tree structure (FlatLayout) get rebuilt
+    static void notifyStructureChanged() {
+        structureGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint64_t getStructureGeneration() {
+        return structureGeneration.load(std::memory_order_relaxed);
+    }
 
     virtual void init() {}
 
@@ -109,6 +145,16 @@ public:
         // calculates its size based on constraints and sets bounds.width/height
     }
 
+    virtual LayoutKind getLayoutKind() const {
+        return LayoutKind::Custom;
+    }
+
+    // Nodes in this subtree, this one included. Only meaningful after init(); parallel
+    // layout uses it as the cost of laying the subtree out.
+    virtual size_t getSubtreeSize() const {
+        return 1;
+    }
+
     virtual void onDraw(GraphicsContext* ctx, float x, float y) {}
 
     virtual void onUpdate(float delta) {}
@@ -121,16 +167,24 @@ public:
         bounds = rect;
     }
 
-    virtual void setParent(const std::shared_ptr<InternalDrawable>& _parent) {
+    virtual void setParent(InternalDrawable* _parent) {
         parent = _parent;
     }
 
-    virtual std::shared_ptr<InternalDrawable> getParent() const {
+    // The parent owns this node, so it is valid for as long as the node is in the tree
+    virtual InternalDrawable* getParent() const {
         return parent;
     }
 
 protected:
+    static HMUI* hmui() {
+        return HMUI::current();
+    }
+
     Rect bounds;
-    HMUI* hmui = HMUI::Instance;
-    std::shared_ptr<InternalDrawable> parent;
+    InternalDrawable* parent = nullptr;
+
+private:
+    static inline std::atomic<size_t> liveCount{0};
+    static inline std::atomic<uint64_t> structureGeneration{0};
 };
\ No newline at end of file
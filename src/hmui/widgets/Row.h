@@ -1,4 +1,5 @@
 #include "hmui/widgets/InternalDrawable.h"
+#include "hmui/widgets/FrameArena.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -15,22 +16,28 @@ struct RowProperties {
 class D_Row : public InternalDrawable {
 public:
     explicit D_Row(
-        const RowProperties& properties
-    ) : children(properties.children), 
+        RowProperties properties
+    ) : children(std::move(properties.children)), 
         mainAxisAlignment(properties.mainAxisAlignment), 
         crossAxisAlignment(properties.crossAxisAlignment) {};
 
     void init() override {
         for (const auto& child : children) {
             child->init();
-            child->setParent(shared_from_this());
+            child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        size_t size = 1;
+        for (const auto& child : children) size += child->getSubtreeSize();
+        return size;
+    }
+
     void layout(BoxConstraints constraints) override {
         float maxChildHeight = 0.0f;
         float totalChildrenWidth = 0.0f;
-        std::vector<Rect> childSizes;
+        ScratchVector<Rect> childSizes(FrameArena::get());
         childSizes.reserve(children.size());
 
         // Row Constraints: Unbounded width for children (to get intrinsic size), bounded height.
@@ -113,6 +120,14 @@ public:
         }
     }
 
+    LayoutKind getLayoutKind() const override {
+        return LayoutKind::Row;
+    }
+
+    const ChildrenList& getChildren() const { return children; }
+    MainAxisAlignment getMainAxisAlignment() const { return mainAxisAlignment; }
+    CrossAxisAlignment getCrossAxisAlignment() const { return crossAxisAlignment; }
+
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         for (const auto& child : children) {
             Rect childLocalParams = child->getBounds();
@@ -144,7 +159,6 @@ protected:
     std::vector<std::shared_ptr<InternalDrawable>> children;
     MainAxisAlignment mainAxisAlignment;
     CrossAxisAlignment crossAxisAlignment;
-    Rect bounds;
 };
 
-#define Row(...) std::make_shared<D_Row>(RowProperties{__VA_ARGS__})
\ No newline at end of file
+#define Row(...) WidgetArena::make<D_Row>(RowProperties{__VA_ARGS__})
\ No newline at end of file
@@ -19,6 +19,7 @@ struct ScrollableProperties {
     Direction direction = Direction::Vertical;
     std::shared_ptr<InternalDrawable> child = nullptr;
     bool clipToBounds = true;
+    bool stickToEnd = false; // Keep following the end of the content while scrolled all the way to it (logs, chat)
 };
 
 class D_Scrollable : public InternalDrawable {
@@ -29,10 +30,14 @@ public:
     void init() override {
         if (properties.child) {
             properties.child->init();
-            properties.child->setParent(shared_from_this());
+            properties.child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return 1 + (properties.child ? properties.child->getSubtreeSize() : 0);
+    }
+
     void layout(BoxConstraints constraints) override {
         // 1. Determine Viewport Size (The "Window")
         // We try to fill the parent's constraints.
@@ -80,8 +85,13 @@ public:
 
         // 3. Calculate Max Scroll Extent
         // If content is smaller than viewport, maxScroll is 0.
+        bool wasAtEnd = nextOffset >= maxScrollExtent - 1.0f;
         maxScrollExtent = std::max(0.0f, contentSize - viewportSize);
 
+        if (properties.stickToEnd && wasAtEnd) {
+            nextOffset = maxScrollExtent;
+        }
+
         // Clamp offset immediately if content shrank
         nextOffset = std::clamp(nextOffset, 0.0f, maxScrollExtent);
     }
@@ -130,7 +140,7 @@ public:
 
         properties.child->onUpdate(delta);
 
-        auto os = hmui->getOSContext();
+        auto os = hmui()->getOSContext();
         auto mousePos = os->getMousePosition();
 
         // Hit Test: Check if mouse is inside the Viewport (Visible Area)
@@ -156,7 +166,7 @@ public:
 
         auto focusNode = FocusManager::get()->getCurrentFocus();
         if (focusNode) {
-            if (auto focusedWidget = focusNode->widget.lock()) {
+            if (InternalDrawable* focusedWidget = focusNode->widget) {
 
                 // 1. Calculate position relative to this Scrollable
                 // We walk up the tree from the focused widget until we hit 'this' (the Scrollable)
@@ -165,10 +175,10 @@ public:
                 float childSize = 0.0f;
 
                 bool isDescendant = false;
-                auto walker = focusedWidget;
+                InternalDrawable* walker = focusedWidget;
 
                 while (walker) {
-                    if (walker.get() == this) {
+                    if (walker == this) {
                         isDescendant = true;
                         break;
                     }
@@ -228,7 +238,6 @@ public:
 
 protected:
     ScrollableProperties properties;
-    Rect bounds;        // Local Size (Viewport)
     Rect absoluteRect;  // Global Position (for Hit Test)
 
     float offset = 0.0f;
@@ -236,4 +245,4 @@ protected:
     float maxScrollExtent = 0.0f;
 };
 
-#define Scrollable(...) std::make_shared<D_Scrollable>(ScrollableProperties{__VA_ARGS__})
\ No newline at end of file
+#define Scrollable(...) WidgetArena::make<D_Scrollable>(ScrollableProperties{__VA_ARGS__})
\ No newline at end of file
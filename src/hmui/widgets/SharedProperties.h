@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "hmui/widgets/WidgetArena.h"
+
+// Widgets keep their properties behind a shared_ptr<const ...>, so rows built from one
+// template can point at a single copy instead of carrying one each. Nothing writes through a
+// shared pointer: the setters widgets offer go through editProperties(), which copies the
+// properties first unless the widget is the only one holding them. Properties handed to
+// several widgets must therefore be created non-const (make_shared<T>, shareProperties).
+template<typename T>
+std::shared_ptr<const T> shareProperties(T properties) {
+    return WidgetArena::makeShared<T>(std::move(properties));
+}
+
+template<typename T>
+T& editProperties(std::shared_ptr<const T>& properties) {
+    if (properties.use_count() != 1) {
+        properties = shareProperties(T(*properties));
+    }
+    return const_cast<T&>(*properties);
+}
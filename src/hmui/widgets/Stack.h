@@ -1,6 +1,8 @@
 #pragma once
 
 #include "hmui/widgets/InternalDrawable.h"
+#include "hmui/layout/ParallelLayout.h"
+#include "hmui/graphics/ParallelPaint.h"
 #include <vector>
 #include <memory>
 #include <optional>
@@ -28,10 +30,14 @@ public:
     void init() override {
         if (properties.child) {
             properties.child->init();
-            properties.child->setParent(shared_from_this());
+            properties.child->setParent(this);
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return 1 + (properties.child ? properties.child->getSubtreeSize() : 0);
+    }
+
     // Forward layout call to child
     void layout(BoxConstraints constraints) override {
         if (properties.child) {
@@ -94,12 +100,23 @@ public:
     explicit D_Stack(StackProperties props) : properties(std::move(props)) {}
 
     void init() override {
+        layoutChildren.clear();
+        subtreeSize = 1;
+
         for (auto& child : properties.children) {
             child->init();
-            child->setParent(shared_from_this());
+            child->setParent(this);
+
+            auto weight = static_cast<uint32_t>(child->getSubtreeSize());
+            layoutChildren.push_back({dynamic_cast<D_Positioned*>(child.get()), weight});
+            subtreeSize += weight;
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return subtreeSize;
+    }
+
     void layout(BoxConstraints constraints) override {
         float hasNonPositioned = false;
         float maxChildWidth = 0.0f;
@@ -116,11 +133,19 @@ public:
             nonPosConstraints = BoxConstraints::loose(constraints.maxWidth, constraints.maxHeight);
         }
 
-        for (auto& child : properties.children) {
-            if (std::dynamic_pointer_cast<D_Positioned>(child)) continue;
+        // Children do not depend on each other, so with ParallelLayout on they may be laid out
+        // concurrently; the sizes are combined afterwards, in order
+        size_t count = properties.children.size();
+        ParallelLayout::forEach(count,
+            [this](size_t i) { return layoutChildren[i].positioned ? 0 : layoutChildren[i].weight; },
+            [this, &nonPosConstraints](size_t i) {
+                if (!layoutChildren[i].positioned) properties.children[i]->layout(nonPosConstraints);
+            });
 
-            child->layout(nonPosConstraints);
-            Rect childSize = child->getBounds();
+        for (size_t i = 0; i < count; ++i) {
+            if (layoutChildren[i].positioned) continue;
+
+            Rect childSize = properties.children[i]->getBounds();
             
             maxChildWidth = std::max(maxChildWidth, childSize.width);
             maxChildHeight = std::max(maxChildHeight, childSize.height);
@@ -145,14 +170,18 @@ public:
         if (bounds.height == INFINITY) bounds.height = 0;
 
         // 3. Layout Positioned Children & Calculate Offsets
-        for (auto& child : properties.children) {
-            // Is it Positioned?
-            auto positioned = std::dynamic_pointer_cast<D_Positioned>(child);
-            
-            if (positioned) {
-                layoutPositionedChild(positioned, bounds.width, bounds.height);
-            } else {
+        ParallelLayout::forEach(count,
+            [this](size_t i) { return layoutChildren[i].positioned ? layoutChildren[i].weight : 0; },
+            [this](size_t i) {
+                if (auto positioned = layoutChildren[i].positioned) {
+                    layoutPositionedChild(positioned, bounds.width, bounds.height);
+                }
+            });
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!layoutChildren[i].positioned) {
                 // Align Non-Positioned Child
+                auto& child = properties.children[i];
                 Rect childSize = child->getBounds();
                 float alignX = properties.alignment.x; // Assumes 0.0 to 1.0
                 float alignY = properties.alignment.y;
@@ -168,11 +197,14 @@ public:
 
     void onDraw(GraphicsContext* ctx, float x, float y) override {
         // Draw children from bottom to top
-        for (auto& child : properties.children) {
-            Rect childLocal = child->getBounds();
-            // Translate local coordinates to global screen coordinates
-            child->onDraw(ctx, x + childLocal.x, y + childLocal.y);
-        }
+        ParallelPaint::forEach(ctx, properties.children.size(),
+            [this](size_t i) { return layoutChildren[i].weight; },
+            [this, x, y](size_t i, GraphicsContext* target) {
+                auto& child = properties.children[i];
+                Rect childLocal = child->getBounds();
+                // Translate local coordinates to global screen coordinates
+                child->onDraw(target, x + childLocal.x, y + childLocal.y);
+            });
     }
 
     void onUpdate(float delta) override {
@@ -191,7 +223,13 @@ public:
     void setBounds(const Rect& rect) override { bounds = rect; }
 
 private:
-    void layoutPositionedChild(std::shared_ptr<D_Positioned> wrapper, float stackW, float stackH) {
+    // What layout needs of a child, resolved once in init()
+    struct LayoutChild {
+        D_Positioned* positioned; // Null for non-positioned children
+        uint32_t weight;          // Subtree size
+    };
+
+    void layoutPositionedChild(D_Positioned* wrapper, float stackW, float stackH) {
         auto& props = wrapper->getProps();
         
         float minW = 0, maxW = stackW;
@@ -268,11 +306,12 @@ private:
     }
 
     StackProperties properties;
-    Rect bounds;
+    std::vector<LayoutChild> layoutChildren;
+    size_t subtreeSize = 1;
 };
 
 #define Stack(...) \
-    std::make_shared<D_Stack>(StackProperties{__VA_ARGS__})
+    WidgetArena::make<D_Stack>(StackProperties{__VA_ARGS__})
 
 #define Positioned(...) \
-    std::make_shared<D_Positioned>(PositionedProperties{__VA_ARGS__})
+    WidgetArena::make<D_Positioned>(PositionedProperties{__VA_ARGS__})
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <algorithm>
 #include <cmath>
 
 #include "InternalDrawable.h"
+#include "SharedProperties.h"
+#include "hmui/graphics/text/TextLayout.h"
 
 enum class HorizontalAlign { Left, Center, Right };
 enum class VerticalAlign   { Top, Center, Bottom };
@@ -16,70 +19,55 @@ struct TextProperties {
     HorizontalAlign alignH = HorizontalAlign::Left;
     VerticalAlign alignV = VerticalAlign::Top;
     Color2D color = Color2D(1.0f, 1.0f, 1.0f, 1.0f);
+    bool softWrap = true;   // Wrap at word boundaries when the parent constrains the width
+    int maxLines = 0;       // 0 = unlimited
+    bool ellipsis = false;  // End the last visible line with "..." when maxLines cuts the text
 };
 
 class D_Text : public InternalDrawable {
 public:
-    explicit D_Text(TextProperties properties) 
-        : properties(std::move(properties)) {};
+    explicit D_Text(TextProperties properties)
+        : properties(shareProperties(std::move(properties))) {}
+
+    // Points at properties other texts use too
+    explicit D_Text(std::shared_ptr<const TextProperties> properties)
+        : properties(std::move(properties)) {}
 
     void init() override {
         // No resources to load for simple text
     }
 
     void layout(BoxConstraints constraints) override {
-        // 1. Measure Text
-        float textW = 0.0f;
-        float textH = 0.0f;
-        
-        Rect size = hmui->getGraphicsContext()->calculateTextBounds(properties.text.c_str());
-        textW = size.width * properties.scale;
-        textH = size.height * properties.scale;
+        // 1. Break & Measure Text
+        // The line breaks are cached and only recomputed when the width crosses a break point
+        const TextLayoutResult& text = breakLines(*hmui()->getFontMetrics(), constraints.maxWidth);
 
         // 2. Apply Constraints
         // If constraints are loose (0 to Infinity), we take the text size.
         // If constraints are tight (Width=100), we take 100.
-        bounds.width = std::clamp(textW, constraints.minWidth, constraints.maxWidth);
-        bounds.height = std::clamp(textH, constraints.minHeight, constraints.maxHeight);
-
-        // Store measured content size for alignment calculation in Draw
-        contentSize = Rect(0, 0, textW, textH);
+        bounds.width = std::clamp(text.width, constraints.minWidth, constraints.maxWidth);
+        bounds.height = std::clamp(text.height, constraints.minHeight, constraints.maxHeight);
     }
 
     void onDraw(GraphicsContext* ctx, float x, float y) override {
-        float drawX = x;
-        float drawY = y;
-
 #ifdef DEBUG_COMPONENTS
         // Draw bounds for debugging
         ctx->drawRect(Rect(x, y, bounds.width, bounds.height), Color2D(1.0f, 0.0f, 1.0f, 1.0f));
 #endif
 
-        // If layout was skipped (shouldn't happen), measure now
-        if (contentSize.width == 0 && !properties.text.empty()) {
-            Rect size = ctx->calculateTextBounds(properties.text.c_str());
-            contentSize.width = size.x * properties.scale;
-            contentSize.height = size.y * properties.scale;
+        // If layout was skipped (shouldn't happen), lay out on a single line now
+        if ((!lineCache || !lineCache->hasResult()) && !properties->text.empty() && ctx->getFontMetrics()) {
+            breakLines(*ctx->getFontMetrics(), INFINITY);
         }
+        if (!lineCache) return;
 
-        // Horizontal Alignment
-        // Calculate the empty space inside the bounds and offset accordingly
-        float freeSpaceW = bounds.width - contentSize.width;
-        switch (properties.alignH) {
-            case HorizontalAlign::Left:   
-                drawX = x; 
-                break;
-            case HorizontalAlign::Center: 
-                drawX = x + (freeSpaceW * 0.5f); 
-                break;
-            case HorizontalAlign::Right:  
-                drawX = x + freeSpaceW; 
-                break;
-        }
+        const TextLayoutResult& text = lineCache->getResult();
+        if (text.lines.empty()) return;
 
-        // Vertical Alignment
-        float freeSpaceH = bounds.height - contentSize.height;
-        switch (properties.alignV) {
+        // Vertical Alignment (of the whole block)
+        float drawY = y;
+        float freeSpaceH = bounds.height - text.height;
+        switch (properties->alignV) {
             case VerticalAlign::Top:    
                 drawY = y; 
                 break;
@@ -91,7 +79,29 @@ public:
                 break;
         }
 
-        ctx->drawText(drawX, drawY, properties.text.c_str(), properties.scale, properties.color); 
+        float lineHeight = text.height / (float) text.lines.size();
+        for (const auto& line : text.lines) {
+            // Horizontal Alignment (per line)
+            // Calculate the empty space inside the bounds and offset accordingly
+            float drawX = x;
+            float freeSpaceW = bounds.width - line.width;
+            switch (properties->alignH) {
+                case HorizontalAlign::Left:   
+                    drawX = x; 
+                    break;
+                case HorizontalAlign::Center: 
+                    drawX = x + (freeSpaceW * 0.5f); 
+                    break;
+                case HorizontalAlign::Right:  
+                    drawX = x + freeSpaceW; 
+                    break;
+            }
+
+            if (!line.text.empty()) {
+                ctx->drawText(drawX, drawY, line.text.c_str(), properties->scale, properties->color);
+            }
+            drawY += lineHeight;
+        }
     }
 
     void onUpdate(float delta) override {}
@@ -106,12 +116,31 @@ public:
         bounds = rect;
     }
 
-    TextProperties properties;
+    const TextProperties& getProps() const { return *properties; }
+
+    // Copy-on-write, see Container. The lines are re-broken if the text or its style changed.
+    TextProperties& editProps() { return editProperties(properties); }
+
+    void setText(std::string text) {
+        editProps().text = std::move(text);
+    }
 
 protected:
-    Rect bounds;      // The size of the widget box
-    Rect contentSize; // The actual size of the text glyphs
+    // The cache is allocated on the first layout, a text that is never laid out has none
+    const TextLayoutResult& breakLines(const FontMetrics& metrics, float maxWidth) {
+        if (!lineCache) lineCache = std::make_unique<TextLayoutCache>();
+
+        TextLayoutParams params;
+        params.scale = properties->scale;
+        params.maxWidth = properties->softWrap ? maxWidth : INFINITY;
+        params.maxLines = properties->maxLines;
+        params.ellipsis = properties->ellipsis;
+        return lineCache->get(metrics, properties->text, params);
+    }
+
+    std::shared_ptr<const TextProperties> properties;
+    std::unique_ptr<TextLayoutCache> lineCache;
 };
 
 #define Text(...) \
-    std::make_shared<D_Text>(TextProperties{__VA_ARGS__})
+    WidgetArena::make<D_Text>(TextProperties{__VA_ARGS__})
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "InternalDrawable.h"
+#include "hmui/graphics/text/TextLayout.h"
+
+// ==========================================
+// 1. The Line Store
+// ==========================================
+
+// Append-only text storage for logs and chat. Lines are packed into fixed-size chunks
+// (one byte buffer + end offsets per chunk), so ten thousand lines cost a few dozen
+// allocations instead of one std::string each, and appending never moves old lines.
+class TextBuffer {
+public:
+    static constexpr size_t CHUNK_LINES = 512;
+
+    // Appends text, every '\n' starts a new line
+    void append(std::string_view text) {
+        size_t pos = 0;
+        while (true) {
+            size_t end = text.find('\n', pos);
+            appendLine(text.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos));
+            if (end == std::string_view::npos) break;
+            pos = end + 1;
+        }
+    }
+
+    void appendLine(std::string_view line) {
+        if (chunks.empty() || chunks.back().ends.size() >= CHUNK_LINES) {
+            chunks.emplace_back();
+            chunks.back().ends.reserve(CHUNK_LINES);
+        }
+
+        Chunk& chunk = chunks.back();
+        chunk.bytes.append(line);
+        chunk.ends.push_back(static_cast<uint32_t>(chunk.bytes.size()));
+        ++count;
+    }
+
+    void clear() {
+        chunks.clear();
+        count = 0;
+        ++generation;
+    }
+
+    std::string_view line(size_t index) const {
+        const Chunk& chunk = chunks[index / CHUNK_LINES];
+        size_t i = index % CHUNK_LINES;
+        uint32_t start = i == 0 ? 0 : chunk.ends[i - 1];
+        return std::string_view(chunk.bytes).substr(start, chunk.ends[i] - start);
+    }
+
+    size_t lineCount() const { return count; }
+
+    // Bumped by clear(), lets views drop their per-line measurements
+    uint64_t getGeneration() const { return generation; }
+
+private:
+    struct Chunk {
+        std::string bytes;
+        std::vector<uint32_t> ends;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t count = 0;
+    uint64_t generation = 0;
+};
+
+// Fenwick tree over line heights: O(log n) append, prefix sum and "which line is at y".
+class LineHeightIndex {
+public:
+    void clear() {
+        heights.clear();
+        tree.assign(1, 0.0);
+    }
+
+    void append(float height) {
+        heights.push_back(height);
+        size_t i = heights.size();
+        // Node i covers (i - lowbit(i), i]: the new height plus the already known lines before it
+        tree.push_back(height + prefix(i - 1) - prefix(i - (i & (~i + 1))));
+    }
+
+    // Rebuilds every height in O(n), used when the wrap width changes
+    template <typename Fn>
+    void rebuild(Fn&& heightOf) {
+        size_t n = heights.size();
+        tree.assign(n + 1, 0.0);
+        for (size_t i = 1; i <= n; ++i) {
+            heights[i - 1] = heightOf(i - 1);
+            tree[i] += heights[i - 1];
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= n) tree[parent] += tree[i];
+        }
+    }
+
+    // Sum of the first `lines` heights, i.e. the y of line `lines`
+    double prefix(size_t lines) const {
+        double sum = 0.0;
+        for (size_t i = lines; i > 0; i -= (i & (~i + 1))) sum += tree[i];
+        return sum;
+    }
+
+    // Index of the line containing y (clamped to the last line)
+    size_t lineAt(double y) const {
+        size_t pos = 0;
+        size_t step = 1;
+        while (step * 2 <= heights.size()) step *= 2;
+
+        for (; step > 0; step /= 2) {
+            if (pos + step <= heights.size() && tree[pos + step] <= y) {
+                pos += step;
+                y -= tree[pos];
+            }
+        }
+        return std::min(pos, heights.empty() ? 0 : heights.size() - 1);
+    }
+
+    float height(size_t line) const { return heights[line]; }
+    size_t size() const { return heights.size(); }
+    double total() const { return prefix(heights.size()); }
+
+private:
+    std::vector<float> heights;
+    std::vector<double> tree = std::vector<double>(1, 0.0);
+};
+
+// ==========================================
+// 2. The TextView Widget
+// ==========================================
+
+struct TextViewProperties {
+    std::shared_ptr<TextBuffer> buffer = nullptr;
+    float scale = 1.0f;
+    Color2D color = Color2D(1.0f, 1.0f, 1.0f, 1.0f);
+    bool softWrap = false; // Wrapping makes a width change re-measure every line once
+};
+
+// Displays a TextBuffer without creating a widget per line. Only new lines are measured
+// during layout and only the lines inside the current clip rect are painted, so both stay
+// proportional to what is on screen. Put it in Scrollable(.stickToEnd = true) to follow
+// the newest line.
+class D_TextView : public InternalDrawable {
+public:
+    explicit D_TextView(TextViewProperties properties)
+        : properties(std::move(properties)) {}
+
+    void init() override {
+        if (!properties.buffer) {
+            properties.buffer = std::make_shared<TextBuffer>();
+        }
+    }
+
+    void layout(BoxConstraints constraints) override {
+        const FontMetrics& metrics = *hmui()->getFontMetrics();
+        const TextBuffer& buffer = *properties.buffer;
+        float wrapWidth = properties.softWrap ? constraints.maxWidth : INFINITY;
+
+        if (buffer.getGeneration() != generation) {
+            generation = buffer.getGeneration();
+            index.clear();
+            widestLine = 0.0f;
+        }
+
+        if (wrapWidth != measuredWidth) {
+            measuredWidth = wrapWidth;
+            index.rebuild([&](size_t line) { return measureLine(metrics, buffer.line(line)); });
+        }
+
+        // Appends: measure just the new lines
+        for (size_t line = index.size(); line < buffer.lineCount(); ++line) {
+            index.append(measureLine(metrics, buffer.line(line)));
+        }
+
+        float contentW = properties.softWrap ? constraints.maxWidth : widestLine;
+        if (contentW == INFINITY) contentW = widestLine;
+
+        bounds.width = std::clamp(contentW, constraints.minWidth, constraints.maxWidth);
+        bounds.height = std::clamp((float) index.total(), constraints.minHeight, constraints.maxHeight);
+    }
+
+    void onDraw(GraphicsContext* ctx, float x, float y) override {
+        if (index.size() == 0) return;
+
+        Rect clip = ctx->getClipRect().intersect(Rect(x, y, bounds.width, bounds.height));
+        if (clip.width <= 0.0f || clip.height <= 0.0f) return;
+
+        const TextBuffer& buffer = *properties.buffer;
+        const FontMetrics& metrics = *ctx->getFontMetrics();
+        float lineHeight = metrics.getLineHeight() * properties.scale;
+
+        size_t first = index.lineAt(clip.y - y);
+        double lineY = index.prefix(first);
+        double bottom = clip.y + clip.height - y;
+
+        for (size_t line = first; line < index.size() && lineY < bottom; ++line) {
+            std::string_view text = buffer.line(line);
+
+            if (properties.softWrap) {
+                TextLayoutParams params;
+                params.scale = properties.scale;
+                params.maxWidth = bounds.width;
+                TextLayout::breakLines(metrics, text, params, wrapped);
+
+                float rowY = y + (float) lineY;
+                for (const auto& row : wrapped.lines) {
+                    if (!row.text.empty()) {
+                        ctx->drawText(x, rowY, row.text.c_str(), properties.scale, properties.color);
+                    }
+                    rowY += lineHeight;
+                }
+            } else if (!text.empty()) {
+                // drawText needs a terminated string
+                scratch.assign(text);
+                ctx->drawText(x, y + (float) lineY, scratch.c_str(), properties.scale, properties.color);
+            }
+
+            lineY += index.height(line);
+        }
+    }
+
+    Rect getBounds() const override { return bounds; }
+    void setBounds(const Rect& rect) override { bounds = rect; }
+
+    const std::shared_ptr<TextBuffer>& getBuffer() const { return properties.buffer; }
+
+protected:
+    float measureLine(const FontMetrics& metrics, std::string_view text) {
+        float lineHeight = metrics.getLineHeight() * properties.scale;
+
+        if (!properties.softWrap || measuredWidth == INFINITY) {
+            widestLine = std::max(widestLine, metrics.measure(text, properties.scale).width);
+            return lineHeight;
+        }
+
+        TextLayoutParams params;
+        params.scale = properties.scale;
+        params.maxWidth = measuredWidth;
+        TextLayout::breakLines(metrics, text, params, wrapped);
+        return std::max(1.0f, (float) wrapped.lines.size()) * lineHeight;
+    }
+
+    TextViewProperties properties;
+
+    LineHeightIndex index;
+    uint64_t generation = 0;
+    float measuredWidth = -1.0f;
+    float widestLine = 0.0f;
+
+    TextLayoutResult wrapped; // Scratch, reused for every wrapped line
+    std::string scratch;
+};
+
+#define TextView(...) WidgetArena::make<D_TextView>(TextViewProperties{__VA_ARGS__})
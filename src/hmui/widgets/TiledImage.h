@@ -0,0 +1,375 @@
+#pragma once
+
+#include "hmui/widgets/InternalDrawable.h"
+#include "hmui/graphics/TileSource.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct TiledImageProperties {
+    std::shared_ptr<TileSource> source = nullptr;
+
+    float width = 0;   // explicit width (0 = fill the available space)
+    float height = 0;  // explicit height (0 = fill the available space)
+
+    float zoom = 0.0f;      // Initial zoom (screen px per image px), 0 = fit the whole image
+    float minZoom = 0.0f;   // 0 = the fit zoom
+    float maxZoom = 4.0f;
+    bool interactive = true; // Drag to pan, mouse wheel to zoom around the cursor
+
+    size_t cacheTiles = 96;     // Resident tiles kept around (LRU) beyond the visible ones
+    int maxLoadsPerFrame = 4;   // Decodes started and uploads per frame, missing tiles show a coarser level meanwhile
+
+    Color2D color = Color2D(1.0f, 1.0f, 1.0f, 1.0f); // Tint color
+};
+
+// Shows a TileSource through a pannable, zoomable viewport. Only the tiles of the level
+// matching the current zoom that intersect the clip rect are requested. A requested tile
+// is prefetched (decoded off the UI thread) and uploaded once it is ready, at most
+// maxLoadsPerFrame of each per frame; until then the best resident coarser tile is
+// stretched in its place. Pan and zoom are plain state, nothing is rebuilt.
+class D_TiledImage : public InternalDrawable {
+public:
+    explicit D_TiledImage(TiledImageProperties properties)
+        : properties(std::move(properties)) {}
+
+    void init() override {
+        if (!properties.source) {
+            throw std::runtime_error("TiledImage must have a valid TileSource");
+        }
+        zoom = properties.zoom;
+    }
+
+    void layout(BoxConstraints constraints) override {
+        float targetW = properties.width > 0 ? properties.width : constraints.maxWidth;
+        float targetH = properties.height > 0 ? properties.height : constraints.maxHeight;
+
+        // Unbounded (e.g. inside a Scrollable): fall back to the image size
+        if (targetW == INFINITY) targetW = (float) properties.source->getWidth();
+        if (targetH == INFINITY) targetH = (float) properties.source->getHeight();
+
+        bounds.width = std::clamp(targetW, constraints.minWidth, constraints.maxWidth);
+        bounds.height = std::clamp(targetH, constraints.minHeight, constraints.maxHeight);
+
+        if (zoom <= 0.0f) {
+            zoom = fitZoom();
+            centerOn(properties.source->getWidth() * 0.5f, properties.source->getHeight() * 0.5f);
+        }
+        clampView();
+    }
+
+    void onDraw(GraphicsContext* ctx, float x, float y) override {
+        absoluteRect = Rect(x, y, bounds.width, bounds.height);
+        if (bounds.width <= 0.0f || bounds.height <= 0.0f || zoom <= 0.0f) return;
+
+        ctx->setScissor(absoluteRect);
+        Rect clip = ctx->getClipRect();
+
+        if (clip.width > 0.0f && clip.height > 0.0f) {
+            drawTiles(ctx, x, y, clip);
+        }
+
+        ctx->clearScissor();
+    }
+
+    void onUpdate(float delta) override {
+        if (properties.interactive) {
+            handleInput();
+        }
+
+        // Decode and upload what the last draw asked for, nearest to the view center first
+        std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+            return a.distance < b.distance;
+        });
+
+        int decodes = properties.maxLoadsPerFrame;
+        int uploads = properties.maxLoadsPerFrame;
+        for (const auto& request : requests) {
+            if (decodes <= 0 && uploads <= 0) break;
+
+            Tile& tile = acquire(request.key);
+            if (tile.image || tile.failed || !tile.provider) continue;
+
+            if (!tile.prefetched) {
+                if (decodes <= 0) continue;
+                tile.provider->prefetch();
+                tile.prefetched = true;
+                decodes--;
+            }
+
+            // Only uploads, load() would block on a decode that has not finished
+            if (uploads > 0 && tile.provider->isReady()) {
+                tile.image = tile.provider->load();
+                tile.failed = tile.image == nullptr;
+                uploads--;
+            }
+        }
+        requests.clear();
+
+        evict();
+    }
+
+    void dispose() override {
+        for (auto& [key, tile] : tiles) {
+            if (tile.image && tile.provider) tile.provider->dispose();
+        }
+        tiles.clear();
+        lru.clear();
+        requests.clear();
+    }
+
+    Rect getBounds() const override {
+        return bounds;
+    }
+
+    void setBounds(const Rect& rect) override {
+        bounds = rect;
+    }
+
+    // View control, e.g. for gamepad input or a minimap
+
+    float getZoom() const { return zoom; }
+
+    void setZoom(float newZoom) {
+        zoomAt(newZoom / zoom, bounds.width * 0.5f, bounds.height * 0.5f);
+    }
+
+    // Keeps the image point under (localX, localY) fixed
+    void zoomAt(float factor, float localX, float localY) {
+        float imageX = viewX + localX / zoom;
+        float imageY = viewY + localY / zoom;
+
+        zoom = std::clamp(zoom * factor, minZoom(), properties.maxZoom);
+
+        viewX = imageX - localX / zoom;
+        viewY = imageY - localY / zoom;
+        clampView();
+    }
+
+    void panBy(float dx, float dy) {
+        viewX -= dx / zoom;
+        viewY -= dy / zoom;
+        clampView();
+    }
+
+    // Centers the view on an image point (full-resolution pixels)
+    void centerOn(float imageX, float imageY) {
+        viewX = imageX - bounds.width * 0.5f / zoom;
+        viewY = imageY - bounds.height * 0.5f / zoom;
+        clampView();
+    }
+
+    size_t getResidentTileCount() const {
+        size_t count = 0;
+        for (const auto& [key, tile] : tiles) {
+            if (tile.image) count++;
+        }
+        return count;
+    }
+
+protected:
+    struct Tile {
+        std::shared_ptr<ImageProvider> provider;
+        ImageHandle* image = nullptr;
+        bool failed = false; // Missing or undecodable, not retried until evicted
+        bool prefetched = false;
+        std::list<uint64_t>::iterator lruPos;
+        uint64_t lastFrame = 0;
+    };
+
+    struct Request {
+        uint64_t key;
+        float distance;
+    };
+
+    static uint64_t tileKey(int level, int column, int row) {
+        return ((uint64_t) level << 48) | ((uint64_t) (uint32_t) row << 24) | (uint64_t) (uint32_t) column;
+    }
+
+    float fitZoom() const {
+        float w = (float) properties.source->getWidth();
+        float h = (float) properties.source->getHeight();
+        if (w <= 0.0f || h <= 0.0f) return 1.0f;
+        return std::min(bounds.width / w, bounds.height / h);
+    }
+
+    float minZoom() const {
+        return properties.minZoom > 0.0f ? properties.minZoom : fitZoom();
+    }
+
+    // Keeps the image on screen: centered along an axis where it is smaller than the view
+    void clampView() {
+        float w = (float) properties.source->getWidth();
+        float h = (float) properties.source->getHeight();
+        float viewW = bounds.width / zoom;
+        float viewH = bounds.height / zoom;
+
+        viewX = viewW >= w ? (w - viewW) * 0.5f : std::clamp(viewX, 0.0f, w - viewW);
+        viewY = viewH >= h ? (h - viewH) * 0.5f : std::clamp(viewY, 0.0f, h - viewH);
+    }
+
+    // The coarsest level that still has at least one texel per screen pixel
+    int levelForZoom() const {
+        int levels = properties.source->getLevelCount();
+        int level = zoom >= 1.0f ? 0 : (int) std::floor(std::log2(1.0f / zoom));
+        return std::clamp(level, 0, levels - 1);
+    }
+
+    void drawTiles(GraphicsContext* ctx, float x, float y, const Rect& clip) {
+        TileSource& source = *properties.source;
+        int level = levelForZoom();
+        float span = (float) (source.getTileSize() << level); // Full-res pixels per tile
+
+        // Visible part of the image, in full-resolution pixels
+        float left = viewX + (clip.x - x) / zoom;
+        float top = viewY + (clip.y - y) / zoom;
+        float right = viewX + (clip.x + clip.width - x) / zoom;
+        float bottom = viewY + (clip.y + clip.height - y) / zoom;
+
+        int col0 = std::max(0, (int) std::floor(left / span));
+        int row0 = std::max(0, (int) std::floor(top / span));
+        int col1 = std::min(source.getColumns(level) - 1, (int) std::floor(right / span));
+        int row1 = std::min(source.getRows(level) - 1, (int) std::floor(bottom / span));
+
+        float centerX = (left + right) * 0.5f;
+        float centerY = (top + bottom) * 0.5f;
+        frame++;
+
+        for (int row = row0; row <= row1; ++row) {
+            for (int col = col0; col <= col1; ++col) {
+                float srcX = col * span;
+                float srcY = row * span;
+                float srcW = std::min(span, source.getWidth() - srcX);
+                float srcH = std::min(span, source.getHeight() - srcY);
+
+                Rect dst(x + (srcX - viewX) * zoom, y + (srcY - viewY) * zoom, srcW * zoom, srcH * zoom);
+
+                uint64_t key = tileKey(level, col, row);
+                auto it = tiles.find(key);
+                if (it != tiles.end() && it->second.image) {
+                    touch(it->second);
+                    ctx->drawImage(dst, it->second.image, properties.color);
+                    continue;
+                }
+
+                drawFallback(ctx, level, srcX, srcY, srcW, srcH, dst);
+                if (it != tiles.end() && (it->second.failed || !it->second.provider)) continue;
+
+                float dx = srcX + srcW * 0.5f - centerX;
+                float dy = srcY + srcH * 0.5f - centerY;
+                requests.push_back({key, dx * dx + dy * dy});
+            }
+        }
+    }
+
+    // Stretches the closest resident coarser tile over a missing one
+    void drawFallback(GraphicsContext* ctx, int level, float srcX, float srcY, float srcW, float srcH, const Rect& dst) {
+        TileSource& source = *properties.source;
+
+        for (int coarse = level + 1; coarse < source.getLevelCount(); ++coarse) {
+            float span = (float) (source.getTileSize() << coarse);
+            int col = (int) (srcX / span);
+            int row = (int) (srcY / span);
+
+            auto it = tiles.find(tileKey(coarse, col, row));
+            if (it == tiles.end() || !it->second.image) continue;
+
+            // Where our region lies inside that tile's texture
+            ImageHandle* image = it->second.image;
+            float texelsPerPixel = (float) image->width / std::min(span, source.getWidth() - col * span);
+
+            Rect src((srcX - col * span) * texelsPerPixel, (srcY - row * span) * texelsPerPixel,
+                     srcW * texelsPerPixel, srcH * texelsPerPixel);
+
+            touch(it->second);
+            ctx->drawImageEx(dst, src, image, properties.color);
+            return;
+        }
+    }
+
+    Tile& acquire(uint64_t key) {
+        auto it = tiles.find(key);
+        if (it != tiles.end()) {
+            touch(it->second);
+            return it->second;
+        }
+
+        int level = (int) (key >> 48);
+        int row = (int) ((key >> 24) & 0xFFFFFF);
+        int col = (int) (key & 0xFFFFFF);
+
+        Tile& tile = tiles[key];
+        tile.provider = properties.source->getTile(level, col, row);
+        lru.push_front(key);
+        tile.lruPos = lru.begin();
+        tile.lastFrame = frame;
+        return tile;
+    }
+
+    void touch(Tile& tile) {
+        lru.splice(lru.begin(), lru, tile.lruPos);
+        tile.lastFrame = frame;
+    }
+
+    // Drops least recently used tiles over the budget, never one drawn this frame. Tiles still
+    // decoding are skipped: dropping their provider would wait for the decode to finish.
+    void evict() {
+        auto it = lru.end();
+        while (tiles.size() > properties.cacheTiles && it != lru.begin()) {
+            --it;
+            Tile& tile = tiles[*it];
+            if (tile.lastFrame == frame) break;
+            if (!tile.image && tile.provider && !tile.provider->isReady()) continue;
+
+            if (tile.image && tile.provider) tile.provider->dispose();
+            tiles.erase(*it);
+            it = lru.erase(it);
+        }
+    }
+
+    void handleInput() {
+        auto os = hmui()->getOSContext();
+        Coord mouse = os->getMousePosition();
+
+        bool hovering = mouse.x >= absoluteRect.x && mouse.x <= absoluteRect.x + absoluteRect.width &&
+                        mouse.y >= absoluteRect.y && mouse.y <= absoluteRect.y + absoluteRect.height;
+
+        bool down = os->isMouseButtonDown(0);
+        if (down && (dragging || hovering)) {
+            if (dragging) {
+                Coord d = os->getMouseDelta();
+                panBy(d.x, d.y);
+            }
+            dragging = true;
+        } else {
+            dragging = false;
+        }
+
+        if (hovering) {
+            float wheel = os->getMouseWheel().y;
+            if (wheel != 0.0f) {
+                zoomAt(std::pow(1.2f, wheel), mouse.x - absoluteRect.x, mouse.y - absoluteRect.y);
+            }
+        }
+    }
+
+    TiledImageProperties properties;
+    Rect absoluteRect;
+
+    // View: the image point at the widget's top-left corner, and screen px per image px
+    float viewX = 0.0f;
+    float viewY = 0.0f;
+    float zoom = 0.0f;
+    bool dragging = false;
+
+    std::unordered_map<uint64_t, Tile> tiles;
+    std::list<uint64_t> lru; // Most recently used first
+    std::vector<Request> requests;
+    uint64_t frame = 0;
+};
+
+#define TiledImage(...) WidgetArena::make<D_TiledImage>(TiledImageProperties{__VA_ARGS__})
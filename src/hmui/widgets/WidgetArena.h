@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "hmui/util/SlicedTask.h"
+
+// Monotonic arena a route's widget tree is allocated from. While a WidgetArena::Scope is
+// active, the widget macros place each widget together with its shared_ptr control block in
+// the scope's arena, so a route is a handful of contiguous blocks instead of hundreds of
+// scattered heap allocations. Nothing is freed individually: the arena counts its owners and
+// its live allocations, and the blocks are released at once when both are gone, i.e. when
+// the route is popped and nothing outside still points into it.
+// Allocation is single-threaded, the arena is only filled while building on the UI thread.
+class WidgetArena {
+public:
+    static std::shared_ptr<WidgetArena> create(size_t blockSize = 16 * 1024) {
+        return std::shared_ptr<WidgetArena>(new WidgetArena(blockSize), [](WidgetArena* arena) { arena->release(); });
+    }
+
+    WidgetArena(const WidgetArena&) = delete;
+    WidgetArena& operator=(const WidgetArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment) {
+        uintptr_t aligned = (cursor + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        if (cursor == 0 || aligned + size > end) {
+            grow(size + alignment);
+            aligned = (cursor + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        }
+
+        cursor = aligned + size;
+        bytesUsed += size;
+        allocations++;
+        references.fetch_add(1, std::memory_order_relaxed);
+        return (void*) aligned;
+    }
+
+    // The memory stays where it is until the whole arena goes
+    void deallocate(void*) {
+        release();
+    }
+
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getBytesReserved() const { return bytesReserved; }
+    size_t getAllocationCount() const { return allocations; }
+    size_t getBlockCount() const { return blocks.size(); }
+
+    // Arenas alive in the process and the block memory they hold, to check that popped
+    // routes give theirs back
+    static size_t getLiveCount() {
+        return liveCount.load(std::memory_order_relaxed);
+    }
+
+    static size_t getLiveBytesReserved() {
+        return liveBytesReserved.load(std::memory_order_relaxed);
+    }
+
+    // The arena widgets are currently allocated from on this thread, null outside of a Scope
+    static const std::shared_ptr<WidgetArena>& current() {
+        return currentArena;
+    }
+
+    // Makes an arena current on this thread for its lifetime. Scopes nest; one opened while
+    // another is active keeps allocating from the outer arena unless given its own.
+    class Scope {
+    public:
+        Scope() : Scope(currentArena ? currentArena : WidgetArena::create()) {}
+
+        explicit Scope(std::shared_ptr<WidgetArena> arena) : previous(std::move(currentArena)) {
+            currentArena = std::move(arena);
+        }
+
+        ~Scope() {
+            currentArena = std::move(previous);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        const std::shared_ptr<WidgetArena>& arena() const { return currentArena; }
+
+    private:
+        std::shared_ptr<WidgetArena> previous;
+    };
+
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> make(Args&&... args);
+
+    // make() for what a widget points to rather than the widget itself (its shared
+    // properties). No checkpoint, it is called from inside widget constructors.
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> makeShared(Args&&... args);
+
+private:
+    static constexpr size_t MAX_BLOCK_SIZE = 256 * 1024;
+
+    explicit WidgetArena(size_t blockSize) : nextBlockSize(blockSize) {
+        liveCount++;
+    }
+
+    ~WidgetArena() {
+        for (auto* block : blocks) {
+            ::operator delete(block);
+        }
+        liveCount--;
+        liveBytesReserved -= bytesReserved;
+    }
+
+    // The last widget can die on any thread
+    void release() {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    void grow(size_t minimum) {
+        size_t size = std::max(nextBlockSize, minimum);
+        nextBlockSize = std::min(nextBlockSize * 2, MAX_BLOCK_SIZE);
+
+        auto* block = static_cast<uint8_t*>(::operator new(size));
+        blocks.push_back(block);
+        bytesReserved += size;
+        liveBytesReserved += size;
+
+        cursor = (uintptr_t) block;
+        end = cursor + size;
+    }
+
+    std::vector<uint8_t*> blocks;
+    uintptr_t cursor = 0;
+    uintptr_t end = 0;
+    size_t nextBlockSize;
+
+    size_t bytesUsed = 0;
+    size_t bytesReserved = 0;
+    size_t allocations = 0;
+    std::atomic<size_t> references{1}; // The shared_ptr owners, as one, and each allocation
+
+    static inline thread_local std::shared_ptr<WidgetArena> currentArena;
+    static inline std::atomic<size_t> liveCount{0};
+    static inline std::atomic<size_t> liveBytesReserved{0};
+};
+
+// Allocator handed to std::allocate_shared. The copies std::allocate_shared makes of it are
+// plain pointers; what keeps the arena alive is the allocation itself, until deallocate().
+template<typename T>
+struct WidgetArenaAllocator {
+    using value_type = T;
+
+    WidgetArena* arena;
+
+    explicit WidgetArenaAllocator(WidgetArena* arena) : arena(arena) {}
+
+    template<typename U>
+    WidgetArenaAllocator(const WidgetArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        arena->deallocate(p);
+    }
+
+    template<typename U>
+    bool operator==(const WidgetArenaAllocator<U>& other) const { return arena == other.arena; }
+};
+
+// make_shared that uses the current arena if there is one
+template<typename T, typename... Args>
+std::shared_ptr<T> WidgetArena::make(Args&&... args) {
+    SlicedTask::checkpoint(); // A prewarm builds routes a slice at a time
+    return makeShared<T>(std::forward<Args>(args)...);
+}
+
+template<typename T, typename... Args>
+std::shared_ptr<T> WidgetArena::makeShared(Args&&... args) {
+    if (currentArena) {
+        return std::allocate_shared<T>(WidgetArenaAllocator<T>(currentArena.get()), std::forward<Args>(args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "hmui/widgets/InternalDrawable.h"
+#include "hmui/widgets/Scrollable.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Row.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/Expanded.h"
+#include "hmui/widgets/FlexBox.h"
+#include "hmui/widgets/Wrap.h"
+#include "hmui/widgets/Stack.h"
+#include "hmui/widgets/GestureDetector.h"
+#include "hmui/widgets/Text.h"
+#include "hmui/widgets/TextView.h"
+#include "hmui/widgets/Image.h"
+#include "hmui/widgets/TiledImage.h"
+#include <cstddef>
+
+struct WidgetFootprint {
+    const char* name;
+    size_t size; // sizeof the node, excluding what it points to (children, text, caches)
+};
+
+// Per-node size of every built-in widget, to keep an eye on the memory of large trees.
+// With the arena, each node also carries a shared_ptr control block (16 bytes plus an
+// allocator reference) in front of it. Container, GestureDetector and Text point at their
+// properties instead of holding them, one block that widgets built alike can share.
+inline constexpr WidgetFootprint widgetFootprints[] = {
+    {"InternalDrawable", sizeof(InternalDrawable)},
+    {"Column", sizeof(D_Column)},
+    {"Row", sizeof(D_Row)},
+    {"Container", sizeof(D_Container)},
+    {"Expanded", sizeof(D_Expanded)},
+    {"FlexBox", sizeof(D_FlexBox)},
+    {"Wrap", sizeof(D_Wrap)},
+    {"Stack", sizeof(D_Stack)},
+    {"Positioned", sizeof(D_Positioned)},
+    {"GestureDetector", sizeof(D_GestureDetector)},
+    {"Scrollable", sizeof(D_Scrollable)},
+    {"Text", sizeof(D_Text)},
+    {"TextView", sizeof(D_TextView)},
+    {"Image", sizeof(D_Image)},
+    {"TiledImage", sizeof(D_TiledImage)},
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "hmui/widgets/InternalDrawable.h"
+#include "hmui/widgets/FrameArena.h"
+#include "hmui/layout/ParallelLayout.h"
+#include "hmui/graphics/ParallelPaint.h"
 #include <vector>
 #include <memory>
 #include <algorithm>
@@ -17,26 +20,39 @@ struct WrapProperties {
 
 class D_Wrap : public InternalDrawable {
 private:
+    // Children of a run are contiguous: [first, first + count)
     struct Run {
-        std::vector<size_t> childIndices;
+        size_t first = 0;
+        size_t count = 0;
         float mainAxisExtent = 0.0f;
         float crossAxisExtent = 0.0f;
     };
 
 public:
-    explicit D_Wrap(const WrapProperties& properties) 
-        : properties(properties) {};
+    explicit D_Wrap(WrapProperties properties) 
+        : properties(std::move(properties)) {};
 
     void init() override {
+        childWeights.clear();
+        subtreeSize = 1;
+
         for (const auto& child : properties.children) {
             child->init();
-            child->setParent(shared_from_this());
+            child->setParent(this);
+
+            auto weight = static_cast<uint32_t>(child->getSubtreeSize());
+            childWeights.push_back(weight);
+            subtreeSize += weight;
         }
     }
 
+    size_t getSubtreeSize() const override {
+        return subtreeSize;
+    }
+
     void layout(BoxConstraints constraints) override {
-        std::vector<Rect> childSizes(properties.children.size());
-        std::vector<Run> runs;
+        ScratchVector<Rect> childSizes(properties.children.size(), FrameArena::get());
+        ScratchVector<Run> runs(FrameArena::get());
         Run currentRun;
 
         bool isHoriz = (properties.direction == Direction::Horizontal);
@@ -45,30 +61,36 @@ public:
         // 1. Measure children and group into runs
         BoxConstraints looseConstraints = BoxConstraints::loose(constraints.maxWidth, constraints.maxHeight);
 
+        // Every child gets the same constraints, so they can be measured in parallel first
+        // and grouped afterwards, in order
+        // Note: Expanded is generally not supported in Wrap because wrap sizes intrinsicly.
+        ParallelLayout::forEach(properties.children.size(),
+            [this](size_t i) { return childWeights[i]; },
+            [this, &looseConstraints, &childSizes](size_t i) {
+                properties.children[i]->layout(looseConstraints);
+                childSizes[i] = properties.children[i]->getBounds();
+            });
+
         for (size_t i = 0; i < properties.children.size(); ++i) {
-            auto& child = properties.children[i];
-            
-            // Note: Expanded is generally not supported in Wrap because wrap sizes intrinsicly.
-            child->layout(looseConstraints);
-            Rect size = child->getBounds();
-            childSizes[i] = size;
+            Rect size = childSizes[i];
 
             float childMain = isHoriz ? size.width : size.height;
             float childCross = isHoriz ? size.height : size.width;
 
             // If adding this child exceeds the max size (and it's not the first child in the run), wrap!
-            if (!currentRun.childIndices.empty() && 
+            if (currentRun.count > 0 && 
                 (currentRun.mainAxisExtent + properties.spacing + childMain > maxMainExtent)) {
                 runs.push_back(currentRun);
                 currentRun = Run();
+                currentRun.first = i;
             }
 
-            currentRun.childIndices.push_back(i);
-            currentRun.mainAxisExtent += childMain + (currentRun.childIndices.size() > 1 ? properties.spacing : 0);
+            currentRun.count++;
+            currentRun.mainAxisExtent += childMain + (currentRun.count > 1 ? properties.spacing : 0);
             currentRun.crossAxisExtent = std::max(currentRun.crossAxisExtent, childCross);
         }
 
-        if (!currentRun.childIndices.empty()) {
+        if (currentRun.count > 0) {
             runs.push_back(currentRun);
         }
 
@@ -103,16 +125,16 @@ public:
                     case MainAxisAlignment::END: currentMainOffset = freeMainSpace; break;
                     case MainAxisAlignment::CENTER: currentMainOffset = freeMainSpace / 2.0f; break;
                     case MainAxisAlignment::SPACE_BETWEEN:
-                        if (run.childIndices.size() > 1) spaceBetween += freeMainSpace / (run.childIndices.size() - 1);
+                        if (run.count > 1) spaceBetween += freeMainSpace / (run.count - 1);
                         break;
                     case MainAxisAlignment::SPACE_AROUND:
-                        spaceBetween += freeMainSpace / run.childIndices.size();
+                        spaceBetween += freeMainSpace / run.count;
                         currentMainOffset = spaceBetween / 2.0f;
                         break;
                 }
             }
 
-            for (size_t i : run.childIndices) {
+            for (size_t i = run.first; i < run.first + run.count; ++i) {
                 Rect size = childSizes[i];
                 float childCross = isHoriz ? size.height : size.width;
                 float childMain = isHoriz ? size.width : size.height;
@@ -142,10 +164,12 @@ public:
     }
 
     void onDraw(GraphicsContext* ctx, float x, float y) override {
-        for (const auto& child : properties.children) {
-            Rect p = child->getBounds();
-            child->onDraw(ctx, x + p.x, y + p.y);
-        }
+        ParallelPaint::forEach(ctx, properties.children.size(),
+            [this](size_t i) { return childWeights[i]; },
+            [this, x, y](size_t i, GraphicsContext* target) {
+                Rect p = properties.children[i]->getBounds();
+                properties.children[i]->onDraw(target, x + p.x, y + p.y);
+            });
     }
 
     void onUpdate(float delta) override {
@@ -158,7 +182,8 @@ public:
 
 protected:
     WrapProperties properties;
-    Rect bounds;
+    std::vector<uint32_t> childWeights; // Subtree sizes, resolved in init()
+    size_t subtreeSize = 1;
 };
 
-#define Wrap(...) std::make_shared<D_Wrap>(WrapProperties{__VA_ARGS__})
\ No newline at end of file
+#define Wrap(...) WidgetArena::make<D_Wrap>(WrapProperties{__VA_ARGS__})
\ No newline at end of file
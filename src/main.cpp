@@ -1,39 +1,84 @@
 #include "hmui/HMUI.h"
+#include "hmui/FramePipeline.h"
 #include "hmui/os/RayOSContext.h"
+#include "hmui/os/SnapshotOSContext.h"
 #include "raylib.h"
 #include "rlImGui.h"
 #include <imgui.h>
+#include <cstring>
+#include <memory>
 #include "hmui/demo/DemoView.h"
 #include "hmui/graphics/ImGuiGraphicsContext.h"
 
-int main() {
+static void beginDebugWindow() {
+    ImGui::SetNextWindowSize(ImVec2(GetScreenWidth(), GetScreenHeight()), ImGuiCond_Always);
+    ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
+    ImGui::Begin("HMUI Debug Window", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+}
+
+// --serial runs update, layout, paint and submission one after the other on this thread.
+// By default the UI is built on its own thread, one frame ahead of submission (FramePipeline).
+int main(int argc, char** argv) {
+    bool serial = argc > 1 && std::strcmp(argv[1], "--serial") == 0;
+
     std::shared_ptr<HMUI> hmui = std::make_shared<HMUI>();
     InitWindow(800, 600, "HMUI Demo");
     SetTargetFPS(60);
 
-    hmui->initialize(std::make_shared<ImGuiGraphicsContext>(), std::make_shared<RayOSContext>());
-    hmui->show(std::make_shared<DemoView>());
+    // Pipelined, the UI thread reads input from a per-frame copy instead of raylib itself
+    auto input = std::make_shared<SnapshotOSContext>(std::make_shared<RayOSContext>());
+    std::shared_ptr<OSContext> os = serial ? std::make_shared<RayOSContext>() : std::shared_ptr<OSContext>(input);
+    // rlImGui renders through raylib, which has the blend mode prebaked pack textures need
+    auto setPremultipliedBlend = [](bool premultiplied) {
+        if (premultiplied) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+        else EndBlendMode();
+    };
+    hmui->initialize(std::make_shared<ImGuiGraphicsContext>(rlImGuiReloadFonts, setPremultipliedBlend), os);
+    hmui->setRouter(std::make_shared<DemoView>());
 
     SetWindowState(FLAG_WINDOW_RESIZABLE);
-    
+
     rlImGuiSetup(false);
-    while (!WindowShouldClose()) {
-        hmui->update(GetFrameTime());
-
-        BeginDrawing();
-        ClearBackground(RAYWHITE);
-
-        rlImGuiBegin();
-        ImGui::SetNextWindowSize(ImVec2(GetScreenWidth(), GetScreenHeight()), ImGuiCond_Always);
-        ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
-        ImGui::Begin("HMUI Debug Window", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
-        auto ctx = GfxList { (void*) ImGui::GetWindowDrawList() };
-        hmui->draw(&ctx, GetScreenWidth(), GetScreenHeight());
-        ImGui::End();
-        rlImGuiEnd();
-
-        EndDrawing();
+
+    if (serial) {
+        while (!WindowShouldClose()) {
+            hmui->update(GetFrameTime());
+
+            BeginDrawing();
+            ClearBackground(RAYWHITE);
+
+            rlImGuiBegin();
+            beginDebugWindow();
+            auto ctx = GfxList { (void*) ImGui::GetWindowDrawList() };
+            hmui->draw(&ctx, GetScreenWidth(), GetScreenHeight());
+            ImGui::End();
+            rlImGuiEnd();
+
+            EndDrawing();
+        }
+    } else {
+        FramePipeline pipeline(*hmui, input);
+
+        while (!WindowShouldClose()) {
+            pipeline.beginFrame(GetFrameTime(), GetScreenWidth(), GetScreenHeight());
+            hmui->prepareFrame();
+
+            BeginDrawing();
+            ClearBackground(RAYWHITE);
+
+            rlImGuiBegin();
+            beginDebugWindow();
+            auto ctx = GfxList { (void*) ImGui::GetWindowDrawList() };
+            pipeline.submit(&ctx);
+            ImGui::End();
+            rlImGuiEnd();
+
+            EndDrawing();
+            pipeline.endFrame();
+        }
     }
+
+    hmui->close();
     CloseWindow();
 
     return 0;
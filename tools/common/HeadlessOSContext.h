@@ -0,0 +1,30 @@
+#pragma once
+
+#include "hmui/os/OSContext.h"
+
+// A window that never gets any input, for running HMUI headless in the tools. Override what
+// a check needs to observe or feed.
+class HeadlessOSContext : public OSContext {
+public:
+    void init() override {}
+    void update() override {}
+    void dispose() override {}
+
+    Coord getMouseDelta() override { return Coord(); }
+    Coord getMousePosition() override { return Coord(); }
+    void setMousePosition(Coord&) override {}
+    Coord getMouseWheel() override { return Coord(); }
+    bool isMouseButtonPressed(int) override { return false; }
+    bool isMouseButtonReleased(int) override { return false; }
+    bool isMouseButtonDown(int) override { return false; }
+    void setMouseCursor(int) override {}
+    bool isTouchDevice() override { return false; }
+    bool isTouchActive() override { return false; }
+    void setClipboardText(const char*) override {}
+    const char* getClipboardText() override { return ""; }
+    void showCursor(bool) override {}
+    bool isGamepadAvailable(int) override { return false; }
+    bool isGamepadButtonPressed(int, ControllerButton) override { return false; }
+    bool IsKeyboardButtonPressed(int) override { return false; }
+    float getGamepadAxis(int, ControllerAxis) override { return 0.0f; }
+};
@@ -0,0 +1,292 @@
+// flatcheck: checks FlatLayout against the recursive layout() pass it replaces.
+//
+//   flatcheck [trees] [seed]
+//
+// Builds random trees of Column, Row, FlexBox, Container and Expanded, with Text and sized
+// Container leaves, twice from the same seed. One copy is laid out by an HMUI with
+// setFlatLayout(true), the other by one running the recursive layout(). Every node's bounds
+// must match after the first frame and after each of a few in-place changes, made the same
+// way to both copies:
+// - a Container's size, padding, margin or alignment changed through editProps()
+// - a Container's child swapped for a freshly built subtree, or removed
+// The window size changes between frames too. Build with -fsanitize=address to also catch
+// FlatLayout holding on to nodes a swap freed.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hmui/HMUI.h"
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/Expanded.h"
+#include "hmui/widgets/Row.h"
+#include "hmui/widgets/Scrollable.h"
+#include "hmui/widgets/FlexBox.h"
+#include "hmui/widgets/Text.h"
+#include "../common/HeadlessOSContext.h"
+
+namespace {
+
+const int MAX_DEPTH = 6;
+const int EDITS = 8;
+
+class TreeBuilder {
+public:
+    explicit TreeBuilder(uint32_t seed) : rng(seed) {}
+
+    std::shared_ptr<InternalDrawable> node(int depth) {
+        if (depth >= MAX_DEPTH || pick(5) == 0) return leaf();
+
+        switch (pick(5)) {
+            case 0:
+                return Column(.mainAxisAlignment = mainAxis(), .crossAxisAlignment = crossAxis(),
+                              .children = children(depth));
+            case 1:
+                return Row(.mainAxisAlignment = mainAxis(), .crossAxisAlignment = crossAxis(),
+                           .children = children(depth));
+            case 2:
+                return FlexBox(.direction = pick(2) ? Direction::Horizontal : Direction::Vertical,
+                               .mainAxisAlignment = mainAxis(), .crossAxisAlignment = crossAxis(),
+                               .children = children(depth));
+            case 3: {
+                ContainerProperties properties = containerProperties();
+                properties.child = node(depth + 1);
+                return WidgetArena::make<D_Container>(std::move(properties));
+            }
+            default:
+                return Expanded(.flex = 1 + pick(3), .child = node(depth + 1));
+        }
+    }
+
+    ContainerProperties containerProperties() {
+        ContainerProperties properties;
+        if (pick(3) == 0) properties.width = size();
+        if (pick(3) == 0) properties.height = size();
+        if (pick(2) == 0) properties.padding = EdgeInsets(inset(), inset(), inset(), inset());
+        if (pick(3) == 0) properties.margin = EdgeInsets(inset(), inset(), inset(), inset());
+        properties.alignment = Alignment{ pick(3) * 0.5f, pick(3) * 0.5f };
+        return properties;
+    }
+
+    int pick(int n) {
+        return std::uniform_int_distribution<int>(0, n - 1)(rng);
+    }
+
+private:
+    ChildrenList children(int depth) {
+        ChildrenList list;
+        int count = pick(5);
+        for (int i = 0; i < count; ++i) list.push_back(node(depth + 1));
+        return list;
+    }
+
+    std::shared_ptr<InternalDrawable> leaf() {
+        if (pick(2) == 0) {
+            static const char* const words[] = { "a", "layout", "flat arrays", "the recursive pass" };
+            return Text(.text = words[pick(4)], .scale = pick(2) ? 1.0f : 2.0f);
+        }
+        return Container(.width = pick(4) ? size() : 0.0f, .height = pick(4) ? size() : 0.0f);
+    }
+
+    MainAxisAlignment mainAxis() { return static_cast<MainAxisAlignment>(pick(5)); }
+    CrossAxisAlignment crossAxis() { return static_cast<CrossAxisAlignment>(pick(3)); }
+    float size() { return (float) (8 + pick(200)); }
+    float inset() { return (float) pick(12); }
+
+    std::mt19937 rng;
+};
+
+// Every node in depth-first order, the way both engines see the tree
+void collect(InternalDrawable* node, std::vector<InternalDrawable*>& out) {
+    if (!node) return;
+    out.push_back(node);
+
+    switch (node->getLayoutKind()) {
+        case LayoutKind::Column:
+            for (const auto& child : static_cast<D_Column*>(node)->getChildren()) collect(child.get(), out);
+            break;
+        case LayoutKind::Row:
+            for (const auto& child : static_cast<D_Row*>(node)->getChildren()) collect(child.get(), out);
+            break;
+        case LayoutKind::Flex:
+            for (const auto& child : static_cast<D_FlexBox*>(node)->getProps().children) collect(child.get(), out);
+            break;
+        case LayoutKind::Container:
+            collect(static_cast<D_Container*>(node)->getChild().get(), out);
+            break;
+        case LayoutKind::Expanded:
+            collect(static_cast<D_Expanded*>(node)->getProps().child.get(), out);
+            break;
+        default:
+            break;
+    }
+}
+
+bool same(float a, float b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    if (std::isinf(a) || std::isinf(b)) return a == b;
+    return std::fabs(a - b) <= 0.01f + 1e-5f * std::fabs(a);
+}
+
+class Side {
+public:
+    explicit Side(bool flat) {
+        hmui = std::make_shared<HMUI>();
+        hmui->initialize(std::make_shared<RecordingGraphicsContext>(), std::make_shared<HeadlessOSContext>());
+        hmui->setFlatLayout(flat);
+    }
+
+    ~Side() {
+        hmui->close();
+    }
+
+    void show(std::shared_ptr<InternalDrawable> tree) {
+        root = tree;
+        hmui->setRouter(tree);
+    }
+
+    void frame(int width, int height) {
+        hmui->update(1.0f / 60.0f);
+        hmui->record(recorder, width, height);
+    }
+
+    std::vector<D_Container*> containers() {
+        std::vector<InternalDrawable*> nodes;
+        collect(root.get(), nodes);
+
+        std::vector<D_Container*> out;
+        for (auto* node : nodes) {
+            if (node->getLayoutKind() == LayoutKind::Container) out.push_back(static_cast<D_Container*>(node));
+        }
+        return out;
+    }
+
+    void swapChild(D_Container* container, std::shared_ptr<InternalDrawable> child) {
+        HMUI::Scope scope(hmui.get());
+        if (child) child->init();
+        if (container->getChild()) container->getChild()->dispose();
+        container->setChild(std::move(child));
+    }
+
+    std::shared_ptr<HMUI> hmui;
+    std::shared_ptr<InternalDrawable> root;
+
+private:
+    RecordingGraphicsContext recorder;
+};
+
+// Reports the first few differences, returns whether there were none
+bool compare(Side& flat, Side& recursive, int tree, const char* step) {
+    std::vector<InternalDrawable*> a, b;
+    collect(flat.root.get(), a);
+    collect(recursive.root.get(), b);
+    if (a.size() != b.size()) {
+        std::printf("tree %d, %s: %zu nodes against %zu\n", tree, step, a.size(), b.size());
+        return false;
+    }
+
+    int reported = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        Rect fa = a[i]->getBounds();
+        Rect rb = b[i]->getBounds();
+        if (same(fa.x, rb.x) && same(fa.y, rb.y) && same(fa.width, rb.width) && same(fa.height, rb.height)) continue;
+
+        if (reported++ < 3) {
+            std::printf("tree %d, %s: node %zu (kind %d) flat %.2f,%.2f %.2fx%.2f, recursive %.2f,%.2f %.2fx%.2f\n",
+                        tree, step, i, (int) a[i]->getLayoutKind(), fa.x, fa.y, fa.width, fa.height,
+                        rb.x, rb.y, rb.width, rb.height);
+        }
+    }
+    return reported == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int trees = argc > 1 ? std::atoi(argv[1]) : 300;
+    uint32_t seed = argc > 2 ? (uint32_t) std::strtoul(argv[2], nullptr, 10) : 1;
+
+    int mismatched = 0;
+    size_t nodes = 0;
+    int swaps = 0;
+    int edits = 0;
+
+    for (int tree = 0; tree < trees; ++tree) {
+        Side flat(true);
+        Side recursive(false);
+
+        uint32_t treeSeed = seed * 7919u + (uint32_t) tree;
+        flat.show(TreeBuilder(treeSeed).node(0));
+        recursive.show(TreeBuilder(treeSeed).node(0));
+
+        // Decides the window sizes and the changes, the same for both sides
+        TreeBuilder steps(treeSeed ^ 0x9e3779b9u);
+        auto frame = [&]() {
+            int width = 100 + steps.pick(1200);
+            int height = 100 + steps.pick(800);
+            flat.frame(width, height);
+            recursive.frame(width, height);
+        };
+
+        frame();
+        bool ok = compare(flat, recursive, tree, "first frame");
+        std::vector<InternalDrawable*> all;
+        collect(flat.root.get(), all);
+        nodes += all.size();
+
+        for (int step = 0; ok && step < EDITS; ++step) {
+            auto flatContainers = flat.containers();
+            auto recursiveContainers = recursive.containers();
+            if (flatContainers.empty()) break;
+
+            size_t index = (size_t) steps.pick((int) flatContainers.size());
+            const char* what;
+            switch (steps.pick(3)) {
+                case 0: {
+                    ContainerProperties changed = steps.containerProperties();
+                    for (D_Container* container : { flatContainers[index], recursiveContainers[index] }) {
+                        ContainerProperties& p = container->editProps();
+                        p.width = changed.width;
+                        p.height = changed.height;
+                        p.padding = changed.padding;
+                        p.margin = changed.margin;
+                        p.alignment = changed.alignment;
+                    }
+                    what = "after a property change";
+                    edits++;
+                    break;
+                }
+                case 1: {
+                    uint32_t childSeed = (uint32_t) steps.pick(1 << 30);
+                    flat.swapChild(flatContainers[index], TreeBuilder(childSeed).node(2));
+                    recursive.swapChild(recursiveContainers[index], TreeBuilder(childSeed).node(2));
+                    what = "after a child swap";
+                    swaps++;
+                    break;
+                }
+                default:
+                    flat.swapChild(flatContainers[index], nullptr);
+                    recursive.swapChild(recursiveContainers[index], nullptr);
+                    what = "after a child removal";
+                    swaps++;
+                    break;
+            }
+
+            frame();
+            ok = compare(flat, recursive, tree, what);
+        }
+
+        if (!ok) mismatched++;
+    }
+
+    std::printf("%d random trees, %zu nodes, %d property changes, %d child swaps or removals\n",
+                trees, nodes, edits, swaps);
+    std::printf("flat layout matches the recursive one: %s\n", mismatched == 0 ? "yes" : "NO");
+    return mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// framealloc: runs the demo UI without input and checks that, once it has settled, a frame
+// makes no heap allocations at all.
+//
+//   framealloc [warmup frames] [checked frames]
+//
+// Only meaningful in a build configured with HMUI_TRACK_ALLOCATIONS, which is what counts
+// allocations (HMUI::getFrameAllocations); without it the tool fails straight away. Images are
+// uploaded for real, so a hidden window is opened for the graphics context; the UI itself is
+// recorded, not drawn. Every checked frame must report zero allocations for update, layout
+// and paint together.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "raylib.h"
+#include "hmui/HMUI.h"
+#include "hmui/AllocationTracker.h"
+#include "hmui/demo/DemoView.h"
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "../common/HeadlessOSContext.h"
+
+int main(int argc, char** argv) {
+    int warmup = argc > 1 ? std::atoi(argv[1]) : 120;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 600;
+
+    if (!AllocationTracker::enabled()) {
+        std::printf("built without HMUI_TRACK_ALLOCATIONS, nothing is counted\n");
+        return 1;
+    }
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(800, 600, "framealloc");
+
+    auto hmui = std::make_shared<HMUI>();
+    hmui->initialize(std::make_shared<RecordingGraphicsContext>(), std::make_shared<HeadlessOSContext>());
+    hmui->setRouter(std::make_shared<DemoView>());
+
+    RecordingGraphicsContext recorder;
+    auto frame = [&]() {
+        hmui->update(1.0f / 60.0f);
+        hmui->record(recorder, 800, 600);
+        return hmui->getFrameAllocations();
+    };
+
+    size_t warmupMost = 0;
+    for (int i = 0; i < warmup; ++i) {
+        warmupMost = std::max(warmupMost, frame());
+    }
+
+    int allocating = 0;
+    size_t most = 0;
+    for (int i = 1; i <= frames; ++i) {
+        size_t allocations = frame();
+        if (allocations == 0) continue;
+
+        if (allocating++ < 5) std::printf("frame %d after warmup made %zu allocations\n", i, allocations);
+        most = std::max(most, allocations);
+    }
+
+    hmui->close();
+    CloseWindow();
+
+    std::printf("%d warmup frames, at most %zu allocations each\n", warmup, warmupMost);
+    std::printf("%d checked frames, %d allocating, at most %zu allocations each\n", frames, allocating, most);
+    std::printf("settled frames allocate nothing: %s\n", allocating == 0 ? "yes" : "NO");
+
+    return allocating == 0 ? 0 : 1;
+}
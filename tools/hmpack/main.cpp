@@ -0,0 +1,111 @@
+// hmpack: bakes a directory of images into a single AssetPack (see AssetPack.h).
+//
+//   hmpack <assets dir> <output.hmpk> [--straight] [--mipmaps]
+//
+// Every PNG/JPEG/QOI/BMP/TGA under the directory is decoded, converted to RGBA8,
+// premultiplied (unless --straight) and optionally given a mip chain. Entries are named
+// by their path relative to the directory, e.g. "icons/home.png".
+// The ImGui backend only blends premultiplied textures correctly when it is given a way to
+// switch the renderer's blend mode (src/main.cpp does); otherwise bake with --straight.
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+#include "hmui/graphics/providers/AssetPack.h"
+#include "hmui/graphics/providers/ImageResample.h"
+
+namespace fs = std::filesystem;
+
+static bool isImage(const fs::path& path) {
+    std::string ext = path.extension().string();
+    for (char& c : ext) c = (char) std::tolower((unsigned char) c);
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".qoi" || ext == ".bmp" || ext == ".tga";
+}
+
+static std::vector<uint8_t> bakePixels(Image& img, bool mipmaps, int& levels) {
+    size_t base = (size_t) img.width * img.height * 4;
+    std::vector<uint8_t> out((const uint8_t*) img.data, (const uint8_t*) img.data + base);
+
+    levels = 1;
+    if (!mipmaps) return out;
+
+    size_t offset = 0;
+    for (int w = img.width, h = img.height; w >= 2 && h >= 2; w /= 2, h /= 2) {
+        size_t next = out.size();
+        out.resize(next + (size_t) (w / 2) * (h / 2) * 4);
+        halveRGBA8(out.data() + offset, w, h, out.data() + next);
+        offset = next;
+        levels++;
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <assets dir> <output.hmpk> [--straight] [--mipmaps]\n", argv[0]);
+        return 1;
+    }
+
+    fs::path root = argv[1];
+    std::string output = argv[2];
+    bool premultiply = true;
+    bool mipmaps = false;
+
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--straight") == 0) premultiply = false;
+        else if (std::strcmp(argv[i], "--mipmaps") == 0) mipmaps = true;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    AssetPackWriter writer;
+    size_t count = 0;
+
+    for (const auto& file : fs::recursive_directory_iterator(root)) {
+        if (!file.is_regular_file() || !isImage(file.path())) continue;
+
+        Image img = LoadImage(file.path().string().c_str());
+        if (img.data == nullptr) {
+            std::fprintf(stderr, "skipping %s: could not decode\n", file.path().string().c_str());
+            continue;
+        }
+
+        ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (premultiply) ImageAlphaPremultiply(&img);
+
+        int levels = 1;
+        std::vector<uint8_t> pixels = bakePixels(img, mipmaps, levels);
+
+        std::string name = fs::relative(file.path(), root).generic_string();
+        writer.add(name, img.width, img.height, AssetPackFormat::RGBA8, levels,
+                   premultiply ? ASSET_PACK_PREMULTIPLIED : 0, std::move(pixels));
+        UnloadImage(img);
+
+        std::printf("  %s (%dx%d)\n", name.c_str(), img.width, img.height);
+        count++;
+    }
+
+    if (!writer.write(output)) {
+        std::fprintf(stderr, "could not write %s\n", output.c_str());
+        return 1;
+    }
+
+    // Read it back: a pack the runtime cannot open is worse than no pack
+    auto pack = AssetPack::open(output);
+    if (!pack || pack->size() != count) {
+        std::fprintf(stderr, "%s failed validation\n", output.c_str());
+        return 1;
+    }
+
+    std::printf("packed %zu images into %s\n", count, output.c_str());
+    return 0;
+}
@@ -0,0 +1,185 @@
+// layoutbench: measures how layout and paint scale with ParallelLayout and ParallelPaint.
+//
+//   layoutbench [panels] [items per panel] [iterations]
+//
+// Builds a Stack of panels, each a Container > Column > Wrap of paragraphs that re-break
+// their text on every pass, and lays it out and paints it at alternating widths, first
+// serially and then on pools of increasing size. Every parallel run is checked to produce
+// the exact same bounds and the exact same draw call stream as the serial one.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/graphics/ParallelPaint.h"
+#include "hmui/graphics/text/TextLayout.h"
+#include "hmui/layout/ParallelLayout.h"
+#include "hmui/widgets/Scrollable.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/Wrap.h"
+#include "hmui/widgets/Stack.h"
+
+// Text measured without a cache, so every pass does the work of a cold layout
+class Paragraph : public InternalDrawable {
+public:
+    Paragraph(const FontMetrics& metrics, std::string text) : metrics(metrics), text(std::move(text)) {}
+
+    void layout(BoxConstraints constraints) override {
+        TextLayoutParams params;
+        params.maxWidth = std::min(constraints.maxWidth, 160.0f);
+        TextLayout::breakLines(metrics, text, params, result);
+
+        bounds.width = std::clamp(result.width, constraints.minWidth, constraints.maxWidth);
+        bounds.height = std::clamp(result.height, constraints.minHeight, constraints.maxHeight);
+    }
+
+    void onDraw(GraphicsContext* ctx, float x, float y) override {
+        ctx->fillRect(Rect(x, y, bounds.width, bounds.height), Color2D(0.1f, 0.1f, 0.1f));
+
+        float lineY = y;
+        for (const auto& line : result.lines) {
+            ctx->drawText(x, lineY, line.text.c_str(), 1.0f, Color2D(1.0f, 1.0f, 1.0f));
+            lineY += metrics.getLineHeight();
+        }
+    }
+
+private:
+    const FontMetrics& metrics;
+    std::string text;
+    TextLayoutResult result;
+};
+
+struct Scene {
+    std::shared_ptr<InternalDrawable> root;
+    std::vector<InternalDrawable*> nodes; // Everything whose bounds are compared
+};
+
+static Scene buildScene(const FontMetrics& metrics, size_t panels, size_t items) {
+    static const char* words[] = {"layout", "frame", "widget", "subtree", "constraint", "align", "wrap", "stack"};
+
+    Scene scene;
+    std::vector<std::shared_ptr<InternalDrawable>> stackChildren;
+
+    for (size_t p = 0; p < panels; ++p) {
+        std::vector<std::shared_ptr<InternalDrawable>> paragraphs;
+        for (size_t i = 0; i < items; ++i) {
+            std::string text;
+            for (size_t w = 0; w < 6 + (p * 7 + i * 3) % 20; ++w) {
+                text += words[(p + i * 5 + w) % 8];
+                text += ' ';
+            }
+            auto paragraph = std::make_shared<Paragraph>(metrics, std::move(text));
+            scene.nodes.push_back(paragraph.get());
+            paragraphs.push_back(std::move(paragraph));
+        }
+
+        auto wrap = Wrap(.spacing = 4.0f, .runSpacing = 4.0f, .children = std::move(paragraphs));
+        auto panel = Container(
+            .padding = EdgeInsets::all(8.0f),
+            .child = Column(.children = {wrap}),
+        );
+        scene.nodes.push_back(wrap.get());
+        scene.nodes.push_back(panel.get());
+        stackChildren.push_back(panel);
+    }
+
+    scene.root = Stack(.children = std::move(stackChildren));
+    scene.nodes.push_back(scene.root.get());
+    scene.root->init();
+    return scene;
+}
+
+static std::vector<Rect> snapshot(const Scene& scene) {
+    std::vector<Rect> rects;
+    rects.reserve(scene.nodes.size());
+    for (auto* node : scene.nodes) rects.push_back(node->getBounds());
+    return rects;
+}
+
+static bool sameBounds(const std::vector<Rect>& a, const std::vector<Rect>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(Rect)) == 0;
+}
+
+struct Timing {
+    double layoutMs = 0.0;
+    double paintMs = 0.0;
+};
+
+// Average milliseconds per frame; 'bounds' and 'paint' get the output of the final frame
+static Timing run(const Scene& scene, size_t iterations, std::vector<Rect>& bounds, DisplayList& paint) {
+    using Clock = std::chrono::steady_clock;
+
+    RecordingGraphicsContext screen;
+    screen.setViewport(Rect(0, 0, 1280.0f, 720.0f));
+    RecordingGraphicsContext recorder;
+
+    Timing timing;
+    for (size_t i = 0; i < iterations; ++i) {
+        FrameArena::reset();
+
+        float width = (i % 2 == 0) ? 1280.0f : 1100.0f;
+        auto start = Clock::now();
+        scene.root->layout(BoxConstraints::loose(width, 720.0f));
+        auto laidOut = Clock::now();
+
+        recorder.begin(screen);
+        scene.root->onDraw(&recorder, 0, 0);
+        auto painted = Clock::now();
+
+        timing.layoutMs += std::chrono::duration<double, std::milli>(laidOut - start).count();
+        timing.paintMs += std::chrono::duration<double, std::milli>(painted - laidOut).count();
+    }
+
+    timing.layoutMs /= iterations;
+    timing.paintMs /= iterations;
+    bounds = snapshot(scene);
+    paint = recorder.getList();
+    return timing;
+}
+
+int main(int argc, char** argv) {
+    size_t panels = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    size_t items = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 400;
+    size_t iterations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+
+    auto metrics = FontMetrics::defaultFont();
+    Scene scene = buildScene(*metrics, panels, items);
+    std::printf("%zu panels x %zu paragraphs, %zu nodes\n", panels, items, scene.root->getSubtreeSize());
+
+    std::vector<Rect> serialBounds;
+    DisplayList serialPaint;
+    run(scene, 2, serialBounds, serialPaint); // Warm up
+    Timing serial = run(scene, iterations, serialBounds, serialPaint);
+    std::printf("            layout ms       paint ms\n");
+    std::printf("serial      %8.3f        %8.3f        (%zu draw calls)\n",
+                serial.layoutMs, serial.paintMs, serialPaint.size());
+
+    ParallelPaint::setEnabled(true);
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t workers = 1; workers < hardware * 2; workers *= 2) {
+        ParallelLayout::enable(workers);
+
+        std::vector<Rect> bounds;
+        DisplayList paint;
+        run(scene, 2, bounds, paint);
+        Timing timing = run(scene, iterations, bounds, paint);
+        ParallelLayout::disable();
+
+        bool identical = sameBounds(serialBounds, bounds) && serialPaint == paint;
+        std::printf("%2zu workers  %8.3f x%.2f  %8.3f x%.2f  %s\n", workers,
+                    timing.layoutMs, serial.layoutMs / timing.layoutMs,
+                    timing.paintMs, serial.paintMs / timing.paintMs,
+                    identical ? "identical" : "MISMATCH");
+
+        if (!identical) return 1;
+    }
+    return 0;
+}
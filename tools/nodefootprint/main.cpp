@@ -0,0 +1,215 @@
+// nodefootprint: reports what widget nodes cost in memory.
+//
+//   nodefootprint [cards]
+//
+// - Per widget type: sizeof the node (widgetFootprints) and what building a default one
+//   takes from a WidgetArena, which adds the shared_ptr control block and, where the widget
+//   keeps its properties apart, their block.
+// - For a tree of cards (a GestureDetector > Container > Column of two Texts, an Image and
+//   a Row of two Texts: 9 nodes each, 11,111 cards and a root by default, 100,000 nodes):
+//   the arena bytes and the growth of the resident set once it is built, initialised and
+//   laid out, per node. The resident set also covers what nodes point to (child lists,
+//   strings, text line caches); it is only reported where the platform exposes it.
+//   The tree is built twice: with every widget's properties its own, and with what is the
+//   same in every card (tap handler, padding, body text, row labels) shared the way a list
+//   built from one template does. Only the title differs between cards then.
+// The shared tree must take at least 50% fewer arena bytes per node than the same tree did
+// before nodes were slimmed down (BASELINE_ARENA_BYTES, 64-bit libstdc++).
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "hmui/HMUI.h"
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/widgets/WidgetFootprint.h"
+#include "../common/HeadlessOSContext.h"
+
+namespace {
+
+class StubImageProvider : public ImageProvider {
+public:
+    ImageHandle* load() override { return &handle; }
+    void dispose() override {}
+    bool probe(ImageInfo& out) override {
+        out = ImageInfo{48, 48, 4};
+        return true;
+    }
+
+private:
+    ImageHandle handle{48, 48, nullptr};
+};
+
+size_t residentBytes() {
+#if defined(__linux__)
+    long pages = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        long size = 0;
+        if (std::fscanf(statm, "%ld %ld", &size, &pages) != 2) pages = 0;
+        std::fclose(statm);
+    }
+    return (size_t) pages * (size_t) sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// Arena bytes one node of this kind takes, control block included
+template<typename F>
+size_t arenaBytes(F&& make) {
+    WidgetArena::Scope scope(WidgetArena::create());
+    auto node = make();
+    return scope.arena()->getBytesUsed();
+}
+
+size_t arenaBytesFor(const char* name) {
+    const std::string type = name;
+    if (type == "Column") return arenaBytes([]() { return Column(); });
+    if (type == "Row") return arenaBytes([]() { return Row(); });
+    if (type == "Container") return arenaBytes([]() { return Container(); });
+    if (type == "Expanded") return arenaBytes([]() { return Expanded(); });
+    if (type == "FlexBox") return arenaBytes([]() { return FlexBox(); });
+    if (type == "Wrap") return arenaBytes([]() { return Wrap(); });
+    if (type == "Stack") return arenaBytes([]() { return Stack(); });
+    if (type == "Positioned") return arenaBytes([]() { return Positioned(); });
+    if (type == "GestureDetector") return arenaBytes([]() { return GestureDetector(); });
+    if (type == "Scrollable") return arenaBytes([]() { return Scrollable(); });
+    if (type == "Text") return arenaBytes([]() { return Text(); });
+    if (type == "TextView") return arenaBytes([]() { return TextView(); });
+    if (type == "Image") return arenaBytes([]() { return Image(); });
+    if (type == "TiledImage") return arenaBytes([]() { return TiledImage(); });
+    return 0;
+}
+
+// Arena bytes per node of the card tree before d988cef slimmed the nodes down
+constexpr double BASELINE_ARENA_BYTES = 262.2;
+
+const char* const BODY = "A line of body text that wraps once it gets to the edge of the card";
+
+void onTap(std::shared_ptr<InternalDrawable>, float, float) {}
+
+std::shared_ptr<InternalDrawable> card(int index) {
+    return GestureDetector(
+        .onTap = onTap,
+        .child = Container(
+            .padding = EdgeInsets::all(4),
+            .child = Column(.children = {
+                Text(.text = "Card " + std::to_string(index)),
+                Text(.text = BODY),
+                Image(.provider = std::make_shared<StubImageProvider>(), .width = 48, .height = 48),
+                Row(.children = {
+                    Text(.text = "Left"),
+                    Text(.text = "Right"),
+                }),
+            })
+        )
+    );
+}
+
+// What every card has in common, built once
+struct CardTemplate {
+    std::shared_ptr<const GestureDetectorProperties> tap = shareProperties(GestureDetectorProperties{.onTap = onTap});
+    std::shared_ptr<const ContainerProperties> frame = shareProperties(ContainerProperties{.padding = EdgeInsets::all(4)});
+    std::shared_ptr<const TextProperties> body = shareProperties(TextProperties{.text = BODY});
+    std::shared_ptr<const TextProperties> left = shareProperties(TextProperties{.text = "Left"});
+    std::shared_ptr<const TextProperties> right = shareProperties(TextProperties{.text = "Right"});
+};
+
+std::shared_ptr<InternalDrawable> sharedCard(const CardTemplate& t, int index) {
+    return WidgetArena::make<D_GestureDetector>(t.tap, WidgetArena::make<D_Container>(t.frame,
+        Column(.children = {
+            Text(.text = "Card " + std::to_string(index)),
+            WidgetArena::make<D_Text>(t.body),
+            Image(.provider = std::make_shared<StubImageProvider>(), .width = 48, .height = 48),
+            Row(.children = {
+                WidgetArena::make<D_Text>(t.left),
+                WidgetArena::make<D_Text>(t.right),
+            }),
+        })
+    ));
+}
+
+struct TreeCost {
+    size_t nodes;
+    double arenaPerNode;
+    double residentPerNode; // 0 where the platform does not expose it
+};
+
+// Leaves the tree in root, so the next one measured does not reuse its memory
+template<typename F>
+TreeCost measureTree(HMUI& hmui, int cards, std::shared_ptr<InternalDrawable>& root, F&& makeCard) {
+    size_t liveBefore = InternalDrawable::getLiveCount();
+    size_t before = residentBytes();
+    auto arena = WidgetArena::create();
+    {
+        HMUI::Scope scope(&hmui);
+        WidgetArena::Scope arenaScope(arena);
+
+        ChildrenList children;
+        children.reserve(cards);
+        for (int i = 0; i < cards; ++i) {
+            children.push_back(makeCard(i));
+        }
+        root = Column(.children = std::move(children));
+        root->init();
+        root->layout(BoxConstraints::loose(1280, INFINITY));
+    }
+    size_t after = residentBytes();
+
+    TreeCost cost{InternalDrawable::getLiveCount() - liveBefore, 0.0, 0.0};
+    cost.arenaPerNode = (double) arena->getBytesUsed() / cost.nodes;
+    if (after > 0) cost.residentPerNode = (double) (after - before) / cost.nodes;
+    return cost;
+}
+
+void print(const char* label, const TreeCost& cost) {
+    std::printf("%-20s arena %6.1f bytes/node", label, cost.arenaPerNode);
+    if (cost.residentPerNode > 0) std::printf(", resident set %6.1f bytes/node", cost.residentPerNode);
+    std::printf("\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    int cards = argc > 1 ? std::atoi(argv[1]) : 11111;
+
+    std::printf("%-18s %8s %12s\n", "widget", "sizeof", "arena bytes");
+    for (const auto& footprint : widgetFootprints) {
+        size_t arena = arenaBytesFor(footprint.name);
+        if (arena > 0) {
+            std::printf("%-18s %8zu %12zu\n", footprint.name, footprint.size, arena);
+        } else {
+            std::printf("%-18s %8zu %12s\n", footprint.name, footprint.size, "-");
+        }
+    }
+
+    auto hmui = std::make_shared<HMUI>();
+    hmui->initialize(std::make_shared<RecordingGraphicsContext>(), std::make_shared<HeadlessOSContext>());
+
+    CardTemplate shared;
+    std::shared_ptr<InternalDrawable> ownTree;
+    std::shared_ptr<InternalDrawable> sharedTree;
+    TreeCost ownCost = measureTree(*hmui, cards, ownTree, [](int i) { return card(i); });
+    TreeCost sharedCost = measureTree(*hmui, cards, sharedTree, [&](int i) { return sharedCard(shared, i); });
+
+    std::printf("\n%d cards, %zu nodes\n", cards, sharedCost.nodes);
+    print("own properties:", ownCost);
+    print("shared properties:", sharedCost);
+
+    double reduction = 1.0 - sharedCost.arenaPerNode / BASELINE_ARENA_BYTES;
+    std::printf("arena bytes per node against %.1f before: %.0f%% fewer\n", BASELINE_ARENA_BYTES, reduction * 100.0);
+    std::printf("at least 50%% fewer bytes per node: %s\n", reduction >= 0.5 ? "yes" : "NO");
+
+    {
+        HMUI::Scope scope(hmui.get());
+        ownTree->dispose();
+        sharedTree->dispose();
+    }
+    hmui->close();
+    return reduction >= 0.5 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+// packcheck: writes asset packs with AssetPackWriter and reads them back with AssetPack.
+//
+//   packcheck
+//
+// - Every format, with and without a mip chain, down to levels smaller than a compressed
+//   block, round-trips: same names, sizes, flags and payload bytes, through memory and
+//   through a file on disk.
+// - Packs whose payloads are too short for their size, format and mip count, or that use
+//   an unknown format or impossible sizes, are rejected when opened instead of being read
+//   past the end of the payload at upload time.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "hmui/graphics/providers/AssetPack.h"
+
+namespace {
+
+int errors = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::printf("failed: %s\n", what.c_str());
+        errors++;
+    }
+}
+
+const char* formatName(AssetPackFormat format) {
+    switch (format) {
+        case AssetPackFormat::RGBA8: return "RGBA8";
+        case AssetPackFormat::ETC2_RGBA: return "ETC2";
+        case AssetPackFormat::ASTC_4x4_RGBA: return "ASTC";
+        case AssetPackFormat::DXT5_RGBA: return "DXT5";
+    }
+    return "?";
+}
+
+// What the format takes, computed independently of the reader
+size_t levelBytes(AssetPackFormat format, int width, int height) {
+    if (format == AssetPackFormat::RGBA8) return (size_t) width * height * 4;
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * 16;
+}
+
+size_t chainBytes(AssetPackFormat format, int width, int height, int mipmaps) {
+    size_t bytes = 0;
+    for (int level = 0; level < mipmaps; ++level) {
+        bytes += levelBytes(format, std::max(1, width >> level), std::max(1, height >> level));
+    }
+    return bytes;
+}
+
+std::vector<uint8_t> pattern(size_t size, int seed) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = (uint8_t) (i * 31 + seed);
+    return data;
+}
+
+struct Texture {
+    std::string name;
+    int width;
+    int height;
+    AssetPackFormat format;
+    int mipmaps;
+    uint32_t flags;
+    std::vector<uint8_t> data;
+};
+
+std::vector<Texture> sampleTextures() {
+    const AssetPackFormat formats[] = {
+        AssetPackFormat::RGBA8, AssetPackFormat::ETC2_RGBA, AssetPackFormat::ASTC_4x4_RGBA, AssetPackFormat::DXT5_RGBA,
+    };
+
+    std::vector<Texture> textures;
+    int seed = 0;
+    for (AssetPackFormat format : formats) {
+        // Square, non-power-of-two, thinner than a block, and a chain down to 1x1
+        struct Size { int width, height, mipmaps; };
+        const Size sizes[] = { {64, 64, 1}, {30, 18, 1}, {2, 9, 1}, {64, 64, 7}, {40, 12, 3} };
+
+        for (const Size& size : sizes) {
+            std::string name = std::string(formatName(format)) + "/" + std::to_string(size.width) + "x"
+                             + std::to_string(size.height) + "@" + std::to_string(size.mipmaps) + ".png";
+            uint32_t flags = (seed % 2) ? ASSET_PACK_PREMULTIPLIED : 0;
+            size_t bytes = chainBytes(format, size.width, size.height, size.mipmaps);
+            textures.push_back({name, size.width, size.height, format, size.mipmaps, flags, pattern(bytes, seed++)});
+        }
+    }
+    return textures;
+}
+
+AssetPackWriter makeWriter(const std::vector<Texture>& textures) {
+    AssetPackWriter writer;
+    for (const Texture& texture : textures) {
+        writer.add(texture.name, texture.width, texture.height, texture.format, texture.mipmaps, texture.flags,
+                   texture.data);
+    }
+    return writer;
+}
+
+std::vector<uint8_t> buildPack(const std::vector<Texture>& textures) {
+    return makeWriter(textures).build();
+}
+
+void checkContents(const AssetPack& pack, const std::vector<Texture>& textures, const std::string& via) {
+    check(pack.size() == textures.size(), via + ": entry count");
+
+    for (const Texture& texture : textures) {
+        AssetPackTexture found;
+        if (!pack.find(texture.name, found)) {
+            check(false, via + ": " + texture.name + " not found");
+            continue;
+        }
+
+        bool same = found.name == texture.name && found.width == texture.width && found.height == texture.height
+                 && found.format == texture.format && found.mipmaps == texture.mipmaps
+                 && found.premultiplied == ((texture.flags & ASSET_PACK_PREMULTIPLIED) != 0)
+                 && found.size == texture.data.size()
+                 && std::equal(texture.data.begin(), texture.data.end(), found.data);
+        check(same, via + ": " + texture.name + " differs");
+    }
+
+    AssetPackTexture missing;
+    check(!pack.find("missing.png", missing), via + ": found a name that is not there");
+}
+
+// A pack with only this texture must be rejected
+void checkRejected(Texture texture, const std::string& why) {
+    std::vector<uint8_t> bytes = buildPack({texture});
+    check(AssetPack::fromMemory(bytes.data(), bytes.size()) == nullptr,
+          std::string("accepted ") + formatName(texture.format) + " " + texture.name + ": " + why);
+}
+
+}
+
+int main() {
+    std::vector<Texture> textures = sampleTextures();
+    std::vector<uint8_t> bytes = buildPack(textures);
+
+    auto inMemory = AssetPack::fromMemory(bytes.data(), bytes.size());
+    check(inMemory != nullptr, "valid pack rejected from memory");
+    if (inMemory) checkContents(*inMemory, textures, "memory");
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "packcheck.hmpk";
+    check(makeWriter(textures).write(path.string()), "writing the pack");
+    if (auto onDisk = AssetPack::open(path.string())) {
+        checkContents(*onDisk, textures, "file");
+    } else {
+        check(false, "valid pack rejected from a file");
+    }
+    std::filesystem::remove(path);
+
+    // One byte short of each valid texture's payload, a missing mip level, the wrong format
+    for (const Texture& texture : textures) {
+        Texture shorter = texture;
+        shorter.data.pop_back();
+        checkRejected(shorter, "payload one byte short");
+
+        if (texture.mipmaps > 1) {
+            Texture missingLevel = texture;
+            missingLevel.data.resize(chainBytes(texture.format, texture.width, texture.height, texture.mipmaps - 1));
+            checkRejected(missingLevel, "last mip level missing");
+        }
+    }
+
+    Texture compressed = textures[5];
+    Texture asRGBA = compressed;
+    asRGBA.format = AssetPackFormat::RGBA8;
+    checkRejected(asRGBA, "compressed payload labelled RGBA8");
+
+    Texture unknown = textures[0];
+    unknown.format = (AssetPackFormat) 99;
+    checkRejected(unknown, "unknown format");
+
+    Texture empty = textures[0];
+    empty.width = 0;
+    checkRejected(empty, "zero width");
+
+    Texture tooManyLevels = textures[0];
+    tooManyLevels.mipmaps = 8;
+    tooManyLevels.data.resize(chainBytes(tooManyLevels.format, 64, 64, 8));
+    checkRejected(tooManyLevels, "more mip levels than a 64x64 chain has");
+
+    // Cut short, in the header, the table or the last payload
+    for (size_t size : { (size_t) 0, sizeof(AssetPackHeader) - 1, sizeof(AssetPackHeader) + 10, bytes.size() - 1 }) {
+        check(AssetPack::fromMemory(bytes.data(), size) == nullptr,
+              "accepted a pack truncated to " + std::to_string(size) + " bytes");
+    }
+
+    std::printf("%zu textures round-tripped, %d failures\n", textures.size(), errors);
+    std::printf("%s\n", errors == 0 ? "ok" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
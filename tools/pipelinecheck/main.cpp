@@ -0,0 +1,202 @@
+// pipelinecheck: runs HMUI through FramePipeline headless, with a fake window and a recording
+// backend, and checks what the render/UI thread split promises.
+//
+//   pipelinecheck [frames]
+//
+// - Input captured in beginFrame() is seen by the frame being built, which is shown by the
+//   next submit(): one frame of latency, never more.
+// - Graphics calls the UI thread makes (uploads, cursor, clipboard) run on the render thread.
+// - A texture released by the UI thread while the previous frame, which still draws it, is
+//   being submitted stays alive until that submit is done. The image provider here releases
+//   the way the raylib ones do, through RenderThread::retire(); the backend waits for the
+//   release to happen before it replays the draw, then checks that the handle is still live.
+//
+// Build with -fsanitize=thread or address to check the handover itself.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "hmui/HMUI.h"
+#include "hmui/FramePipeline.h"
+#include "hmui/util/RenderThread.h"
+#include "hmui/widgets/Column.h"
+#include "../common/HeadlessOSContext.h"
+
+namespace {
+
+std::thread::id renderThread;
+std::atomic<int> errors{0};
+
+void check(bool ok, const char* what) {
+    if (!ok && errors.fetch_add(1) < 10) std::printf("failed: %s\n", what);
+}
+
+class FakeOS : public HeadlessOSContext {
+public:
+    void update() override { frame++; }
+
+    Coord getMousePosition() override { return Coord((float) frame, 0.0f); }
+    void setMouseCursor(int) override { check(RenderThread::isCurrent(), "cursor set off the render thread"); }
+    const char* getClipboardText() override {
+        check(RenderThread::isCurrent(), "clipboard read off the render thread");
+        return "clip";
+    }
+
+private:
+    int frame = 0;
+};
+
+// Handles that have been uploaded and not freed yet, with the generation they were made for
+std::mutex liveMutex;
+std::map<const ImageHandle*, int> live;
+std::atomic<int> released{0}; // Newest generation the UI thread has let go of
+
+class CheckedProvider : public ImageProvider {
+public:
+    explicit CheckedProvider(int generation) : generation(generation) {}
+    ~CheckedProvider() override { dispose(); }
+
+    ImageHandle* load() override {
+        if (resident) return &resident->handle;
+
+        resident = std::make_shared<Resident>();
+        RenderThread::call([this]() {
+            check(std::this_thread::get_id() == renderThread, "upload off the render thread");
+            resident->texture = generation;
+        });
+        resident->handle = { 1, 1, &resident->texture };
+
+        std::lock_guard<std::mutex> lock(liveMutex);
+        live[&resident->handle] = generation;
+        return &resident->handle;
+    }
+
+    void dispose() override {
+        if (!resident) return;
+        released.store(generation, std::memory_order_release);
+
+        RenderThread::retire([retired = std::move(resident)]() {
+            check(std::this_thread::get_id() == renderThread, "texture freed off the render thread");
+            std::lock_guard<std::mutex> lock(liveMutex);
+            live.erase(&retired->handle);
+        });
+        resident = nullptr;
+    }
+
+private:
+    struct Resident {
+        int texture = 0;
+        ImageHandle handle{};
+    };
+
+    int generation;
+    std::shared_ptr<Resident> resident;
+};
+
+// Swaps its image every frame: frame N+1's update() releases what frame N draws
+class Swapper : public InternalDrawable {
+public:
+    void onUpdate(float) override {
+        check(std::this_thread::get_id() != renderThread, "update on the render thread");
+
+        // Release before loading: the load waits on the render thread, which is replaying
+        if (provider) provider->dispose();
+        provider = std::make_shared<CheckedProvider>(++generation);
+        image = provider->load();
+
+        seen = hmui()->getOSContext()->getMousePosition().x;
+        hmui()->getOSContext()->setMouseCursor(1);
+        check(std::string(hmui()->getOSContext()->getClipboardText()) == "clip", "clipboard round-trip");
+    }
+
+    void dispose() override {
+        if (provider) provider->dispose();
+        provider = nullptr;
+        image = nullptr;
+    }
+
+    void layout(BoxConstraints) override {
+        bounds.width = 10;
+        bounds.height = 10;
+    }
+
+    void onDraw(GraphicsContext* ctx, float, float) override {
+        // The generation rides along in the rect, so the backend knows what it should find
+        if (image) ctx->drawImage(Rect((float) generation, 0, 1, 1), image, Color2D());
+    }
+
+    float seen = -1.0f;
+
+private:
+    std::shared_ptr<ImageProvider> provider;
+    ImageHandle* image = nullptr;
+    int generation = 0;
+};
+
+class CheckingBackend : public RecordingGraphicsContext {
+public:
+    void drawImage(const Rect& rect, ImageHandle* texture, const Color2D& color, float scale) override {
+        int generation = (int) rect.x;
+
+        // Give the UI thread, busy with the next frame, time to release this very image
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (released.load(std::memory_order_acquire) < generation && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(liveMutex);
+            auto it = live.find(texture);
+            check(it != live.end() && it->second == generation, "released texture freed before its frame was submitted");
+        }
+        images++;
+
+        RecordingGraphicsContext::drawImage(rect, texture, color, scale);
+    }
+
+    int images = 0;
+};
+
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 200;
+    renderThread = std::this_thread::get_id();
+
+    auto hmui = std::make_shared<HMUI>();
+    auto backend = std::make_shared<CheckingBackend>();
+    auto input = std::make_shared<SnapshotOSContext>(std::make_shared<FakeOS>());
+    hmui->initialize(backend, input);
+
+    auto swapper = std::make_shared<Swapper>();
+    hmui->setRouter(Column(.children = {swapper}));
+
+    {
+        FramePipeline pipeline(*hmui, input);
+        GfxList gfx{nullptr};
+
+        for (int i = 1; i <= frames; ++i) {
+            pipeline.beginFrame(1.0f / 60.0f, 320, 240);
+            hmui->prepareFrame();
+            backend->begin(Rect(0, 0, 320, 240), nullptr);
+            pipeline.submit(&gfx);
+            check(backend->getList().size() == (i == 1 ? 0u : 1u), "submitted the frame built last");
+            pipeline.endFrame();
+
+            check(swapper->seen == (float) i, "frame built from this frame's input");
+        }
+    }
+
+    hmui->close();
+
+    std::printf("%d frames, %d images replayed, %zu textures live after close\n", frames, backend->images, live.size());
+    check(live.empty(), "textures leaked");
+    std::printf("%s\n", errors.load() == 0 ? "ok" : "FAILED");
+    return errors.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+// routebench: measures what pushing a route costs, cold and prewarmed, as routes grow.
+//
+//   routebench [budget ms] [frames per size]
+//
+// For routes of 100, 1,000 and 10,000 cards (a composed widget with a Container, a Column,
+// two Texts and an Image each), times:
+// - a cold push: build, init and the first frame all happen in the push
+// - a prewarm: the longest frame while Navigator::prewarm() builds the route a slice at a
+//   time, and how many frames it takes
+// - the push of the prewarmed route, which only swaps the finished view in (best of five,
+//   from cold caches)
+// The prewarmed push and the longest prewarm frame must not grow with the route. A route
+// dropped half-way through its prewarm must free every widget it had built.
+//
+// It also builds each route with and without a WidgetArena and reports, best of five: the
+// time to build and init it, the time to destroy it, and how many calls it makes to the
+// global allocator. The last needs a build configured with HMUI_TRACK_ALLOCATIONS; there,
+// the arena must take calls away.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hmui/HMUI.h"
+#include "hmui/AllocationTracker.h"
+#include "hmui/Navigator.h"
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/widgets/AppContext.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/Drawable.h"
+#include "hmui/widgets/Image.h"
+#include "hmui/widgets/Text.h"
+#include "../common/HeadlessOSContext.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void evictCaches() {
+    static std::vector<char> buffer(32 << 20);
+    for (size_t i = 0; i < buffer.size(); i += 64) buffer[i]++;
+}
+
+// Already decoded, uploading is free
+class StubImageProvider : public ImageProvider {
+public:
+    ImageHandle* load() override { return &handle; }
+    void dispose() override {}
+    bool probe(ImageInfo& out) override {
+        out = ImageInfo{64, 64, 4};
+        return true;
+    }
+
+private:
+    ImageHandle handle{64, 64, nullptr};
+};
+
+class Card : public Drawable {
+public:
+    explicit Card(int index) : index(index) {}
+
+    std::shared_ptr<InternalDrawable> build() override {
+        return Container(
+            .padding = EdgeInsets::all(4),
+            .child = Column(.children = {
+                Text(.text = "Card " + std::to_string(index)),
+                Text(.text = "A line of body text that wraps once it gets to the edge of the card"),
+                Image(.provider = std::make_shared<StubImageProvider>(), .width = 64, .height = 64),
+            })
+        );
+    }
+
+private:
+    int index;
+};
+
+std::shared_ptr<InternalDrawable> buildRoute(int cards) {
+    ChildrenList children;
+    children.reserve(cards);
+    for (int i = 0; i < cards; ++i) {
+        children.push_back(WidgetArena::make<Card>(i));
+    }
+    return Column(.children = std::move(children));
+}
+
+class Root : public Drawable {
+public:
+    explicit Root(int cards) : cards(cards) {}
+
+    std::shared_ptr<InternalDrawable> build() override {
+        return AppContext(
+            .routes = {
+                { "/", []() { return Container(); } },
+                { "/cold", [cards = cards]() { return buildRoute(cards); } },
+                { "/warm", [cards = cards]() { return buildRoute(cards); } },
+            },
+            .initialRoute = "/",
+            .prewarmBudgetMs = budgetMs
+        );
+    }
+
+    float budgetMs = 2.0f;
+
+private:
+    int cards;
+};
+
+struct Result {
+    int cards;
+    double coldPush;
+    double warmPush;
+    double longestPrewarmFrame;
+    int prewarmFrames;
+    bool prewarmed;
+};
+
+class Bench {
+public:
+    Bench(int cards, float budgetMs) {
+        hmui = std::make_shared<HMUI>();
+        hmui->initialize(std::make_shared<RecordingGraphicsContext>(), std::make_shared<HeadlessOSContext>());
+        auto root = std::make_shared<Root>(cards);
+        root->budgetMs = budgetMs;
+        hmui->setRouter(root);
+        frame();
+    }
+
+    ~Bench() {
+        hmui->close();
+    }
+
+    double frame() {
+        auto start = Clock::now();
+        hmui->update(1.0f / 60.0f);
+        hmui->record(recorder, 1280, 720);
+        return msSince(start);
+    }
+
+    // Navigator calls come from inside the UI, e.g. a button's callback
+    template<typename F>
+    double navigate(F&& action) {
+        HMUI::Scope scope(hmui.get());
+        auto start = Clock::now();
+        action();
+        return msSince(start);
+    }
+
+    bool isPrewarmed(const std::string& route) {
+        HMUI::Scope scope(hmui.get());
+        return D_AppContext::get()->isPrewarmed(route);
+    }
+
+private:
+    std::shared_ptr<HMUI> hmui;
+    RecordingGraphicsContext recorder;
+};
+
+Result run(int cards, float budgetMs, int maxFrames) {
+    Result result{cards, 0.0, 0.0, 0.0, 0, false};
+    Bench bench(cards, budgetMs);
+
+    result.coldPush = bench.navigate([]() { Navigator::push("/cold"); }) + bench.frame();
+    bench.navigate([]() { Navigator::pop(); });
+    bench.frame();
+
+    bench.navigate([]() { Navigator::prewarm("/warm"); });
+    while (result.prewarmFrames < maxFrames && !bench.isPrewarmed("/warm")) {
+        result.longestPrewarmFrame = std::max(result.longestPrewarmFrame, bench.frame());
+        result.prewarmFrames++;
+    }
+    result.prewarmed = bench.isPrewarmed("/warm");
+
+    // Best of a few, each from cold caches: a bigger route evicts more of them, which would
+    // otherwise be measured as the push
+    for (int i = 0; i < 5; ++i) {
+        if (i > 0) {
+            bench.navigate([]() { Navigator::pop(); });
+            bench.frame();
+            bench.navigate([]() { Navigator::prewarm("/warm"); });
+            for (int frames = 0; frames < maxFrames && !bench.isPrewarmed("/warm"); ++frames) bench.frame();
+        }
+
+        evictCaches();
+        double push = bench.navigate([]() { Navigator::push("/warm"); });
+        result.warmPush = i == 0 ? push : std::min(result.warmPush, push);
+    }
+    return result;
+}
+
+struct BuildCost {
+    int cards;
+    bool arena;
+    double build;
+    double teardown;
+    size_t allocatorCalls; // Zero without HMUI_TRACK_ALLOCATIONS
+    size_t arenaObjects;
+    size_t arenaBlocks;
+};
+
+// What AppContext does for a route, with the arena or with make_shared for every widget
+void measureBuild(Bench& bench, BuildCost& cost, bool first) {
+    std::shared_ptr<WidgetArena> arena = cost.arena ? WidgetArena::create() : nullptr;
+    std::shared_ptr<InternalDrawable> view;
+
+    evictCaches();
+    size_t calls = AllocationTracker::getCount();
+    double build = bench.navigate([&]() {
+        WidgetArena::Scope scope(arena);
+        view = buildRoute(cost.cards);
+        view->init();
+    });
+    calls = AllocationTracker::getCount() - calls;
+
+    if (arena) {
+        cost.arenaObjects = arena->getAllocationCount();
+        cost.arenaBlocks = arena->getBlockCount();
+    }
+
+    auto start = Clock::now();
+    view = nullptr;
+    arena = nullptr;
+    double teardown = msSince(start);
+
+    cost.build = first ? build : std::min(cost.build, build);
+    cost.teardown = first ? teardown : std::min(cost.teardown, teardown);
+    cost.allocatorCalls = first ? calls : std::min(cost.allocatorCalls, calls);
+}
+
+// Closes the UI a few slices into a prewarm, while the build is suspended half-way
+bool cancelledPrewarmFreesEverything(float budgetMs) {
+    size_t before = InternalDrawable::getLiveCount();
+    {
+        Bench bench(10000, budgetMs);
+        bench.navigate([]() { Navigator::prewarm("/warm"); });
+        bench.frame();
+        bench.frame();
+    }
+    return InternalDrawable::getLiveCount() == before;
+}
+
+}
+
+int main(int argc, char** argv) {
+    float budgetMs = argc > 1 ? (float) std::atof(argv[1]) : 2.0f;
+    int maxFrames = argc > 2 ? std::atoi(argv[2]) : 100000;
+
+    const int sizes[] = { 100, 1000, 10000 };
+    Result results[3];
+
+    std::printf("prewarm budget %.1f ms\n", budgetMs);
+    std::printf("%8s %12s %12s %16s %10s\n", "cards", "cold push", "warm push", "prewarm frame", "frames");
+    for (int i = 0; i < 3; ++i) {
+        results[i] = run(sizes[i], budgetMs, maxFrames);
+        const Result& r = results[i];
+        std::printf("%8d %9.3f ms %9.3f ms %13.3f ms %10d\n",
+                    r.cards, r.coldPush, r.warmPush, r.longestPrewarmFrame, r.prewarmFrames);
+    }
+
+    // 100x the widgets: the cold push grows with them, neither of these may. The allowance
+    // covers timer noise and one card's worth of work past the slice deadline.
+    const Result& small = results[0];
+    const Result& large = results[2];
+    bool pushFlat = large.warmPush <= small.warmPush * 4.0 + 0.05;
+    bool framesBounded = large.longestPrewarmFrame <= small.longestPrewarmFrame * 4.0 + budgetMs;
+    bool allPrewarmed = small.prewarmed && results[1].prewarmed && large.prewarmed;
+    bool cancelFreed = cancelledPrewarmFreesEverything(budgetMs);
+
+    std::printf("\nroute build and teardown, with and without WidgetArena\n");
+    std::printf("%8s %6s %12s %12s %16s %14s\n", "cards", "arena", "build", "teardown", "allocator calls", "arena objects");
+    bool arenaSaves = true;
+    for (int cards : sizes) {
+        Bench bench(cards, budgetMs);
+        BuildCost without{cards, false, 0.0, 0.0, 0, 0, 0};
+        BuildCost with{cards, true, 0.0, 0.0, 0, 0, 0};
+
+        // Taking turns, so both see the heap in the same state
+        for (int i = 0; i < 5; ++i) {
+            measureBuild(bench, without, i == 0);
+            measureBuild(bench, with, i == 0);
+        }
+        for (const BuildCost& c : { without, with }) {
+            char calls[32] = "-";
+            if (AllocationTracker::enabled()) std::snprintf(calls, sizeof(calls), "%zu", c.allocatorCalls);
+            char objects[32] = "-";
+            if (c.arena) std::snprintf(objects, sizeof(objects), "%zu in %zu", c.arenaObjects, c.arenaBlocks);
+            std::printf("%8d %6s %9.3f ms %9.3f ms %16s %14s\n",
+                        c.cards, c.arena ? "yes" : "no", c.build, c.teardown, calls, objects);
+        }
+        arenaSaves = arenaSaves && (!AllocationTracker::enabled() || with.allocatorCalls < without.allocatorCalls);
+    }
+    if (!AllocationTracker::enabled()) {
+        std::printf("(allocator calls are only counted with HMUI_TRACK_ALLOCATIONS)\n");
+    }
+    std::printf("\n");
+
+    std::printf("warm push independent of route size: %s\n", pushFlat ? "yes" : "NO");
+    std::printf("prewarm frames bounded by the budget: %s\n", framesBounded ? "yes" : "NO");
+    std::printf("every route finished prewarming: %s\n", allPrewarmed ? "yes" : "NO");
+    std::printf("cancelled prewarm freed its widgets: %s\n", cancelFreed ? "yes" : "NO");
+    if (AllocationTracker::enabled()) {
+        std::printf("the arena takes allocator calls away: %s\n", arenaSaves ? "yes" : "NO");
+    }
+
+    return pushFlat && framesBounded && allPrewarmed && cancelFreed && arenaSaves ? 0 : 1;
+}
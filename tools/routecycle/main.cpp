@@ -0,0 +1,213 @@
+// routecycle: pushes and pops a route over and over and checks that memory returns to
+// where it started.
+//
+//   routecycle [cycles] [items per route]
+//
+// The route is a list of tappable rows, each a GestureDetector whose callback captures
+// per-route state, around a Container with a Text and an Image. After every pop (and the
+// frame that lets AppContext drop the disposed view), these must be back at their baseline:
+// - live widgets (InternalDrawable::getLiveCount)
+// - live widget arenas and the block memory they hold
+// - the state captured by the callbacks
+// - textures loaded by the images and not released
+// The resident set size is reported too where the platform exposes it, and must not grow
+// between the end of the warmup and the last cycle by more than a small allowance.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "hmui/HMUI.h"
+#include "hmui/Navigator.h"
+#include "hmui/graphics/RecordingGraphicsContext.h"
+#include "hmui/widgets/AppContext.h"
+#include "hmui/widgets/Column.h"
+#include "hmui/widgets/Container.h"
+#include "hmui/widgets/GestureDetector.h"
+#include "hmui/widgets/Image.h"
+#include "hmui/widgets/Row.h"
+#include "hmui/widgets/Text.h"
+#include "../common/HeadlessOSContext.h"
+
+namespace {
+
+std::atomic<long> livePayloads{0};
+std::atomic<long> liveTextures{0};
+
+// What a real route's callbacks would hold on to: a model, a controller...
+struct Payload {
+    Payload() { livePayloads++; }
+    ~Payload() { livePayloads--; }
+    char bytes[512] = {};
+};
+
+class CountingImageProvider : public ImageProvider {
+public:
+    ~CountingImageProvider() override { dispose(); }
+
+    ImageHandle* load() override {
+        if (!loaded) liveTextures++;
+        loaded = true;
+        return &handle;
+    }
+
+    void dispose() override {
+        if (loaded) liveTextures--;
+        loaded = false;
+    }
+
+    bool probe(ImageInfo& out) override {
+        out = ImageInfo{48, 48, 4};
+        return true;
+    }
+
+private:
+    ImageHandle handle{48, 48, nullptr};
+    bool loaded = false;
+};
+
+std::shared_ptr<InternalDrawable> buildDetail(int items) {
+    auto payload = std::make_shared<Payload>();
+
+    ChildrenList rows;
+    for (int i = 0; i < items; ++i) {
+        rows.push_back(GestureDetector(
+            .onTap = [payload, i](std::shared_ptr<InternalDrawable>, float, float) { payload->bytes[i % 512]++; },
+            .child = Container(
+                .padding = EdgeInsets::all(4),
+                .child = Row(.children = {
+                    Image(.provider = std::make_shared<CountingImageProvider>(), .width = 48, .height = 48),
+                    Text(.text = "Row " + std::to_string(i)),
+                })
+            )
+        ));
+    }
+    return Column(.children = std::move(rows));
+}
+
+class Root : public Drawable {
+public:
+    explicit Root(int items) : items(items) {}
+
+    std::shared_ptr<InternalDrawable> build() override {
+        return AppContext(
+            .routes = {
+                { "/", []() { return Container(); } },
+                { "/detail", [items = items]() { return buildDetail(items); } },
+            },
+            .initialRoute = "/"
+        );
+    }
+
+private:
+    int items;
+};
+
+size_t residentBytes() {
+#if defined(__linux__)
+    long pages = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        long size = 0;
+        if (std::fscanf(statm, "%ld %ld", &size, &pages) != 2) pages = 0;
+        std::fclose(statm);
+    }
+    return (size_t) pages * (size_t) sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+struct Snapshot {
+    size_t widgets;
+    size_t arenas;
+    size_t arenaBytes;
+    long payloads;
+    long textures;
+
+    bool operator==(const Snapshot&) const = default;
+};
+
+Snapshot snapshot() {
+    return { InternalDrawable::getLiveCount(), WidgetArena::getLiveCount(), WidgetArena::getLiveBytesReserved(),
+             livePayloads.load(), liveTextures.load() };
+}
+
+void print(const char* label, const Snapshot& s) {
+    std::printf("%-10s %8zu widgets %4zu arenas %10zu arena bytes %4ld payloads %6ld textures\n",
+                label, s.widgets, s.arenas, s.arenaBytes, s.payloads, s.textures);
+}
+
+}
+
+int main(int argc, char** argv) {
+    int cycles = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int items = argc > 2 ? std::atoi(argv[2]) : 50;
+    const int warmup = 10;
+    const size_t rssAllowance = 512 * 1024;
+
+    auto hmui = std::make_shared<HMUI>();
+    hmui->initialize(std::make_shared<RecordingGraphicsContext>(), std::make_shared<HeadlessOSContext>());
+    hmui->setRouter(std::make_shared<Root>(items));
+
+    RecordingGraphicsContext recorder;
+    auto frame = [&]() {
+        hmui->update(1.0f / 60.0f);
+        hmui->record(recorder, 1280, 720);
+    };
+    auto navigate = [&](auto action) {
+        HMUI::Scope scope(hmui.get());
+        action();
+    };
+
+    frame();
+    Snapshot baseline = snapshot();
+    Snapshot pushed{};
+    size_t warmRss = 0;
+    int mismatches = 0;
+
+    for (int cycle = 1; cycle <= cycles; ++cycle) {
+        navigate([]() { Navigator::push("/detail"); });
+        frame();
+        frame();
+        if (cycle == 1) pushed = snapshot();
+
+        navigate([]() { Navigator::pop(); });
+        frame();
+
+        Snapshot after = snapshot();
+        if (!(after == baseline) && mismatches++ < 5) {
+            std::printf("cycle %d did not return to the baseline:\n", cycle);
+            print("expected", baseline);
+            print("got", after);
+        }
+        if (cycle == warmup) warmRss = residentBytes();
+    }
+    size_t finalRss = residentBytes();
+
+    hmui->close();
+
+    print("baseline", baseline);
+    print("pushed", pushed);
+    print("closed", snapshot());
+
+    bool pushedSomething = pushed.widgets > baseline.widgets && pushed.arenas > baseline.arenas
+                        && pushed.payloads > baseline.payloads && pushed.textures > baseline.textures;
+    bool rssFlat = cycles <= warmup || finalRss == 0 || finalRss <= warmRss + rssAllowance;
+    if (finalRss > 0 && cycles > warmup) {
+        std::printf("resident set after %d cycles: %zu KB, after %d: %zu KB\n",
+                    warmup, warmRss / 1024, cycles, finalRss / 1024);
+    }
+
+    std::printf("%d push/pop cycles of %d rows\n", cycles, items);
+    std::printf("every pop returned to the baseline: %s\n", mismatches == 0 ? "yes" : "NO");
+    std::printf("the route was actually built and shown: %s\n", pushedSomething ? "yes" : "NO");
+    std::printf("resident set did not grow: %s\n", rssFlat ? "yes" : "NO");
+
+    return mismatches == 0 && pushedSomething && rssFlat ? 0 : 1;
+}
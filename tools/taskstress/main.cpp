@@ -0,0 +1,119 @@
+// taskstress: hammers TaskQueue (HMUI::post) from many threads while one thread drains it
+// under a frame budget, the way HMUI::update() does.
+//
+//   taskstress [producers] [tasks per producer] [capacity]
+//
+// Every producer but the last posts small closures, the last one closures too big to be
+// stored inline. The consumer checks that each producer's tasks run exactly once and in the
+// order they were posted. Two runs:
+// - a burst: the given sizes, meant to overrun the ring, so posts spill to the overflow list
+// - a burst the ring holds: capacity for every task of the run. Nothing may spill, and with
+//   HMUI_TRACK_ALLOCATIONS small posts must not allocate at all.
+// Each reports the share of posts that went to the overflow list. Build with
+// -fsanitize=thread to check the queue for data races.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "hmui/AllocationTracker.h"
+#include "hmui/util/TaskQueue.h"
+
+namespace {
+
+// Only touched by the consumer, from inside the tasks
+struct Log {
+    std::vector<size_t> next;
+    size_t ran = 0;
+    size_t errors = 0;
+
+    void record(size_t producer, size_t sequence) {
+        if (next[producer] != sequence) errors++;
+        next[producer] = sequence + 1;
+        ran++;
+    }
+};
+
+struct RunResult {
+    size_t errors;
+    bool complete;
+    size_t overflow;
+    size_t smallAllocations; // Zero without HMUI_TRACK_ALLOCATIONS
+};
+
+RunResult run(size_t producers, size_t perProducer, size_t capacity) {
+    TaskQueue queue(capacity);
+    Log log;
+    log.next.resize(producers, 0);
+
+    std::vector<size_t> allocations(producers, 0);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            size_t before = AllocationTracker::getCount();
+            for (size_t i = 0; i < perProducer; ++i) {
+                if (p + 1 < producers) {
+                    queue.post([&log, p, i]() { log.record(p, i); });
+                } else {
+                    char padding[InlineTask::INLINE_SIZE] = {};
+                    queue.post([&log, p, i, padding]() { log.record(p, i + padding[0]); });
+                }
+            }
+            allocations[p] = AllocationTracker::getCount() - before;
+        });
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    size_t total = producers * perProducer;
+    size_t frames = 0;
+    size_t busiest = 0;
+    while (log.ran < total) {
+        size_t ran = queue.drain(std::chrono::microseconds(500));
+        busiest = std::max(busiest, ran);
+        frames++;
+        if (ran == 0) std::this_thread::yield();
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    for (auto& thread : threads) thread.join();
+
+    RunResult result{log.errors, log.ran == total, queue.getOverflowCount(), 0};
+    for (size_t p = 0; p + 1 < producers; ++p) result.smallAllocations += allocations[p];
+
+    std::printf("%zu producers x %zu tasks, capacity %zu: %.1f ms, %zu drains (at most %zu tasks)\n",
+                producers, perProducer, capacity, ms, frames, busiest);
+    std::printf("  order errors %zu, overflow posts %zu (%.1f%%)", result.errors, result.overflow,
+                100.0 * (double) result.overflow / (double) total);
+    if (AllocationTracker::enabled()) {
+        std::printf(", allocations by small posts %zu", result.smallAllocations);
+    }
+    std::printf("\n");
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t producers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t perProducer = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    size_t capacity = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1024;
+    if (producers < 2) producers = 2;
+
+    RunResult burst = run(producers, perProducer, capacity);
+
+    size_t fitting = std::min<size_t>(perProducer, 4096);
+    RunResult held = run(producers, fitting, producers * fitting);
+
+    // The overflow list allocates at most once per spilled post
+    bool burstOk = burst.errors == 0 && burst.complete && burst.smallAllocations <= burst.overflow;
+    bool heldOk = held.errors == 0 && held.complete && held.overflow == 0 && held.smallAllocations == 0;
+
+    std::printf("burst: every task ran once, in order per producer: %s\n", burstOk ? "yes" : "NO");
+    std::printf("burst the ring holds: lock-free and allocation-free posts: %s\n", heldOk ? "yes" : "NO");
+
+    return burstOk && heldOk ? 0 : 1;
+}
@@ -0,0 +1,436 @@
+// textcheck: checks FontMetrics and TextLayout against widths worked out by hand.
+//
+//   textcheck
+//
+// - FontMetrics: monospace() and fromAdvances() give the advances they were built with,
+//   fallbacks included; a font built in memory with a 'kern' table applies its pairs and
+//   leaves the monospace fast path, the same font without one takes it; every fast path
+//   measures what summing advance() and kerning() glyph by glyph gives.
+// - TextLayout: greedy wrapping at spaces, between glyphs for words wider than a line and
+//   at '\n'; maxLines with and without the ellipsis; re-breaking anywhere inside a result's
+//   [minValidWidth, maxValidWidth) gives the same lines, and without maxLines it does not
+//   at maxValidWidth (with it the bound may come early, breaks in the cut text still count).
+// - TextLayoutCache: resizing within the valid interval is served from the cache, crossing
+//   a break point or changing the text, scale, maxLines or font re-breaks.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hmui/graphics/text/FontMetrics.h"
+#include "hmui/graphics/text/TextLayout.h"
+#include "hmui/graphics/text/Utf8.h"
+
+namespace {
+
+int errors = 0;
+int checks = 0;
+
+void check(bool ok, const std::string& what) {
+    checks++;
+    if (!ok) {
+        std::printf("failed: %s\n", what.c_str());
+        errors++;
+    }
+}
+
+bool near(float a, float b) {
+    return std::fabs(a - b) < 0.001f;
+}
+
+// --- A TrueType font reduced to what FontMetrics reads ---
+
+void put16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t) (value >> 8));
+    out.push_back((uint8_t) value);
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    put16(out, value >> 16);
+    put16(out, value & 0xFFFF);
+}
+
+const uint16_t UNITS_ADVANCE = 500;
+const uint16_t E_ACUTE_ADVANCE = 600;
+const uint16_t E_ACUTE = 0xE9;
+
+// Printable ASCII is glyph cp - 31, 'é' is glyph 96, ascent 800 and descent 200 units.
+// At a pixel height of 20 a unit is 0.02 px: ASCII advances 10 px, 'é' 12 px, and the
+// kerning pairs are A-V -2 px and é-V -1 px.
+std::vector<uint8_t> makeFont(bool withKerning) {
+    const uint16_t glyphs = 97;
+    auto glyph = [](uint32_t cp) { return (uint16_t) (cp == E_ACUTE ? 96 : cp - 31); };
+
+    std::vector<uint8_t> head(54, 0);
+
+    std::vector<uint8_t> hhea;
+    put32(hhea, 0x00010000);
+    put16(hhea, 800);
+    put16(hhea, (uint16_t) -200);
+    hhea.resize(34, 0);
+    put16(hhea, glyphs);
+
+    std::vector<uint8_t> hmtx;
+    for (uint16_t g = 0; g < glyphs; ++g) {
+        put16(hmtx, g == 96 ? E_ACUTE_ADVANCE : UNITS_ADVANCE);
+        put16(hmtx, 0);
+    }
+
+    // Format 4 with three segments: printable ASCII, 'é' and the closing 0xFFFF
+    const uint16_t starts[] = { 32, E_ACUTE, 0xFFFF };
+    const uint16_t ends[] = { 126, E_ACUTE, 0xFFFF };
+    const uint16_t deltas[] = { (uint16_t) (1 - 32), (uint16_t) (96 - E_ACUTE), 1 };
+    std::vector<uint8_t> cmap;
+    put16(cmap, 0);
+    put16(cmap, 1);
+    put16(cmap, 3);
+    put16(cmap, 1);
+    put32(cmap, 12);
+    put16(cmap, 4);
+    put16(cmap, 16 + 4 * 2 * 3);
+    put16(cmap, 0);
+    put16(cmap, 3 * 2);
+    put16(cmap, 4);
+    put16(cmap, 1);
+    put16(cmap, 2);
+    for (uint16_t end : ends) put16(cmap, end);
+    put16(cmap, 0);
+    for (uint16_t start : starts) put16(cmap, start);
+    for (uint16_t delta : deltas) put16(cmap, delta);
+    for (int i = 0; i < 3; ++i) put16(cmap, 0);
+
+    const std::pair<uint32_t, uint32_t> pairs[] = { { 'A', 'V' }, { E_ACUTE, 'V' } };
+    const int16_t values[] = { -100, -50 };
+    std::vector<uint8_t> kern;
+    put16(kern, 0);
+    put16(kern, 1);
+    put16(kern, 0);
+    put16(kern, 14 + 6 * 2);
+    put16(kern, 0x0001);
+    put16(kern, 2);
+    put16(kern, 12);
+    put16(kern, 1);
+    put16(kern, 0);
+    for (int i = 0; i < 2; ++i) {
+        put16(kern, glyph(pairs[i].first));
+        put16(kern, glyph(pairs[i].second));
+        put16(kern, (uint16_t) values[i]);
+    }
+
+    std::vector<std::pair<const char*, std::vector<uint8_t>*>> tables = {
+        { "cmap", &cmap }, { "head", &head }, { "hhea", &hhea }, { "hmtx", &hmtx },
+    };
+    if (withKerning) tables.push_back({ "kern", &kern });
+
+    std::vector<uint8_t> font;
+    put32(font, 0x00010000);
+    put16(font, (uint32_t) tables.size());
+    put16(font, 0);
+    put16(font, 0);
+    put16(font, 0);
+
+    uint32_t offset = 12 + 16 * (uint32_t) tables.size();
+    for (const auto& [tag, data] : tables) {
+        font.insert(font.end(), tag, tag + 4);
+        put32(font, 0);
+        put32(font, offset);
+        put32(font, (uint32_t) data->size());
+        offset += ((uint32_t) data->size() + 3) & ~3u;
+    }
+    for (const auto& [tag, data] : tables) {
+        font.insert(font.end(), data->begin(), data->end());
+        font.resize((font.size() + 3) & ~size_t(3), 0);
+    }
+    return font;
+}
+
+// --- FontMetrics ---
+
+// What measure() has to agree with, whichever path it takes
+float sumAdvances(const FontMetrics& metrics, const std::string& text, float scale) {
+    float width = 0.0f;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < text.size();) {
+        uint32_t cp = decodeUtf8(text, i);
+        width += metrics.advance(cp) + (previous ? metrics.kerning(previous, cp) : 0.0f);
+        previous = cp;
+    }
+    return width * scale;
+}
+
+void checkMeasureAgrees(const FontMetrics& metrics, const char* name) {
+    const char* const samples[] = { "", "a", "hello world", "AVAV WAVE", "caf\xc3\xa9 V\xc3\xa9V", "\xe4\xb8\xad\xe6\x96\x87" };
+    for (const char* sample : samples) {
+        for (float scale : { 1.0f, 1.5f }) {
+            check(near(metrics.measure(sample, scale).width, sumAdvances(metrics, sample, scale)),
+                  std::string(name) + ": measure(\"" + sample + "\") sums the advances");
+        }
+    }
+}
+
+void checkMonospace() {
+    auto metrics = FontMetrics::monospace(7.0f, 13.0f, 10.0f);
+    check(metrics->isMonospace(), "monospace: takes the fast path");
+    check(!metrics->hasKerning(), "monospace: no kerning");
+    check(near(metrics->measure("hello").width, 35.0f), "monospace: 5 glyphs are 35 px");
+    Rect scaled = metrics->measure("hello", 2.0f);
+    check(near(scaled.width, 70.0f) && near(scaled.height, 26.0f), "monospace: scale 2 doubles width and height");
+    check(near(metrics->measure("h\xc3\xa9llo").width, 35.0f), "monospace: a two-byte codepoint is one glyph");
+    check(near(metrics->advance(0x4E2D), 7.0f), "monospace: non-ASCII advances by the fixed width");
+    checkMeasureAgrees(*metrics, "monospace");
+}
+
+void checkFromAdvances() {
+    auto metrics = FontMetrics::fromAdvances({ { 'i', 3.0f }, { 'W', 11.0f }, { 0x4E2D, 13.0f } }, 7.0f, 13.0f, 15.0f, 11.0f);
+    check(!metrics->isMonospace(), "fromAdvances: uneven ASCII leaves the monospace path");
+    check(near(metrics->getLineHeight(), 15.0f) && near(metrics->getAscent(), 11.0f), "fromAdvances: line height and ascent");
+    check(near(metrics->measure("iW").width, 14.0f), "fromAdvances: listed ASCII advances");
+    check(near(metrics->measure("abc").width, 21.0f), "fromAdvances: unlisted ASCII falls back");
+    check(near(metrics->measure("\xe4\xb8\xad").width, 13.0f), "fromAdvances: listed non-ASCII advance");
+    check(near(metrics->advance(0x10000), 7.0f), "fromAdvances: unlisted non-ASCII falls back");
+    checkMeasureAgrees(*metrics, "fromAdvances");
+
+    auto even = FontMetrics::fromAdvances({ { 0x4E2D, 13.0f } }, 7.0f, 13.0f, 13.0f, 10.0f);
+    check(even->isMonospace(), "fromAdvances: even ASCII takes the monospace path");
+    check(near(even->measure("hello").width, 35.0f), "fromAdvances: monospace path width");
+    check(near(even->measure("a\xe4\xb8\xad").width, 20.0f), "fromAdvances: non-ASCII leaves the monospace path");
+    checkMeasureAgrees(*even, "fromAdvances, even");
+}
+
+void checkKerning() {
+    auto kerned = FontMetrics::fromTrueType(makeFont(true), 20.0f);
+    check(kerned != nullptr, "kern font: parsed");
+    if (!kerned) return;
+
+    check(kerned->hasKerning(), "kern font: has kerning");
+    check(!kerned->isMonospace(), "kern font: kerning leaves the monospace path");
+    check(near(kerned->getAscent(), 16.0f) && near(kerned->getLineHeight(), 20.0f), "kern font: ascent and line height");
+    check(near(kerned->advance('A'), 10.0f) && near(kerned->advance(E_ACUTE), 12.0f), "kern font: advances");
+    check(near(kerned->advance(0x4E2D), 10.0f), "kern font: unmapped codepoints advance like glyph 0");
+    check(near(kerned->kerning('A', 'V'), -2.0f), "kern font: A-V pair");
+    check(near(kerned->kerning('V', 'A'), 0.0f), "kern font: pairs are ordered");
+    check(near(kerned->measure("AV").width, 18.0f), "kern font: AV is kerned");
+    check(near(kerned->measure("VA").width, 20.0f), "kern font: VA is not");
+    check(near(kerned->measure("AVA", 2.0f).width, 56.0f), "kern font: kerning scales");
+    check(near(kerned->measure("\xc3\xa9V").width, 21.0f), "kern font: non-ASCII pair");
+    checkMeasureAgrees(*kerned, "kern font");
+
+    auto plain = FontMetrics::fromTrueType(makeFont(false), 20.0f);
+    check(plain != nullptr, "plain font: parsed");
+    if (!plain) return;
+
+    check(!plain->hasKerning() && plain->isMonospace(), "plain font: even advances take the monospace path");
+    check(near(plain->measure("AV").width, 20.0f), "plain font: AV is not kerned");
+    checkMeasureAgrees(*plain, "plain font");
+
+    std::vector<uint8_t> cut = makeFont(true);
+    cut.resize(40);
+    check(FontMetrics::fromTrueType({}, 20.0f) == nullptr, "an empty font is rejected");
+    check(FontMetrics::fromTrueType(cut, 20.0f) == nullptr, "a truncated font is rejected");
+}
+
+// --- TextLayout ---
+
+TextLayoutResult layout(const FontMetrics& metrics, const std::string& text, float maxWidth,
+                        int maxLines = 0, bool ellipsis = false) {
+    TextLayoutParams params;
+    params.maxWidth = maxWidth;
+    params.maxLines = maxLines;
+    params.ellipsis = ellipsis;
+
+    TextLayoutResult result;
+    TextLayout::breakLines(metrics, text, params, result);
+    return result;
+}
+
+std::string describe(const TextLayoutResult& result) {
+    std::string out;
+    for (const auto& line : result.lines) {
+        out += out.empty() ? "[" : "|";
+        out += line.text;
+    }
+    return out + "]";
+}
+
+bool linesAre(const TextLayoutResult& result, std::vector<std::string> expected) {
+    if (result.lines.size() != expected.size()) return false;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (result.lines[i].text != expected[i]) return false;
+    }
+    return true;
+}
+
+void checkLines(const TextLayoutResult& result, std::vector<std::string> expected, const std::string& what) {
+    check(linesAre(result, expected), what + ", got " + describe(result));
+}
+
+void checkWrapping() {
+    auto mono = FontMetrics::monospace(7.0f, 13.0f, 10.0f);
+
+    auto single = layout(*mono, "hello world", INFINITY);
+    checkLines(single, { "hello world" }, "no wrapping without a width");
+    check(near(single.width, 77.0f) && near(single.height, 13.0f), "one line: 77 x 13");
+    check(single.maxValidWidth == INFINITY, "one line: valid at any greater width");
+
+    auto two = layout(*mono, "hello world", 40.0f);
+    checkLines(two, { "hello", "world" }, "wraps at the space");
+    check(near(two.width, 35.0f) && near(two.height, 26.0f), "two lines: 35 x 26");
+    check(near(two.minValidWidth, 35.0f) && near(two.maxValidWidth, 77.0f), "two lines: valid in [35, 77)");
+
+    checkLines(layout(*mono, "hello world", 77.0f), { "hello world" }, "a line exactly as wide fits");
+    checkLines(layout(*mono, "aa   bb", 20.0f), { "aa", "bb" }, "spaces at a wrap point are dropped");
+    checkLines(layout(*mono, "  aa", INFINITY), { "  aa" }, "leading spaces of a paragraph are kept");
+    checkLines(layout(*mono, "one\n\ntwo", INFINITY), { "one", "", "two" }, "breaks at newlines, empty lines kept");
+
+    auto long_ = layout(*mono, "abcdefghij", 30.0f);
+    checkLines(long_, { "abcd", "efgh", "ij" }, "a word wider than the line breaks between glyphs");
+    check(near(long_.maxValidWidth, 35.0f), "glyph breaks: next glyph fits at 35");
+
+    checkLines(layout(*mono, "ab abcdefghij", 30.0f), { "ab", "abcd", "efgh", "ij" },
+               "a long word after a short one starts its own line");
+    checkLines(layout(*mono, "abc", 3.0f), { "a", "b", "c" }, "one glyph per line when none fits");
+
+    auto proportional = FontMetrics::fromAdvances({ { 'i', 3.0f }, { 'W', 11.0f } }, 7.0f, 13.0f, 13.0f, 10.0f);
+    auto mixed = layout(*proportional, "iii WWW iii", 40.0f);
+    checkLines(mixed, { "iii", "WWW", "iii" }, "proportional widths decide the breaks");
+    check(mixed.lines.size() == 3 && near(mixed.lines[1].width, 33.0f) && near(mixed.maxValidWidth, 49.0f),
+          "proportional: 33 px line, iii WWW fits at 49");
+}
+
+void checkMaxLines() {
+    auto mono = FontMetrics::monospace(7.0f, 13.0f, 10.0f);
+    const std::string text = "one two three four";
+
+    auto cut = layout(*mono, text, 30.0f, 2);
+    checkLines(cut, { "one", "two" }, "maxLines 2 keeps two lines");
+    check(near(cut.height, 26.0f), "maxLines 2: height of two lines");
+
+    auto ellipsis = layout(*mono, text, 50.0f, 2, true);
+    checkLines(ellipsis, { "one two", "thre..." }, "the last kept line ends in an ellipsis");
+    check(near(ellipsis.lines[1].width, 49.0f), "ellipsis: 4 glyphs and the 21 px ellipsis");
+
+    auto one = layout(*mono, "hello world", 50.0f, 1, true);
+    checkLines(one, { "hell..." }, "maxLines 1 with an ellipsis");
+    check(near(one.width, 49.0f), "maxLines 1: width includes the ellipsis");
+
+    checkLines(layout(*mono, "ab cdef", 48.0f, 1, true), { "ab..." }, "no space before the ellipsis");
+    checkLines(layout(*mono, "hi", 50.0f, 1, true), { "hi" }, "no ellipsis when nothing was cut");
+    checkLines(layout(*mono, "a\nb\nc", INFINITY, 2, true), { "a", "b..." }, "newlines count against maxLines");
+}
+
+// Anywhere in [minValidWidth, maxValidWidth) gives the same lines, maxValidWidth does not
+// unless maxLines cut the text
+void checkValidInterval(const FontMetrics& metrics, const char* name) {
+    const char* const texts[] = {
+        "hello world", "the quick brown fox jumps over the lazy dog", "AVAVAV WAVE VA",
+        "supercalifragilistic is long", "caf\xc3\xa9 V\xc3\xa9V \xc3\xa9t\xc3\xa9",
+    };
+
+    int mismatches = 0;
+    for (const char* text : texts) {
+        for (auto [maxLines, ellipsis] : { std::pair(0, false), std::pair(2, false), std::pair(2, true) }) {
+            for (float width = 4.0f; width <= 400.0f; width += 3.0f) {
+                auto result = layout(metrics, text, width, maxLines, ellipsis);
+                float low = result.minValidWidth;
+                float high = result.maxValidWidth;
+                if (!(low <= width && width < high)) {
+                    mismatches++;
+                    continue;
+                }
+
+                std::vector<float> inside = { low, width };
+                if (high != INFINITY) inside.push_back(high - 0.01f);
+                else inside.push_back(low + 1000.0f);
+
+                for (float w : inside) {
+                    if (describe(layout(metrics, text, w, maxLines, ellipsis)) != describe(result)) mismatches++;
+                }
+                if (maxLines == 0 && high != INFINITY && describe(layout(metrics, text, high, 0, false)) == describe(result)) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    check(mismatches == 0, std::string(name) + ": lines only change at the ends of the valid interval");
+}
+
+// --- TextLayoutCache ---
+
+void checkCache() {
+    auto mono = FontMetrics::monospace(7.0f, 13.0f, 10.0f);
+    auto other = FontMetrics::monospace(7.0f, 13.0f, 10.0f);
+    TextLayoutCache cache;
+    TextLayoutParams params;
+
+    auto get = [&](const FontMetrics& metrics, const std::string& text, float maxWidth) -> const TextLayoutResult& {
+        params.maxWidth = maxWidth;
+        return cache.get(metrics, text, params);
+    };
+    auto expect = [&](size_t breaks, size_t lines, const std::string& what) {
+        check(cache.getBreakCount() == breaks && cache.getResult().lines.size() == lines,
+              "cache: " + what + " (" + std::to_string(cache.getBreakCount()) + " breaks, " +
+              std::to_string(cache.getResult().lines.size()) + " lines)");
+    };
+
+    check(!cache.hasResult(), "cache: empty at first");
+    get(*mono, "hello world", 40.0f);
+    expect(1, 2, "first use breaks");
+    get(*mono, "hello world", 60.0f);
+    expect(1, 2, "wider, still below the break point");
+    get(*mono, "hello world", 76.5f);
+    expect(1, 2, "just below the break point");
+    get(*mono, "hello world", 35.0f);
+    expect(1, 2, "down to the widest line");
+    get(*mono, "hello world", 77.0f);
+    expect(2, 1, "at the break point");
+    get(*mono, "hello world", 500.0f);
+    get(*mono, "hello world", INFINITY);
+    expect(2, 1, "any width above the only line");
+    get(*mono, "hello world", 76.0f);
+    expect(3, 2, "back under the break point");
+    get(*mono, "hello world", 34.0f);
+    expect(4, 4, "under the widest line");
+
+    get(*mono, "hello world", 40.0f);
+    expect(5, 2, "back to two lines");
+    get(*mono, "hello there", 40.0f);
+    expect(6, 2, "new text");
+    params.scale = 2.0f;
+    get(*mono, "hello there", 80.0f);
+    expect(7, 2, "new scale");
+    params.maxLines = 1;
+    get(*mono, "hello there", 80.0f);
+    expect(8, 1, "new maxLines");
+    get(*other, "hello there", 80.0f);
+    expect(9, 1, "other metrics");
+    get(*other, "hello there", 90.0f);
+    expect(9, 1, "same again, resized");
+
+    cache.invalidate();
+    get(*other, "hello there", 90.0f);
+    expect(10, 1, "after invalidate()");
+}
+
+}
+
+int main() {
+    checkMonospace();
+    checkFromAdvances();
+    checkKerning();
+
+    checkWrapping();
+    checkMaxLines();
+    checkValidInterval(*FontMetrics::monospace(7.0f, 13.0f, 10.0f), "monospace");
+    checkValidInterval(*FontMetrics::fromAdvances({ { 'i', 3.0f }, { 'W', 11.0f }, { 'm', 11.0f }, { ' ', 4.0f } },
+                                                  7.0f, 13.0f, 13.0f, 10.0f), "fromAdvances");
+    if (auto kerned = FontMetrics::fromTrueType(makeFont(true), 20.0f)) checkValidInterval(*kerned, "kern font");
+
+    checkCache();
+
+    std::printf("%d checks, %d failures\n", checks, errors);
+    std::printf("%s\n", errors == 0 ? "ok" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}